@@ -0,0 +1,343 @@
+#pragma once
+
+#include <Blob/Collision/CollisionFilter.hpp>
+#include <Blob/Collision/Forms.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace Blob {
+
+/**
+ * Broad phase storing the colliders in a dynamic bounding volume hierarchy.
+ * The cost of a collider does not depend on its size, so large or size-varied
+ * colliders are cheap to add, remove and query.
+ *
+ * Colliders are inserted with their exact bounds. Once a collider moves out of
+ * its box, it is reinserted with its bounds enlarged by a margin, so a collider
+ * moving a little every frame only touches the tree from time to time. The
+ * tree is kept balanced by rotations when a leaf is inserted or removed.
+ * @tparam Collider the type of collider stored
+ * @tparam Form the form of the colliders
+ */
+template<class Collider, class Form>
+class AABBTree {
+private:
+    static constexpr int32_t nullNode = -1;
+
+    struct Node {
+        Box box;
+        Collider *collider = nullptr;
+        // next free node when the node is free
+        int32_t parent = nullNode;
+        int32_t child1 = nullNode;
+        int32_t child2 = nullNode;
+        // 0 for a leaf, -1 for a free node
+        int32_t height = -1;
+
+        bool isLeaf() const { return child1 == nullNode; }
+    };
+
+    std::vector<Node> nodes;
+    int32_t root = nullNode;
+    int32_t freeNodes = nullNode;
+    float margin = 0.2f;
+
+    int32_t allocateNode() {
+        if (freeNodes == nullNode) {
+            nodes.emplace_back();
+            nodes.back().height = 0;
+            return (int32_t) nodes.size() - 1;
+        }
+        int32_t index = freeNodes;
+        freeNodes = nodes[index].parent;
+        nodes[index] = Node{};
+        nodes[index].height = 0;
+        return index;
+    }
+
+    void freeNode(int32_t index) {
+        nodes[index] = Node{};
+        nodes[index].parent = freeNodes;
+        freeNodes = index;
+    }
+
+    void replaceChild(int32_t parent, int32_t oldChild, int32_t newChild) {
+        if (parent == nullNode)
+            root = newChild;
+        else if (nodes[parent].child1 == oldChild)
+            nodes[parent].child1 = newChild;
+        else
+            nodes[parent].child2 = newChild;
+    }
+
+    void refit(int32_t index) {
+        Node &node = nodes[index];
+        const Node &child1 = nodes[node.child1];
+        const Node &child2 = nodes[node.child2];
+        node.height = 1 + std::max(child1.height, child2.height);
+        node.box = child1.box.merge(child2.box);
+    }
+
+    // Rotate the highest grandchild of a up if a is unbalanced
+    // @return the root of the subtree
+    int32_t balance(int32_t a) {
+        Node &A = nodes[a];
+        if (A.isLeaf() || A.height < 2)
+            return a;
+
+        int32_t b = A.child1;
+        int32_t c = A.child2;
+        int32_t heightDifference = nodes[c].height - nodes[b].height;
+        if (heightDifference > 1)
+            return rotateUp(a, c, b, false);
+        if (heightDifference < -1)
+            return rotateUp(a, b, c, true);
+        return a;
+    }
+
+    // Put the child up in place of a, a takes the lowest grandchild
+    int32_t rotateUp(int32_t a, int32_t up, int32_t sibling, bool upIsFirst) {
+        Node &A = nodes[a];
+        Node &U = nodes[up];
+        int32_t f = U.child1;
+        int32_t g = U.child2;
+
+        U.child1 = a;
+        U.parent = A.parent;
+        A.parent = up;
+        replaceChild(U.parent, a, up);
+
+        if (nodes[f].height < nodes[g].height)
+            std::swap(f, g);
+        // f is the highest grandchild, it stays under up
+        U.child2 = f;
+        if (upIsFirst)
+            A.child1 = g;
+        else
+            A.child2 = g;
+        nodes[g].parent = a;
+
+        A.box = nodes[sibling].box.merge(nodes[g].box);
+        A.height = 1 + std::max(nodes[sibling].height, nodes[g].height);
+        U.box = A.box.merge(nodes[f].box);
+        U.height = 1 + std::max(A.height, nodes[f].height);
+        return up;
+    }
+
+    void fixUpwards(int32_t index) {
+        while (index != nullNode) {
+            index = balance(index);
+            refit(index);
+            index = nodes[index].parent;
+        }
+    }
+
+    void insertLeaf(int32_t leaf) {
+        if (root == nullNode) {
+            root = leaf;
+            nodes[leaf].parent = nullNode;
+            return;
+        }
+
+        // Find the best sibling with the surface area heuristic
+        const Box box = nodes[leaf].box;
+        int32_t index = root;
+        while (!nodes[index].isLeaf()) {
+            const Node &node = nodes[index];
+            float perimeter = node.box.perimeter();
+            float combined = node.box.merge(box).perimeter();
+
+            // cost of a new parent for this node and the leaf
+            float cost = 2 * combined;
+            // cost of pushing the leaf further down
+            float inheritance = 2 * (combined - perimeter);
+
+            auto descentCost = [&](int32_t child) {
+                const Node &c = nodes[child];
+                float merged = c.box.merge(box).perimeter();
+                if (c.isLeaf())
+                    return merged + inheritance;
+                return merged - c.box.perimeter() + inheritance;
+            };
+            float cost1 = descentCost(node.child1);
+            float cost2 = descentCost(node.child2);
+
+            if (cost < cost1 && cost < cost2)
+                break;
+            index = cost1 < cost2 ? node.child1 : node.child2;
+        }
+
+        const int32_t sibling = index;
+        const int32_t oldParent = nodes[sibling].parent;
+        const int32_t newParent = allocateNode();
+        nodes[newParent].parent = oldParent;
+        nodes[newParent].child1 = sibling;
+        nodes[newParent].child2 = leaf;
+        nodes[sibling].parent = newParent;
+        nodes[leaf].parent = newParent;
+        replaceChild(oldParent, sibling, newParent);
+
+        fixUpwards(newParent);
+    }
+
+    void removeLeaf(int32_t leaf) {
+        if (leaf == root) {
+            root = nullNode;
+            return;
+        }
+
+        const int32_t parent = nodes[leaf].parent;
+        const int32_t grandParent = nodes[parent].parent;
+        const int32_t sibling = nodes[parent].child1 == leaf
+                                    ? nodes[parent].child2
+                                    : nodes[parent].child1;
+
+        replaceChild(grandParent, parent, sibling);
+        nodes[sibling].parent = grandParent;
+        freeNode(parent);
+
+        fixUpwards(grandParent);
+    }
+
+    template<class F>
+    void query(int32_t index, const Box &box, F &f) const {
+        const Node &node = nodes[index];
+        if (!node.box.overlap(box))
+            return;
+        if (node.isLeaf())
+            f(node.collider);
+        else {
+            query(node.child1, box, f);
+            query(node.child2, box, f);
+        }
+    }
+
+    template<class F>
+    void raycast(int32_t index,
+                 const Vec2<> &origin,
+                 const Vec2<> &direction,
+                 float &maxDistance,
+                 const CollisionFilter &filter,
+                 F &f) const {
+        const Node &node = nodes[index];
+        if (node.isLeaf()) {
+            if (filter.accepts(node.collider->collisionFilter))
+                maxDistance = f(node.collider);
+            return;
+        }
+        // nearest child first, it may shorten the ray for the other one
+        int32_t near = node.child1, far = node.child2;
+        float nearEntry =
+            nodes[near].box.rayEntry(origin, direction, maxDistance);
+        float farEntry =
+            nodes[far].box.rayEntry(origin, direction, maxDistance);
+        if (farEntry < nearEntry) {
+            std::swap(near, far);
+            std::swap(nearEntry, farEntry);
+        }
+        if (nearEntry <= maxDistance)
+            raycast(near, origin, direction, maxDistance, filter, f);
+        if (farEntry <= maxDistance)
+            raycast(far, origin, direction, maxDistance, filter, f);
+    }
+
+public:
+    /**
+     * Add a collider with its current form
+     * @return the proxy identifying the collider in this broad phase
+     */
+    uint32_t insert(Collider *collider, const Form &form) {
+        int32_t leaf = allocateNode();
+        nodes[leaf].collider = collider;
+        nodes[leaf].box = form.bounds();
+        insertLeaf(leaf);
+        return (uint32_t) leaf;
+    }
+
+    void erase(uint32_t proxy) {
+        removeLeaf((int32_t) proxy);
+        freeNode((int32_t) proxy);
+    }
+
+    /**
+     * Update a collider after its form changed. The tree is only modified if
+     * the form left the box of the leaf.
+     */
+    void move(uint32_t proxy, const Form &form) {
+        const Box box = form.bounds();
+        if (nodes[proxy].box.contains(box))
+            return;
+
+        removeLeaf((int32_t) proxy);
+        nodes[proxy].box = box.expand(margin);
+        insertLeaf((int32_t) proxy);
+    }
+
+    /**
+     * Call f(collider) once for every collider whose box overlaps the bounds
+     * of form
+     */
+    template<class U, class F>
+    void query(const U &form, F &&f) const {
+        if (root != nullNode)
+            query(root, form.bounds(), f);
+    }
+
+    /**
+     * Call f(collider) for every collider accepted by filter whose box is hit
+     * by the ray, nearest boxes first. f returns the distance up to which
+     * colliders are still wanted, the farther boxes are skipped.
+     * @param direction normalized
+     */
+    template<class F>
+    void raycast(const Vec2<> &origin,
+                 const Vec2<> &direction,
+                 float maxDistance,
+                 const CollisionFilter &filter,
+                 F &&f) const {
+        if (root != nullNode &&
+            nodes[root].box.rayEntry(origin, direction, maxDistance) <=
+                maxDistance)
+            raycast(root, origin, direction, maxDistance, filter, f);
+    }
+
+    /**
+     * Call f(collider) once for every collider
+     */
+    template<class F>
+    void forEach(F &&f) const {
+        for (const Node &node : nodes)
+            if (node.height == 0)
+                f(node.collider);
+    }
+
+    /**
+     * Call f(box) for every node of the tree
+     */
+    template<class F>
+    void forEachBox(F &&f) const {
+        for (const Node &node : nodes)
+            if (node.height >= 0)
+                f(node.box);
+    }
+
+    /**
+     * @param margin added around the bounds of a collider when it is
+     * reinserted after leaving its box, a larger margin means fewer
+     * reinsertions but more candidates in the queries
+     */
+    void setMargin(float margin) { this->margin = margin; }
+
+    float getMargin() const { return margin; }
+
+    /**
+     * @return the height of the tree, 0 if empty
+     */
+    int32_t height() const {
+        return root == nullNode ? 0 : nodes[root].height + 1;
+    }
+};
+
+} // namespace Blob
@@ -0,0 +1,395 @@
+#pragma once
+
+#include <Blob/Collision/CollisionFilter.hpp>
+#include <Blob/Collision/CollisionStatistics.hpp>
+#include <Blob/Collision/Forms.hpp>
+#include <Blob/Collision/PackedForms.hpp>
+#include <Blob/Collision/ThreadPool.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace Blob {
+
+/**
+ * Read-only cell index of static colliders, built at once from all of them.
+ *
+ * The cells are sorted by row then column and stored in compressed rows: the
+ * keys of the cells, the offset of each cell in one packed array of entries,
+ * and the first cell of each row. A lookup finds the row directly, then the
+ * column, without search when the row has no holes. There is no hash table and
+ * no allocation per cell, so building the index of a large level is a
+ * rasterization and a radix sort.
+ *
+ * A collider can be removed, its slot is cleared but its entries stay until
+ * the next build.
+ * @tparam Collider a StaticCollider<Form>, its form is read at build time
+ * @tparam Form the form of the colliders
+ */
+template<class Collider, class Form>
+class BakedGrid {
+private:
+    struct Entry {
+        uint32_t slot;
+        CollisionFilter filter;
+    };
+
+    struct NoPackedForms {};
+
+    // collider of each slot, nullptr once removed
+    std::vector<Collider *> colliders;
+    size_t colliderCount = 0;
+    // cells sorted by key, offsets has one more element than keys
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> offsets;
+    std::vector<Entry> entries;
+    // first cell of each row from firstRow, one more element than the rows
+    std::vector<uint32_t> rows;
+    int32_t firstRow = 0;
+    std::conditional_t<HasPackedForms<Form>, PackedForms<Form>, NoPackedForms>
+        packedForms;
+
+    // rows sorted first, the sign bit flipped so negative positions come first
+    static uint64_t keyOf(const Vec2<int32_t> &position) {
+        return (uint64_t) ((uint32_t) position.y ^ 0x80000000u) << 32u |
+               ((uint32_t) position.x ^ 0x80000000u);
+    }
+
+    static Vec2<int32_t> positionOf(uint64_t key) {
+        return {(int32_t) ((uint32_t) key ^ 0x80000000u),
+                (int32_t) ((uint32_t) (key >> 32u) ^ 0x80000000u)};
+    }
+
+    // a cell of a collider, the key split in two to fit in 12 bytes
+    struct Pair {
+        uint32_t row;
+        uint32_t column;
+        uint32_t slot;
+
+        uint64_t key() const { return (uint64_t) row << 32u | column; }
+
+        bool operator<(const Pair &other) const {
+            return key() < other.key() ||
+                   (key() == other.key() && slot < other.slot);
+        }
+
+        bool operator==(const Pair &) const = default;
+    };
+
+    // a row index or a counting sort is not worth it for sparse cells
+    static bool tooSpread(int64_t span, size_t count) {
+        return span > (int64_t) count * 4 + 1024;
+    }
+
+    // Stable counting sort of the pairs on their rows or their columns
+    static bool countingSort(std::vector<Pair> &pairs,
+                             std::vector<Pair> &sorted,
+                             uint32_t Pair::*part) {
+        auto [first, last] = std::minmax_element(
+            pairs.begin(), pairs.end(), [&](const Pair &a, const Pair &b) {
+                return a.*part < b.*part;
+            });
+        const uint32_t base = (*first).*part;
+        const int64_t span = (int64_t) ((*last).*part) - base + 1;
+        if (tooSpread(span, pairs.size()))
+            return false;
+
+        std::vector<size_t> next(span + 1, 0);
+        for (const Pair &pair : pairs)
+            next[pair.*part - base + 1]++;
+        for (int64_t i = 0; i < span; i++)
+            next[i + 1] += next[i];
+        sorted.resize(pairs.size());
+        for (const Pair &pair : pairs)
+            sorted[next[pair.*part - base]++] = pair;
+        std::swap(pairs, sorted);
+        return true;
+    }
+
+    // Sort the pairs written in slot order by key then slot: a radix sort on
+    // the columns then the rows when the cells are dense
+    static void sortPairs(std::vector<Pair> &pairs) {
+        if (pairs.empty())
+            return;
+        std::vector<Pair> sorted;
+        if (!countingSort(pairs, sorted, &Pair::column) ||
+            !countingSort(pairs, sorted, &Pair::row))
+            std::sort(pairs.begin(), pairs.end());
+    }
+
+    std::span<const Entry> operator[](const Vec2<int32_t> &position) const {
+        auto begin = keys.begin();
+        auto end = keys.end();
+        if (!rows.empty()) {
+            const int64_t row = (int64_t) position.y - firstRow;
+            if (row < 0 || row + 1 >= (int64_t) rows.size())
+                return {};
+            begin = keys.begin() + rows[row];
+            end = keys.begin() + rows[row + 1];
+        }
+        if (begin == end)
+            return {};
+        const uint64_t key = keyOf(position);
+        // in a row without holes the column gives the cell directly
+        auto it = begin + std::min<uint64_t>(key - std::min(key, *begin),
+                                             end - begin - 1);
+        if (*it != key)
+            it = std::lower_bound(begin, end, key);
+        if (it == end || *it != key)
+            return {};
+        const size_t cell = it - keys.begin();
+        return std::span(entries).subspan(offsets[cell],
+                                          offsets[cell + 1] - offsets[cell]);
+    }
+
+public:
+    /**
+     * Replace the index by the cells of colliders. The slot of a collider is
+     * its position in colliders.
+     * @param threadPool rasterize the colliders on its threads if not null
+     */
+    void build(std::span<Collider *const> newColliders,
+               ThreadPool *threadPool = nullptr) {
+        colliders.assign(newColliders.begin(), newColliders.end());
+        colliderCount = colliders.size();
+        if constexpr (HasPackedForms<Form>) {
+            packedForms = {};
+            for (size_t slot = 0; slot < colliders.size(); slot++)
+                packedForms.set((uint32_t) slot, colliders[slot]->form);
+        }
+
+        auto forEachChunk = [&](const std::function<void(size_t, size_t)> &f) {
+            if (threadPool)
+                threadPool->parallelFor(colliders.size(), f);
+            else
+                f(0, colliders.size());
+        };
+
+        // 1: count the cells of each collider to place them in one array
+        std::vector<size_t> firsts(colliders.size() + 1, 0);
+        forEachChunk([&](size_t begin, size_t end) {
+            for (size_t slot = begin; slot < end; slot++)
+                for ([[maybe_unused]] const auto &position :
+                     colliders[slot]->form.rasterize())
+                    firsts[slot + 1]++;
+        });
+        for (size_t slot = 0; slot < colliders.size(); slot++)
+            firsts[slot + 1] += firsts[slot];
+
+        // 2: write the (cell, slot) pairs and sort them by cell
+        std::vector<Pair> pairs(firsts.back());
+        forEachChunk([&](size_t begin, size_t end) {
+            for (size_t slot = begin; slot < end; slot++) {
+                size_t i = firsts[slot];
+                for (const auto &position :
+                     colliders[slot]->form.rasterize()) {
+                    const uint64_t key = keyOf(position);
+                    pairs[i++] = {(uint32_t) (key >> 32u),
+                                  (uint32_t) key,
+                                  (uint32_t) slot};
+                }
+            }
+        });
+        sortPairs(pairs);
+        pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+        // 3: compress the cells
+        keys.clear();
+        offsets.clear();
+        entries.clear();
+        entries.reserve(pairs.size());
+        for (const Pair &pair : pairs) {
+            if (keys.empty() || keys.back() != pair.key()) {
+                keys.push_back(pair.key());
+                offsets.push_back((uint32_t) entries.size());
+            }
+            entries.push_back(
+                {pair.slot, colliders[pair.slot]->collisionFilter});
+        }
+        offsets.push_back((uint32_t) entries.size());
+
+        // 4: index the rows, unless they are too spread out for it
+        rows.clear();
+        if (keys.empty())
+            return;
+        firstRow = positionOf(keys.front()).y;
+        const int64_t rowCount =
+            (int64_t) positionOf(keys.back()).y - firstRow + 1;
+        if (tooSpread(rowCount, keys.size()))
+            return;
+        rows.resize(rowCount + 1);
+        size_t cell = 0;
+        for (int64_t row = 0; row <= rowCount; row++) {
+            while (cell < keys.size() &&
+                   positionOf(keys[cell]).y < firstRow + row)
+                cell++;
+            rows[row] = (uint32_t) cell;
+        }
+    }
+
+    /**
+     * Remove the collider of a slot, its cells are kept until the next build
+     */
+    void erase(uint32_t slot) {
+        colliders[slot] = nullptr;
+        colliderCount--;
+    }
+
+    /**
+     * @return the number of colliders not removed
+     */
+    size_t size() const { return colliderCount; }
+
+    /**
+     * Call f(collider) for every collider sharing a cell with form. A collider
+     * is reported once per shared cell.
+     */
+    template<class U, class F>
+    void query(const U &form, F &&f) const {
+        for (const Vec2<int32_t> &position : form.rasterize())
+            for (const Entry &entry : (*this)[position])
+                if (colliders[entry.slot])
+                    f(colliders[entry.slot]);
+    }
+
+    /**
+     * Call f(collider) for every collider accepted by filter and overlapping
+     * form, once per shared cell, see GridBroadPhase::overlap
+     */
+    template<class U, class Narrow, class F>
+    QueryCounters overlap(const U &form,
+                          const CollisionFilter &filter,
+                          Narrow &&narrow,
+                          F &&f) const {
+        QueryCounters counters;
+        if constexpr (requires(std::span<const uint32_t> c, uint32_t *h) {
+                          overlapBatch(form, packedForms, c, h);
+                      }) {
+            constexpr size_t chunkSize = 64;
+            uint32_t candidates[chunkSize];
+            uint32_t hits[chunkSize];
+            size_t size = 0;
+            auto flush = [&]() {
+                size_t count = overlapBatch(
+                    form, packedForms, std::span(candidates, size), hits);
+                for (size_t i = 0; i < count; i++)
+                    f(colliders[hits[i]]);
+                counters.tests += size;
+                size = 0;
+            };
+            for (const Vec2<int32_t> &position : form.rasterize()) {
+                counters.cells++;
+                for (const Entry &entry : (*this)[position]) {
+                    if (!colliders[entry.slot] ||
+                        !filter.accepts(entry.filter))
+                        continue;
+                    candidates[size++] = entry.slot;
+                    if (size == chunkSize)
+                        flush();
+                }
+            }
+            if (size)
+                flush();
+        } else
+            for (const Vec2<int32_t> &position : form.rasterize()) {
+                counters.cells++;
+                for (const Entry &entry : (*this)[position]) {
+                    if (!colliders[entry.slot] ||
+                        !filter.accepts(entry.filter))
+                        continue;
+                    counters.tests++;
+                    if (narrow(colliders[entry.slot]))
+                        f(colliders[entry.slot]);
+                }
+            }
+        return counters;
+    }
+
+    /**
+     * Call f(collider) for every collider accepted by filter in the cells
+     * crossed by the ray, see GridBroadPhase::raycast
+     * @param direction normalized
+     */
+    template<class F>
+    void raycast(const Vec2<> &origin,
+                 const Vec2<> &direction,
+                 float maxDistance,
+                 const CollisionFilter &filter,
+                 F &&f) const {
+        if (keys.empty())
+            return;
+        const float length = maxDistance;
+        const GridTraversal cells{origin, origin + direction * length};
+        for (auto it = cells.begin(); it != cells.end(); ++it) {
+            for (const Entry &entry : (*this)[*it])
+                if (colliders[entry.slot] && filter.accepts(entry.filter))
+                    maxDistance = f(colliders[entry.slot]);
+            if (it.exitTime() * length >= maxDistance)
+                return;
+        }
+    }
+
+    /**
+     * Call f(collider) for every collider accepted by filter in the cells
+     * around origin, ring after ring, see GridBroadPhase::nearest
+     */
+    template<class F>
+    void nearest(const Vec2<> &origin,
+                 float maxDistance,
+                 const CollisionFilter &filter,
+                 F &&f) const {
+        auto visit = [&](std::span<const Entry> cellEntries) {
+            for (const Entry &entry : cellEntries)
+                if (colliders[entry.slot] && filter.accepts(entry.filter))
+                    maxDistance = f(colliders[entry.slot]);
+        };
+
+        const CellRings rings{origin};
+        size_t visited = 0;
+        int32_t ring = 0;
+        for (; rings.distance(ring) <= maxDistance; ring++) {
+            // rings larger than the grid look up more cells than it has
+            visited += CellRings::size(ring);
+            if (visited > keys.size())
+                break;
+            rings.forEach(ring, [&](const Vec2<int32_t> &cell) {
+                visit((*this)[cell]);
+            });
+        }
+        if (rings.distance(ring) > maxDistance)
+            return;
+        forEachCell([&](const Vec2<int32_t> &cell,
+                        std::span<const Entry> cellEntries) {
+            if (rings.ringOf(cell) >= ring &&
+                rings.distance(cell) <= maxDistance)
+                visit(cellEntries);
+        });
+    }
+
+    /**
+     * Call f(collider) once for every collider
+     */
+    template<class F>
+    void forEach(F &&f) const {
+        for (Collider *collider : colliders)
+            if (collider)
+                f(collider);
+    }
+
+    /**
+     * Call f(position, entries) for every cell
+     */
+    template<class F>
+    void forEachCell(F &&f) const {
+        for (size_t cell = 0; cell < keys.size(); cell++)
+            f(positionOf(keys[cell]),
+              std::span(entries).subspan(offsets[cell],
+                                         offsets[cell + 1] - offsets[cell]));
+    }
+};
+
+} // namespace Blob
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Blob/Collision/AABBTree.hpp>
+#include <Blob/Collision/GridBroadPhase.hpp>
+#include <Blob/Collision/HierarchicalGrid.hpp>
+#include <Blob/Collision/SweepAndPrune.hpp>
+
+#include <type_traits>
+
+namespace Blob {
+
+/**
+ * A broad phase policy picks the structure storing each kind of collider:
+ * Policy::BroadPhase<Collider, Form> is used for the colliders of type
+ * Collider (StaticCollider<Form> or DynamicCollider<Form>).
+ *
+ * A broad phase must provide:
+ *  - uint32_t insert(Collider *collider, const Form &form)
+ *  - void erase(uint32_t proxy)
+ *  - void move(uint32_t proxy, const Form &form)
+ *  - void query(const U &form, F &&f) calling f(Collider *) for every
+ *    collider that may overlap form, possibly several times
+ *  - void forEach(F &&f) calling f(Collider *) once per collider
+ */
+
+/**
+ * Use the same broad phase for every collider
+ */
+template<template<class, class> class BroadPhaseType>
+struct UniformBroadPhase {
+    template<class Collider, class Form>
+    using BroadPhase = BroadPhaseType<Collider, Form>;
+};
+
+typedef UniformBroadPhase<GridBroadPhase> GridPolicy;
+typedef UniformBroadPhase<AABBTree> AABBTreePolicy;
+typedef UniformBroadPhase<HierarchicalGrid> HierarchicalGridPolicy;
+typedef UniformBroadPhase<SweepAndPrune> SweepAndPrunePolicy;
+
+/**
+ * Use BroadPhaseType for the colliders of the forms in Forms..., and the
+ * broad phase of Default for the others.
+ * Example: BroadPhaseFor<GridPolicy, AABBTree, Rectangle, Line>
+ */
+template<class Default,
+         template<class, class>
+         class BroadPhaseType,
+         class... Forms>
+struct BroadPhaseFor {
+    template<class Collider, class Form>
+    using BroadPhase = std::conditional_t<
+        (std::is_same_v<Form, Forms> || ...),
+        BroadPhaseType<Collider, Form>,
+        typename Default::template BroadPhase<Collider, Form>>;
+};
+
+} // namespace Blob
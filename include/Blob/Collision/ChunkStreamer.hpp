@@ -0,0 +1,279 @@
+#pragma once
+
+#include <Blob/Collision/CollisionChunk.hpp>
+#include <Blob/Collision/CollisionDetector.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace Blob {
+
+/**
+ * Keep the chunks of the static world near a point attached to a collision
+ * detector. The chunks are loaded and baked on a streaming thread and
+ * destroyed there, the thread calling update() only attaches and detaches
+ * them, which does not depend on their size. Only the chunks within the
+ * unload radius stay in memory.
+ *
+ * The detector must outlive the streamer.
+ */
+template<class Policy, class... Types>
+class BasicChunkStreamer {
+public:
+    typedef BasicCollisionChunk<Types...> Chunk;
+
+    /**
+     * Load the chunk at a chunk position, for instance with Chunk::read, on
+     * the streaming thread. Return nullptr if there is no chunk there.
+     */
+    typedef std::function<std::unique_ptr<Chunk>(const Vec2<int32_t> &)>
+        Loader;
+
+private:
+    BasicCollisionDetector<Policy, Types...> &collisionDetector;
+    const float chunkSize;
+    const Loader loader;
+
+    // attached to the detector, nullptr where there is no chunk
+    std::unordered_map<Vec2<int32_t>, std::unique_ptr<Chunk>> loadedChunks;
+    // queued or being loaded
+    std::unordered_set<Vec2<int32_t>> requestedChunks;
+
+    // shared with the streaming thread
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workDone;
+    std::deque<Vec2<int32_t>> requests;
+    std::vector<std::pair<Vec2<int32_t>, std::unique_ptr<Chunk>>> readyChunks;
+    std::vector<Vec2<int32_t>> failedChunks;
+    // detached chunks, destroyed by the streaming thread
+    std::vector<std::unique_ptr<Chunk>> garbage;
+    bool loading = false;
+    std::exception_ptr exception;
+    bool stop = false;
+
+    std::thread worker;
+
+    void work() {
+        std::unique_lock lock(mutex);
+        while (true) {
+            workAvailable.wait(lock, [&] {
+                return stop || !requests.empty() || !garbage.empty();
+            });
+            if (stop)
+                return;
+
+            std::vector<std::unique_ptr<Chunk>> destroyed;
+            std::swap(destroyed, garbage);
+            const bool load = !requests.empty();
+            Vec2<int32_t> position;
+            if (load) {
+                position = requests.front();
+                requests.pop_front();
+                loading = true;
+            }
+            lock.unlock();
+
+            destroyed.clear();
+            std::unique_ptr<Chunk> chunk;
+            std::exception_ptr error;
+            if (load) {
+                try {
+                    chunk = loader(position);
+                    if (chunk)
+                        chunk->bake();
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            }
+
+            lock.lock();
+            if (load) {
+                loading = false;
+                if (error) {
+                    failedChunks.push_back(position);
+                    if (!exception)
+                        exception = error;
+                } else
+                    readyChunks.emplace_back(position, std::move(chunk));
+            }
+            workDone.notify_all();
+        }
+    }
+
+    // distance from center to the square of a chunk
+    float distanceTo(const Vec2<> &center, const Vec2<int32_t> &chunk) const {
+        const Vec2<> min = chunk.cast<float>() * chunkSize;
+        const float dx = std::max(
+            {min.x - center.x, 0.f, center.x - min.x - chunkSize});
+        const float dy = std::max(
+            {min.y - center.y, 0.f, center.y - min.y - chunkSize});
+        return std::sqrt(dx * dx + dy * dy);
+    }
+
+public:
+    /**
+     * @param chunkSize side of the square of a chunk, the chunk at position
+     * covers [position * chunkSize, (position + 1) * chunkSize]
+     */
+    BasicChunkStreamer(BasicCollisionDetector<Policy, Types...> &detector,
+                       float chunkSize,
+                       Loader loader) :
+        collisionDetector(detector),
+        chunkSize(chunkSize),
+        loader(std::move(loader)),
+        worker(&BasicChunkStreamer::work, this) {}
+
+    BasicChunkStreamer(const BasicChunkStreamer &) = delete;
+
+    BasicChunkStreamer(BasicChunkStreamer &&) = delete;
+
+    ~BasicChunkStreamer() {
+        {
+            std::lock_guard lock(mutex);
+            stop = true;
+        }
+        workAvailable.notify_all();
+        worker.join();
+        for (const auto &[position, chunk] : loadedChunks)
+            if (chunk)
+                collisionDetector.detachChunk(*chunk);
+    }
+
+    /**
+     * Attach the chunks loaded since the last call, detach the chunks farther
+     * than unloadRadius and request the chunks within loadRadius, the nearest
+     * first. Call it between two detector updates, for instance every frame.
+     * An exception thrown by the loader is rethrown here, the chunk will be
+     * requested again.
+     * @param unloadRadius at least loadRadius, a margin avoids loading and
+     * unloading a chunk on its border again and again
+     */
+    void update(const Vec2<> &center, float loadRadius, float unloadRadius) {
+        std::vector<std::pair<Vec2<int32_t>, std::unique_ptr<Chunk>>> ready;
+        std::vector<Vec2<int32_t>> failed;
+        std::exception_ptr error;
+        {
+            std::lock_guard lock(mutex);
+            std::swap(ready, readyChunks);
+            std::swap(failed, failedChunks);
+            std::swap(error, exception);
+            std::erase_if(requests, [&](const Vec2<int32_t> &position) {
+                if (distanceTo(center, position) <= unloadRadius)
+                    return false;
+                requestedChunks.erase(position);
+                return true;
+            });
+        }
+        for (const Vec2<int32_t> &position : failed)
+            requestedChunks.erase(position);
+
+        std::vector<std::unique_ptr<Chunk>> detached;
+        for (auto &[position, chunk] : ready) {
+            requestedChunks.erase(position);
+            if (distanceTo(center, position) > unloadRadius) {
+                detached.push_back(std::move(chunk));
+                continue;
+            }
+            if (chunk)
+                collisionDetector.attachChunk(*chunk);
+            loadedChunks[position] = std::move(chunk);
+        }
+        for (auto it = loadedChunks.begin(); it != loadedChunks.end();) {
+            if (distanceTo(center, it->first) <= unloadRadius) {
+                ++it;
+                continue;
+            }
+            if (it->second) {
+                collisionDetector.detachChunk(*it->second);
+                detached.push_back(std::move(it->second));
+            }
+            it = loadedChunks.erase(it);
+        }
+
+        const Vec2<> firstCorner = (center - loadRadius) / chunkSize;
+        const Vec2<> lastCorner = (center + loadRadius) / chunkSize;
+        std::vector<Vec2<int32_t>> newRequests;
+        for (auto y = (int32_t) std::floor(firstCorner.y);
+             y <= (int32_t) std::floor(lastCorner.y);
+             y++)
+            for (auto x = (int32_t) std::floor(firstCorner.x);
+                 x <= (int32_t) std::floor(lastCorner.x);
+                 x++) {
+                const Vec2<int32_t> position{x, y};
+                if (distanceTo(center, position) <= loadRadius &&
+                    !loadedChunks.contains(position) &&
+                    requestedChunks.insert(position).second)
+                    newRequests.push_back(position);
+            }
+        std::sort(newRequests.begin(),
+                  newRequests.end(),
+                  [&](const Vec2<int32_t> &a, const Vec2<int32_t> &b) {
+                      return distanceTo(center, a) < distanceTo(center, b);
+                  });
+
+        if (!newRequests.empty() || !detached.empty()) {
+            {
+                std::lock_guard lock(mutex);
+                requests.insert(
+                    requests.end(), newRequests.begin(), newRequests.end());
+                for (auto &chunk : detached)
+                    if (chunk)
+                        garbage.push_back(std::move(chunk));
+            }
+            workAvailable.notify_one();
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    /**
+     * Wait for the requested chunks to be loaded, the next update() attaches
+     * them. For loading screens and tests.
+     */
+    void waitIdle() {
+        std::unique_lock lock(mutex);
+        workDone.wait(lock, [&] { return requests.empty() && !loading; });
+    }
+
+    /**
+     * @return the number of chunk positions attached, with or without a chunk
+     */
+    size_t loadedCount() const { return loadedChunks.size(); }
+
+    /**
+     * @return the number of chunks requested and not attached yet
+     */
+    size_t pendingCount() const { return requestedChunks.size(); }
+
+    /**
+     * @return the chunk attached at a position, nullptr if none
+     */
+    const Chunk *find(const Vec2<int32_t> &position) const {
+        auto it = loadedChunks.find(position);
+        return it == loadedChunks.end() ? nullptr : it->second.get();
+    }
+};
+
+typedef BasicChunkStreamer<GridPolicy,
+                           Circle,
+                           Rectangle,
+                           Point,
+                           Line,
+                           Polygon,
+                           RasterArea>
+    ChunkStreamer;
+
+} // namespace Blob
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Blob {
+
+class PhysicalObject;
+
+/**
+ * Reference to a collider enabled in a BasicCollisionDetector, safe to keep
+ * after the collider is disabled or destroyed: the detector then finds
+ * nullptr for it, even when another collider took its slot. 24 bits of slot
+ * index and 8 bits of generation of the slot in 32 bits, half a pointer.
+ */
+class ColliderHandle {
+    friend class ColliderPool;
+
+public:
+    static constexpr uint32_t indexBits = 24;
+    static constexpr uint32_t maxIndex = (1u << indexBits) - 1;
+
+private:
+    // 0 is the null handle, the generations start at 1
+    uint32_t value = 0;
+
+    ColliderHandle(uint32_t index, uint32_t generation) :
+        value(index | generation << indexBits) {}
+
+public:
+    ColliderHandle() = default;
+
+    uint32_t index() const { return value & maxIndex; }
+
+    uint32_t generation() const { return value >> indexBits; }
+
+    explicit operator bool() const { return value != 0; }
+
+    bool operator==(const ColliderHandle &) const = default;
+};
+
+/**
+ * Slots of the enabled colliders, addressed by ColliderHandle. A slot freed
+ * by a disabled collider is reused with the next generation, the handles of
+ * the old collider no longer match it. A slot freed at its last generation is
+ * retired instead of wrapping around, so a stale handle never finds a new
+ * collider: one slot is lost every 255 reuses.
+ */
+class ColliderPool {
+private:
+    static constexpr uint8_t maxGeneration = 255;
+
+    struct Slot {
+        PhysicalObject *object = nullptr;
+        uint8_t generation = 1;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    // slots freed at maxGeneration, never reused
+    size_t retiredSlots = 0;
+
+public:
+    /**
+     * @return a new handle of object
+     */
+    ColliderHandle add(PhysicalObject *object);
+
+    /**
+     * Free the slot of a handle returned by add, every copy of the handle
+     * becomes stale
+     */
+    void remove(ColliderHandle handle);
+
+    /**
+     * @return the object of a handle, nullptr if the handle is null or stale
+     */
+    PhysicalObject *operator[](ColliderHandle handle) const {
+        const uint32_t index = handle.index();
+        if (index >= slots.size() ||
+            slots[index].generation != handle.generation())
+            return nullptr;
+        return slots[index].object;
+    }
+
+    /**
+     * @return the number of handles in use
+     */
+    size_t size() const {
+        return slots.size() - freeSlots.size() - retiredSlots;
+    }
+};
+
+} // namespace Blob
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <Blob/Collision/BakedGrid.hpp>
+#include <Blob/Collision/CollisionDetector.hpp>
+#include <Blob/Collision/Forms.hpp>
+#include <Blob/Core/Exception.hpp>
+
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <tuple>
+
+namespace Blob {
+
+/**
+ * Static collider owned by a BasicCollisionChunk. Its objectType is
+ * typeid(ChunkCollider<T>), tag tells the game what it is.
+ */
+template<class T>
+class ChunkCollider : public StaticCollider<T> {
+public:
+    // saved with the chunk, for instance a material or a tile id
+    const uint32_t tag;
+
+    ChunkCollider(T &&form, const CollisionFilter &filter, uint32_t tag) :
+        StaticCollider<T>(typeid(ChunkCollider<T>), std::move(form), filter),
+        tag(tag) {}
+};
+
+/**
+ * Binary format of the chunks, little endian whatever the platform
+ */
+namespace ChunkFormat {
+
+void writeU32(std::ostream &out, uint32_t value);
+uint32_t readU32(std::istream &in);
+
+void writeForm(std::ostream &out, const Circle &form);
+void writeForm(std::ostream &out, const Rectangle &form);
+void writeForm(std::ostream &out, const Point &form);
+void writeForm(std::ostream &out, const Line &form);
+void writeForm(std::ostream &out, const Polygon &form);
+void writeForm(std::ostream &out, const RasterArea &form);
+
+template<class T>
+T readForm(std::istream &in);
+
+template<>
+Circle readForm<Circle>(std::istream &in);
+template<>
+Rectangle readForm<Rectangle>(std::istream &in);
+template<>
+Point readForm<Point>(std::istream &in);
+template<>
+Line readForm<Line>(std::istream &in);
+template<>
+Polygon readForm<Polygon>(std::istream &in);
+template<>
+RasterArea readForm<RasterArea>(std::istream &in);
+
+} // namespace ChunkFormat
+
+/**
+ * Piece of the static world that can be saved, loaded and attached to a
+ * collision detector on its own. A chunk owns its colliders and a baked grid
+ * of them per form, so attaching it costs nothing and the whole chunk can be
+ * loaded and baked on another thread, see BasicChunkStreamer.
+ *
+ * The colliders are not clipped to the chunk: a collider crossing the border
+ * can be saved in either chunk, the queries use the real bounds of each chunk.
+ * @tparam Types the forms of the detector the chunk is attached to
+ */
+template<class... Types>
+class BasicCollisionChunk {
+private:
+    static constexpr uint32_t magic = 0x4B48434C; // "LCHK"
+    static constexpr uint32_t version = 1;
+
+    template<class T>
+    struct Layer {
+        // a deque keeps the colliders in place when one is added
+        std::deque<ChunkCollider<T>> colliders;
+        BakedGrid<StaticCollider<T>, T> grid;
+        Box bounds;
+    };
+
+    std::tuple<Layer<Types>...> layers;
+
+    template<class T>
+    void bakeLayer(ThreadPool *threadPool) {
+        Layer<T> &layer = std::get<Layer<T>>(layers);
+        std::vector<StaticCollider<T> *> colliders;
+        colliders.reserve(layer.colliders.size());
+        for (ChunkCollider<T> &collider : layer.colliders) {
+            layer.bounds = colliders.empty()
+                               ? collider.form.bounds()
+                               : layer.bounds.merge(collider.form.bounds());
+            colliders.push_back(&collider);
+        }
+        layer.grid.build(colliders, threadPool);
+    }
+
+    template<class T>
+    void writeLayer(std::ostream &out) const {
+        const Layer<T> &layer = std::get<Layer<T>>(layers);
+        ChunkFormat::writeU32(out, (uint32_t) layer.colliders.size());
+        for (const ChunkCollider<T> &collider : layer.colliders) {
+            ChunkFormat::writeU32(out, collider.tag);
+            ChunkFormat::writeU32(out,
+                                  collider.collisionFilter.category |
+                                      collider.collisionFilter.mask << 16u);
+            ChunkFormat::writeForm(out, collider.form);
+        }
+    }
+
+    template<class T>
+    void readLayer(std::istream &in) {
+        const uint32_t count = ChunkFormat::readU32(in);
+        for (uint32_t i = 0; i < count; i++) {
+            const uint32_t tag = ChunkFormat::readU32(in);
+            const uint32_t filter = ChunkFormat::readU32(in);
+            add(ChunkFormat::readForm<T>(in),
+                CollisionFilter{(uint16_t) filter, (uint16_t) (filter >> 16u)},
+                tag);
+        }
+    }
+
+public:
+    // position of the chunk in the chunk grid
+    const Vec2<int32_t> position;
+
+    explicit BasicCollisionChunk(const Vec2<int32_t> &position) :
+        position(position) {}
+
+    BasicCollisionChunk(const BasicCollisionChunk &) = delete;
+
+    BasicCollisionChunk(BasicCollisionChunk &&) = delete;
+
+    /**
+     * Add a static collider, seen by the queries after the next bake()
+     */
+    template<class T>
+    void add(T form, const CollisionFilter &filter = {}, uint32_t tag = 0) {
+        std::get<Layer<T>>(layers).colliders.emplace_back(
+            std::move(form), filter, tag);
+    }
+
+    /**
+     * Build the grids of the colliders, before attaching the chunk
+     * @param threadPool rasterize on its threads if not null
+     */
+    void bake(ThreadPool *threadPool = nullptr) {
+        (bakeLayer<Types>(threadPool), ...);
+    }
+
+    template<class T>
+    const std::deque<ChunkCollider<T>> &colliders() const {
+        return std::get<Layer<T>>(layers).colliders;
+    }
+
+    template<class T>
+    const BakedGrid<StaticCollider<T>, T> &grid() const {
+        return std::get<Layer<T>>(layers).grid;
+    }
+
+    template<class T>
+    const Box &bounds() const {
+        return std::get<Layer<T>>(layers).bounds;
+    }
+
+    /**
+     * @return the number of colliders of every form
+     */
+    size_t size() const {
+        return (std::get<Layer<Types>>(layers).colliders.size() + ...);
+    }
+
+    /**
+     * Save the position and the colliders, not the grids
+     */
+    void write(std::ostream &out) const {
+        ChunkFormat::writeU32(out, magic);
+        ChunkFormat::writeU32(out, version);
+        ChunkFormat::writeU32(out, (uint32_t) position.x);
+        ChunkFormat::writeU32(out, (uint32_t) position.y);
+        (writeLayer<Types>(out), ...);
+    }
+
+    /**
+     * Load a chunk saved by write(), not baked yet
+     */
+    static std::unique_ptr<BasicCollisionChunk> read(std::istream &in) {
+        if (ChunkFormat::readU32(in) != magic)
+            throw Exception("Not a collision chunk");
+        if (ChunkFormat::readU32(in) != version)
+            throw Exception("Unsupported collision chunk version");
+        const int32_t x = (int32_t) ChunkFormat::readU32(in);
+        const int32_t y = (int32_t) ChunkFormat::readU32(in);
+        auto chunk = std::make_unique<BasicCollisionChunk>(Vec2{x, y});
+        (chunk->template readLayer<Types>(in), ...);
+        return chunk;
+    }
+};
+
+typedef BasicCollisionChunk<Circle,
+                            Rectangle,
+                            Point,
+                            Line,
+                            Polygon,
+                            RasterArea>
+    CollisionChunk;
+
+} // namespace Blob
@@ -1,10 +1,31 @@
 #pragma once
 
+#include <Blob/Collision/BakedGrid.hpp>
+#include <Blob/Collision/BroadPhase.hpp>
+#include <Blob/Collision/ColliderPool.hpp>
+#include <Blob/Collision/CollisionFilter.hpp>
+#include <Blob/Collision/CollisionStatistics.hpp>
+#include <Blob/Collision/ContactCache.hpp>
 #include <Blob/Collision/Forms.hpp>
+#include <Blob/Collision/ThreadPool.hpp>
 #include <Blob/Core/Exception.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
-#include <unordered_map>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
 
 #ifdef BLOB_COLLISION_IMGUI
 #include <imgui.h>
@@ -14,60 +35,302 @@
 namespace Blob {
 
 class PhysicalObject {
-    template<typename U>
+    template<typename U, class P>
     friend class FormDatabase;
+    template<class Policy, class... Types>
+    friend class BasicCollisionDetector;
 
 private:
+    enum class SleepState : uint8_t {
+        Awake,
+        // will sleep at the end of the update unless something wakes it
+        Drowsy,
+        Sleeping
+    };
+
     bool enable = false;
+    // only the dynamic colliders sleep
+    SleepState sleepState = SleepState::Awake;
+    CollisionFilter filter;
+    ColliderHandle handle;
 
 protected:
-    explicit PhysicalObject(const std::type_info &objectType) :
-        objectType(objectType) {}
+    explicit PhysicalObject(const std::type_info &objectType,
+                            const CollisionFilter &filter = {}) :
+        filter(filter), objectType(objectType) {}
+
+    /**
+     * Change the collision layers, only while the collision is disabled since
+     * the broad phases keep a copy of the filter
+     */
+    void setCollisionFilter(const CollisionFilter &collisionFilter) {
+        if (enable)
+            throw Exception("Collision filter changed on an enabled collider");
+        filter = collisionFilter;
+    }
 
 public:
     const std::type_info &objectType;
+    const CollisionFilter &collisionFilter{filter};
 
     PhysicalObject(const PhysicalObject &) = delete;
 
     PhysicalObject(PhysicalObject &&) = delete;
 
     virtual ~PhysicalObject() = default;
+
+    /**
+     * @return true if the collider is a sleeping DynamicCollider, see
+     * BasicCollisionDetector::setSleepDelay
+     */
+    bool isSleeping() const { return sleepState == SleepState::Sleeping; }
+
+    /**
+     * @return the handle of the collider while it is enabled, to find it with
+     * BasicCollisionDetector::find. Null for a disabled collider and for the
+     * colliders of a chunk.
+     */
+    ColliderHandle getHandle() const { return handle; }
 };
 
 template<class T>
 class StaticCollider : public PhysicalObject {
-    template<typename U>
+    template<typename U, class P>
     friend class FormDatabase;
 
+private:
+    // identifies the collider in the static broad phase, or in the baked
+    // grid if baked
+    uint32_t proxy = 0;
+    bool baked = false;
+
 public:
     const T form;
 
-    StaticCollider(const std::type_info &objectType, T &&form) :
-        PhysicalObject(objectType), form(form) {}
+    StaticCollider(const std::type_info &objectType,
+                   T &&form,
+                   const CollisionFilter &filter = {}) :
+        PhysicalObject(objectType, filter), form(form) {}
+};
+
+/**
+ * Nearest collider hit by a ray
+ */
+struct RaycastHit {
+    PhysicalObject *object = nullptr;
+    Vec2<> point;
+    // facing the ray
+    Vec2<> normal;
+    float distance = 0;
+};
+
+/**
+ * Collider found by BasicCollisionDetector::nearest and withinRadius
+ */
+struct Neighbour {
+    PhysicalObject *object;
+    // from the point to the form, 0 inside it
+    float distance;
+};
+
+/**
+ * Told when static colliders are enabled or disabled, to rebuild what is
+ * derived from them, see BasicCollisionDetector::addStaticListener
+ */
+class StaticListener {
+public:
+    virtual ~StaticListener() = default;
+
+    /**
+     * Called on the thread changing the static colliders, after the change.
+     * Keep it short, for instance note bounds and handle it later.
+     * @param bounds box of the colliders enabled or disabled
+     */
+    virtual void staticChanged(const Box &bounds) = 0;
+};
+
+/**
+ * Nearest colliders found so far by a nearest query: a max-heap of at most k
+ * neighbours, or every neighbour within radius if k is unbounded
+ */
+class NeighbourHeap {
+private:
+    std::vector<Neighbour> &neighbours;
+    const size_t k;
+
+    static bool nearer(const Neighbour &a, const Neighbour &b) {
+        return a.distance < b.distance;
+    }
+
+public:
+    // distance up to which neighbours are still wanted
+    float radius;
+
+    NeighbourHeap(std::vector<Neighbour> &neighbours, size_t k, float radius) :
+        neighbours(neighbours), k(k), radius(radius) {
+        neighbours.clear();
+    }
+
+    /**
+     * @return the new radius
+     */
+    float add(PhysicalObject *object, float distance) {
+        if (distance > radius || k == 0)
+            return radius;
+        if (k == std::numeric_limits<size_t>::max()) {
+            neighbours.push_back({object, distance});
+            return radius;
+        }
+        if (neighbours.size() == k && distance >= radius)
+            return radius;
+        // a collider is found once per cell it is in, only the candidates
+        // that would get in are looked up
+        for (const Neighbour &neighbour : neighbours)
+            if (neighbour.object == object)
+                return radius;
+        if (neighbours.size() == k) {
+            std::pop_heap(neighbours.begin(), neighbours.end(), nearer);
+            neighbours.pop_back();
+        }
+        neighbours.push_back({object, distance});
+        std::push_heap(neighbours.begin(), neighbours.end(), nearer);
+        if (neighbours.size() == k)
+            radius = neighbours.front().distance;
+        return radius;
+    }
+
+    /**
+     * Sort the neighbours by distance, without duplicates
+     */
+    void finish() {
+        if (k == std::numeric_limits<size_t>::max()) {
+            std::sort(neighbours.begin(),
+                      neighbours.end(),
+                      [](const Neighbour &a, const Neighbour &b) {
+                          return a.object < b.object;
+                      });
+            neighbours.erase(std::unique(neighbours.begin(),
+                                         neighbours.end(),
+                                         [](const Neighbour &a,
+                                            const Neighbour &b) {
+                                             return a.object == b.object;
+                                         }),
+                             neighbours.end());
+            std::sort(neighbours.begin(), neighbours.end(), nearer);
+        } else
+            std::sort_heap(neighbours.begin(), neighbours.end(), nearer);
+    }
+};
+
+/**
+ * Results of BasicCollisionDetector::testCollisions. The buffers are kept from
+ * one call to the next, so the queries of every frame do not allocate once
+ * they are large enough.
+ */
+class CollisionQueryResults {
+    template<class Policy, class... Types>
+    friend class BasicCollisionDetector;
+
+public:
+    struct Hit {
+        // index of the query form
+        uint32_t query;
+        PhysicalObject *object;
+    };
+
+private:
+    std::vector<Hit> hits;
+    // the hits of query i are from offsets[i] to offsets[i + 1]
+    std::vector<uint32_t> offsets;
+    // colliders found by each query, before they are packed in hits
+    std::vector<std::vector<PhysicalObject *>> found;
+
+public:
+    /**
+     * @return the number of queries
+     */
+    size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+    /**
+     * @return the hits of every query, grouped by query in order
+     */
+    std::span<const Hit> all() const { return hits; }
+
+    std::span<const uint32_t> getOffsets() const { return offsets; }
+
+    /**
+     * @return the hits of a query, sorted by object address
+     */
+    std::span<const Hit> operator[](size_t query) const {
+        return std::span(hits).subspan(offsets[query],
+                                       offsets[query + 1] - offsets[query]);
+    }
 };
 
 template<class T>
 class DynamicCollider : public PhysicalObject {
-    template<typename U>
+    template<typename U, class P>
     friend class FormDatabase;
-    template<class... Types>
-    friend class CollisionDetectorTemplate;
+    template<class Policy, class... Types>
+    friend class BasicCollisionDetector;
 
 private:
-    std::unordered_set<PhysicalObject *> hitting;
+    ContactRun contacts{this};
     T form;
+    // identifies the collider in the dynamic broad phase
+    uint32_t proxy = 0;
+    // position in FormDatabase::dynamicColliders, ghostColliders or
+    // sleepingColliders
+    size_t index = 0;
+    // updates in a row without a change of form or contacts
+    uint32_t restingFrames = 0;
+    // swept from its form to the next one, see setContinuous
+    bool continuous = false;
+    std::optional<RaycastHit> firstHit;
 
 protected:
-    const std::unordered_set<PhysicalObject *> &hittingObjects{hitting};
-    explicit DynamicCollider(const std::type_info &objectType, T &&form) :
-        PhysicalObject(objectType), form(form) {}
+    explicit DynamicCollider(const std::type_info &objectType,
+                             T &&form,
+                             const CollisionFilter &filter = {}) :
+        PhysicalObject(objectType, filter), form(form) {}
+
+    /**
+     * @return the objects hit since the last update of this collider, sorted
+     * by address
+     */
+    std::span<PhysicalObject *const> hittingObjects() const {
+        return contacts.targets();
+    }
+
+    /**
+     * For a continuous collider, see BasicCollisionDetector::setContinuous:
+     * the first collider touched on the way from the current form to the next
+     * one, also in hittingObjects(). Set from preCollisionUpdate to the end of
+     * postCollisionUpdate, which can stop the collider there.
+     */
+    const std::optional<RaycastHit> &sweepHit() const { return firstHit; }
 
     virtual void hitStart(PhysicalObject *object) {}
 
     virtual void hitEnd(PhysicalObject *object) {}
 
     /**
-     * This method is called right before the collision is computed
+     * Called when the collider falls asleep, see
+     * BasicCollisionDetector::setSleepDelay. A sleeping collider is not
+     * updated, it keeps its form and its contacts.
+     */
+    virtual void sleepStart() {}
+
+    /**
+     * Called when the collider wakes up, because a moving collider touched it
+     * or left it, or because of BasicCollisionDetector::wakeUp
+     */
+    virtual void sleepEnd() {}
+
+    /**
+     * This method is called right before the collision is computed. With
+     * BasicCollisionDetector::setParallelUpdate it is called from several
+     * threads at the same time and must only modify this collider.
      * @param currentForm the actual form used for the collision detection
      * @param timeFlow Time in second sinse list frame
      * @return the form you wish to test the next collision
@@ -80,7 +343,7 @@ protected:
      * This method is called right after the collision is computed and return
      * the final position that will be saved in the internal spacial definition.
      * In this method CollisionDetector::testCollision will never detect itself
-     * because it is not in the internal spacial definition yet.
+     * because the collider being updated is ignored.
      * @param currentForm Time in second sins list frame
      * @param nextForm Time in second sins list frame
      * @param timeFlow Time in second sins list frame
@@ -95,18 +358,323 @@ public:
     const T &collider{form};
 };
 
-template<class T>
+template<class T, class Policy>
 class FormDatabase {
-    template<typename U>
+    template<typename U, class P>
     friend class FormDatabase;
 
 protected:
-    std::unordered_map<Vec2<int32_t>, std::unordered_set<StaticCollider<T> *>>
-        staticSpacialHash;
-    std::unordered_map<Vec2<int32_t>, std::unordered_set<DynamicCollider<T> *>>
-        dynamicSpacialHash;
-    std::unordered_set<DynamicCollider<T> *> dynamicColliders;
-    std::unordered_set<DynamicCollider<T> *> ghostColliders;
+    typename Policy::template BroadPhase<StaticCollider<T>, T> staticBroadPhase;
+    // static colliders enabled with bakeStatic
+    BakedGrid<StaticCollider<T>, T> bakedStatics;
+
+    // baked grid of an attached chunk, with the bounds of its colliders
+    struct AttachedChunk {
+        const BakedGrid<StaticCollider<T>, T> *grid;
+        Box bounds;
+    };
+    std::vector<AttachedChunk> chunks;
+    typename Policy::template BroadPhase<DynamicCollider<T>, T>
+        dynamicBroadPhase;
+    // walked in this order by update(), which does not depend on addresses
+    std::vector<DynamicCollider<T> *> dynamicColliders;
+    std::vector<DynamicCollider<T> *> ghostColliders;
+    // still in the dynamic broad phase but not updated
+    std::vector<DynamicCollider<T> *> sleepingColliders;
+    // null entries in the lists above, see unlink
+    bool holes = false;
+    // found during an update, applied after it by settle()
+    std::vector<DynamicCollider<T> *> pendingSleeps;
+    std::vector<DynamicCollider<T> *> pendingWakes;
+    // colliders that moved or changed contacts during the update, they wake
+    // the colliders they touch
+    std::vector<DynamicCollider<T> *> movers;
+    // pairs of dynamic colliders overlapping after the last update, kept when
+    // the broad phase sweeps them all at once, see sweepPairs
+    std::vector<std::pair<DynamicCollider<T> *, DynamicCollider<T> *>>
+        dynamicPairs;
+    // a dynamic collider was enabled, disabled or restored since
+    bool pairsStale = true;
+    // owned by the CollisionDetector
+    ContactCache *contactCache = nullptr;
+    ColliderPool *colliderPool = nullptr;
+    std::vector<StaticListener *> *staticListeners = nullptr;
+
+    // Result of the first phase of a parallel update, one per collider
+    struct PendingUpdate {
+        std::optional<T> nextForm;
+        // sorted by address, without duplicates
+        std::vector<PhysicalObject *> hitedTargets;
+    };
+    std::vector<PendingUpdate> pendingDynamics;
+    std::vector<PendingUpdate> pendingGhosts;
+
+    // State of the dynamic and ghost colliders between two updates, a
+    // collider per element in the order dynamicColliders, sleepingColliders,
+    // ghostColliders
+    struct Snapshot {
+        std::vector<DynamicCollider<T> *> colliders;
+        std::vector<ColliderHandle> handles;
+        std::vector<T> forms;
+        std::vector<uint32_t> restingFrames;
+        size_t dynamicCount = 0;
+        size_t sleepingCount = 0;
+    };
+
+    static void link(std::vector<DynamicCollider<T> *> &colliders,
+                     DynamicCollider<T> &collider) {
+        collider.index = colliders.size();
+        colliders.push_back(&collider);
+    }
+
+    // During an update the lists are walked by index, a collider removed
+    // leaves a null entry until compact()
+    void unlink(std::vector<DynamicCollider<T> *> &colliders,
+                DynamicCollider<T> &collider) {
+        if (contactCache->isUpdating()) {
+            colliders[collider.index] = nullptr;
+            holes = true;
+            return;
+        }
+        DynamicCollider<T> *last = colliders.back();
+        colliders[collider.index] = last;
+        last->index = collider.index;
+        colliders.pop_back();
+    }
+
+    /**
+     * After an update: remove the null entries left by the colliders disabled
+     * during it, the others keep their order
+     */
+    void compact() {
+        if (!holes)
+            return;
+        for (auto *colliders :
+             {&dynamicColliders, &sleepingColliders, &ghostColliders}) {
+            std::erase(*colliders, nullptr);
+            for (size_t i = 0; i < colliders->size(); i++)
+                (*colliders)[i]->index = i;
+        }
+        holes = false;
+    }
+
+    static constexpr bool sweepsPairs = requires {
+        std::declval<const decltype(dynamicBroadPhase) &>().forEachPair(
+            std::declval<void (*)(DynamicCollider<T> *,
+                                  DynamicCollider<T> *)>());
+    };
+
+    /**
+     * Call f(a, b) once for every pair of dynamic colliders whose forms
+     * overlap and whose filters accept each other, with the pair sweep of
+     * the broad phase if it has one
+     */
+    template<class F>
+    void sweepDynamicPairs(F &&f) const {
+        auto test = [&](DynamicCollider<T> *a, DynamicCollider<T> *b) {
+            if (a->collisionFilter.accepts(b->collisionFilter) &&
+                a->form.overlap(b->form))
+                f(a, b);
+        };
+        if constexpr (sweepsPairs)
+            dynamicBroadPhase.forEachPair(test);
+        else {
+            // a query may give a collider several times
+            std::vector<DynamicCollider<T> *> found;
+            for (const auto *colliders :
+                 {&dynamicColliders, &sleepingColliders})
+                for (DynamicCollider<T> *a : *colliders) {
+                    if (!a)
+                        continue;
+                    found.clear();
+                    dynamicBroadPhase.query(
+                        a->form, [&](DynamicCollider<T> *b) {
+                            if (a < b)
+                                found.push_back(b);
+                        });
+                    std::sort(found.begin(), found.end());
+                    found.erase(std::unique(found.begin(), found.end()),
+                                found.end());
+                    for (DynamicCollider<T> *b : found)
+                        test(a, b);
+                }
+        }
+    }
+
+    /**
+     * After an update: sweep the pairs of dynamic colliders once, when the
+     * broad phase can, for forEachDynamicPair until the next change
+     */
+    void sweepPairs() {
+        if constexpr (sweepsPairs) {
+            dynamicPairs.clear();
+            sweepDynamicPairs(
+                [&](DynamicCollider<T> *a, DynamicCollider<T> *b) {
+                    dynamicPairs.emplace_back(a, b);
+                });
+            pairsStale = false;
+        }
+    }
+
+    template<class F>
+    void forEachDynamicPair(F &&f) const {
+        if (!pairsStale)
+            for (const auto &[a, b] : dynamicPairs)
+                f(a, b);
+        else
+            sweepDynamicPairs(f);
+    }
+
+    void add(std::vector<DynamicCollider<T> *> &colliders,
+             DynamicCollider<T> &collider) {
+        link(colliders, collider);
+        contactCache->attach(collider.contacts);
+        collider.handle = colliderPool->add(&collider);
+    }
+
+    void staticChanged(const Box &bounds) const {
+        for (StaticListener *listener : *staticListeners)
+            listener->staticChanged(bounds);
+    }
+
+    void remove(std::vector<DynamicCollider<T> *> &colliders,
+                DynamicCollider<T> &collider) {
+        unlink(colliders, collider);
+        // the contacts are kept until the collider is enabled again
+        contactCache->detach(collider.contacts);
+        colliderPool->remove(collider.handle);
+        collider.handle = {};
+    }
+
+    void sleep(DynamicCollider<T> &collider) {
+        unlink(dynamicColliders, collider);
+        link(sleepingColliders, collider);
+        collider.sleepState = PhysicalObject::SleepState::Sleeping;
+        collider.sleepStart();
+    }
+
+    void wake(DynamicCollider<T> &collider) {
+        unlink(sleepingColliders, collider);
+        link(dynamicColliders, collider);
+        collider.sleepState = PhysicalObject::SleepState::Awake;
+        collider.restingFrames = 0;
+        collider.sleepEnd();
+    }
+
+    /**
+     * Wake a drowsy or sleeping collider from its PhysicalObject
+     * @return false if it is not a DynamicCollider<T>
+     */
+    bool wakeObject(PhysicalObject *object) {
+        auto *collider = dynamic_cast<DynamicCollider<T> *>(object);
+        if (!collider)
+            return false;
+        if (collider->sleepState == PhysicalObject::SleepState::Sleeping)
+            wake(*collider);
+        else {
+            collider->sleepState = PhysicalObject::SleepState::Awake;
+            collider->restingFrames = 0;
+        }
+        return true;
+    }
+
+    /**
+     * After an update, once every wake is done: put to sleep the colliders
+     * still drowsy
+     */
+    void settle() {
+        for (DynamicCollider<T> *collider : pendingWakes)
+            if (collider->sleepState != PhysicalObject::SleepState::Awake)
+                wakeObject(collider);
+        for (DynamicCollider<T> *collider : pendingSleeps)
+            if (collider->sleepState == PhysicalObject::SleepState::Drowsy)
+                sleep(*collider);
+        pendingWakes.clear();
+        pendingSleeps.clear();
+        movers.clear();
+    }
+
+    void wakeAll() {
+        while (!sleepingColliders.empty()) {
+            if (DynamicCollider<T> *collider = sleepingColliders.back())
+                wake(*collider);
+            else
+                sleepingColliders.pop_back();
+        }
+        for (DynamicCollider<T> *collider : dynamicColliders)
+            if (collider)
+                collider->restingFrames = 0;
+    }
+
+    void snapshot(Snapshot &snapshot) const {
+        snapshot.colliders.clear();
+        for (const auto *colliders :
+             {&dynamicColliders, &sleepingColliders, &ghostColliders})
+            snapshot.colliders.insert(
+                snapshot.colliders.end(), colliders->begin(), colliders->end());
+        const size_t count = snapshot.colliders.size();
+        snapshot.handles.resize(count);
+        snapshot.forms.clear();
+        snapshot.restingFrames.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            const DynamicCollider<T> *collider = snapshot.colliders[i];
+            snapshot.handles[i] = collider->handle;
+            snapshot.forms.push_back(collider->form);
+            snapshot.restingFrames[i] = collider->restingFrames;
+        }
+        snapshot.dynamicCount = dynamicColliders.size();
+        snapshot.sleepingCount = sleepingColliders.size();
+    }
+
+    /**
+     * Throw if the colliders are not the ones of the snapshot
+     */
+    void checkSnapshot(const Snapshot &snapshot) const {
+        for (size_t i = 0; i < snapshot.colliders.size(); i++)
+            if ((*colliderPool)[snapshot.handles[i]] != snapshot.colliders[i])
+                throw Exception("Collider disabled since the snapshot");
+        if (snapshot.colliders.size() != dynamicColliders.size() +
+                                             sleepingColliders.size() +
+                                             ghostColliders.size())
+            throw Exception("Collider enabled since the snapshot");
+    }
+
+    /**
+     * Put the colliders back in the lists and the forms of a snapshot. Only
+     * the colliders whose form changed move in the broad phase, and only the
+     * cells they entered or left are updated.
+     */
+    void restore(const Snapshot &snapshot) {
+        const auto begin = snapshot.colliders.begin();
+        const auto sleeping = begin + (ptrdiff_t) snapshot.dynamicCount;
+        const auto ghosts = sleeping + (ptrdiff_t) snapshot.sleepingCount;
+        dynamicColliders.assign(begin, sleeping);
+        sleepingColliders.assign(sleeping, ghosts);
+        ghostColliders.assign(ghosts, snapshot.colliders.end());
+        pairsStale = true;
+
+        for (size_t i = 0; i < snapshot.colliders.size(); i++) {
+            DynamicCollider<T> *collider = snapshot.colliders[i];
+            const bool ghost = i >= snapshot.dynamicCount +
+                                        snapshot.sleepingCount;
+            if (i < snapshot.dynamicCount) {
+                collider->index = i;
+                collider->sleepState = PhysicalObject::SleepState::Awake;
+            } else if (!ghost) {
+                collider->index = i - snapshot.dynamicCount;
+                collider->sleepState = PhysicalObject::SleepState::Sleeping;
+            } else
+                collider->index = i - snapshot.dynamicCount -
+                                  snapshot.sleepingCount;
+            collider->restingFrames = snapshot.restingFrames[i];
+            collider->firstHit.reset();
+            if (collider->form == snapshot.forms[i])
+                continue;
+            collider->form = snapshot.forms[i];
+            if (!ghost)
+                dynamicBroadPhase.move(collider->proxy, collider->form);
+        }
+    }
 
 protected:
     void enableCollision(StaticCollider<T> &collider) {
@@ -115,10 +683,9 @@ protected:
         else
             throw Exception("Collider already enabled");
 
-        for (const auto &position : collider.form.rasterize())
-            if (!staticSpacialHash[position].insert(&collider).second)
-                throw Exception(
-                    "Insertion in Spacial Hash but element already exist");
+        collider.proxy = staticBroadPhase.insert(&collider, collider.form);
+        collider.handle = colliderPool->add(&collider);
+        staticChanged(collider.form.bounds());
     }
 
     void disableCollision(StaticCollider<T> &collider) {
@@ -127,9 +694,61 @@ protected:
         else
             throw Exception("Collider already disabled");
 
-        for (const auto &position : collider.form.rasterize())
-            if (!staticSpacialHash[position].erase(&collider))
-                throw Exception("Remove in Spacial Hash but no element");
+        colliderPool->remove(collider.handle);
+        collider.handle = {};
+
+        if (collider.baked) {
+            bakedStatics.erase(collider.proxy);
+            collider.baked = false;
+        } else
+            staticBroadPhase.erase(collider.proxy);
+        staticChanged(collider.form.bounds());
+    }
+
+    /**
+     * Enable static colliders in the baked grid, rebuilt with the colliders
+     * already baked
+     * @param newColliders range of StaticCollider<T> or of pointers to them
+     */
+    template<class R>
+    void bakeStatic(R &&newColliders, ThreadPool *threadPool) {
+        std::vector<StaticCollider<T> *> colliders;
+        colliders.reserve(bakedStatics.size());
+        bakedStatics.forEach([&](StaticCollider<T> *collider) {
+            colliders.push_back(collider);
+        });
+        const size_t bakedCount = colliders.size();
+
+        for (auto &&element : newColliders) {
+            StaticCollider<T> *collider;
+            if constexpr (std::is_pointer_v<
+                              std::remove_cvref_t<decltype(element)>>)
+                collider = element;
+            else
+                collider = &element;
+            if (collider->enable) {
+                for (size_t i = bakedCount; i < colliders.size(); i++)
+                    colliders[i]->enable = false;
+                throw Exception("Collider already enabled");
+            }
+            collider->enable = true;
+            colliders.push_back(collider);
+        }
+
+        for (size_t i = 0; i < colliders.size(); i++) {
+            colliders[i]->proxy = (uint32_t) i;
+            colliders[i]->baked = true;
+        }
+        for (size_t i = bakedCount; i < colliders.size(); i++)
+            colliders[i]->handle = colliderPool->add(colliders[i]);
+        bakedStatics.build(colliders, threadPool);
+
+        if (staticListeners->empty() || bakedCount == colliders.size())
+            return;
+        Box bounds = colliders[bakedCount]->form.bounds();
+        for (size_t i = bakedCount + 1; i < colliders.size(); i++)
+            bounds = bounds.merge(colliders[i]->form.bounds());
+        staticChanged(bounds);
     }
 
     void enableCollision(DynamicCollider<T> &collider) {
@@ -138,11 +757,9 @@ protected:
         else
             throw Exception("Dynamic Collider already enabled");
 
-        for (const auto &position : collider.form.rasterize())
-            if (!dynamicSpacialHash[position].insert(&collider).second)
-                throw Exception(
-                    "Insertion in Spacial Hash but element already exist");
-        dynamicColliders.emplace(&collider);
+        collider.proxy = dynamicBroadPhase.insert(&collider, collider.form);
+        pairsStale = true;
+        add(dynamicColliders, collider);
     }
 
     void disableCollision(DynamicCollider<T> &collider) {
@@ -151,11 +768,66 @@ protected:
         else
             throw Exception("Dynamic Collider already disabled");
 
-        for (const auto &position : collider.form.rasterize())
-            if (!dynamicSpacialHash[position].erase(&collider))
-                throw Exception("Remove in Spacial Hash but no element");
+        dynamicBroadPhase.erase(collider.proxy);
+        pairsStale = true;
 
-        dynamicColliders.erase(&collider);
+        std::erase(pendingSleeps, &collider);
+        std::erase(pendingWakes, &collider);
+        std::erase(movers, &collider);
+        if (collider.sleepState == PhysicalObject::SleepState::Sleeping)
+            remove(sleepingColliders, collider);
+        else
+            remove(dynamicColliders, collider);
+        collider.sleepState = PhysicalObject::SleepState::Awake;
+        collider.restingFrames = 0;
+    }
+
+    /**
+     * Make the colliders of a baked grid visible to the queries, without
+     * copying them
+     */
+    void attachChunk(const BakedGrid<StaticCollider<T>, T> &grid,
+                     const Box &bounds) {
+        if (grid.size()) {
+            chunks.push_back({&grid, bounds});
+            staticChanged(bounds);
+        }
+    }
+
+    /**
+     * Call hitEnd(target) on owner, for the contacts ended by detachChunk
+     * @return false if owner is not a DynamicCollider<T>
+     */
+    bool endContact(PhysicalObject *owner, PhysicalObject *target) {
+        auto *collider = dynamic_cast<DynamicCollider<T> *>(owner);
+        if (!collider)
+            return false;
+        collider->hitEnd(target);
+        return true;
+    }
+
+    void detachChunk(const BakedGrid<StaticCollider<T>, T> &grid) {
+        auto it = std::find_if(
+            chunks.begin(), chunks.end(), [&](const AttachedChunk &chunk) {
+                return chunk.grid == &grid;
+            });
+        if (it == chunks.end())
+            return;
+        const Box bounds = it->bounds;
+        chunks.erase(it);
+        staticChanged(bounds);
+    }
+
+    /**
+     * Wake a sleeping collider, for instance after changing what its
+     * preCollisionUpdate returns. During an update the collider wakes at the
+     * end of it.
+     */
+    void wakeUp(DynamicCollider<T> &collider) {
+        if (contactCache->isUpdating())
+            pendingWakes.push_back(&collider);
+        else if (collider.sleepState == PhysicalObject::SleepState::Sleeping)
+            wake(collider);
     }
 
     void enableGhostCollision(DynamicCollider<T> &collider) {
@@ -164,7 +836,7 @@ protected:
         else
             throw Exception("Ghost Collider already enabled");
 
-        ghostColliders.emplace(&collider);
+        add(ghostColliders, collider);
     }
 
     void disableGhostCollision(DynamicCollider<T> &collider) {
@@ -173,109 +845,1140 @@ protected:
         else
             throw Exception("Ghost Collider already disabled");
 
-        ghostColliders.erase(&collider);
+        remove(ghostColliders, collider);
+    }
+
+    /**
+     * Move a dynamic collider in the broad phase after its form changed
+     */
+    void moveCollision(DynamicCollider<T> &collider) {
+        dynamicBroadPhase.move(collider.proxy, collider.form);
     }
 
+    /**
+     * Append the colliders overlapping form and accepted by filter, possibly
+     * several times
+     * @return the work of the broad phases, for the statistics
+     */
     template<class U>
-    void overlap(std::unordered_set<PhysicalObject *> &collidingObjects,
-                 const U &form,
-                 std::unordered_set<Vec2<int32_t>> rasters) const {
-        for (const Vec2<int32_t> &position : rasters) {
-            {
-                auto positions = staticSpacialHash.find(position);
-                if (positions != staticSpacialHash.end())
-                    for (StaticCollider<T> *target : positions->second)
-                        if (form.overlap(target->form))
-                            collidingObjects.emplace(target);
-            }
-            {
-                auto positions = dynamicSpacialHash.find(position);
-                if (positions != dynamicSpacialHash.end())
-                    for (DynamicCollider<T> *target : positions->second)
-                        if (form.overlap(target->form))
-                            collidingObjects.emplace(target);
-            }
+    QueryCounters overlap(std::vector<PhysicalObject *> &collidingObjects,
+                          const U &form,
+                          const CollisionFilter &filter,
+                          const PhysicalObject *ignored) const {
+        auto narrowStatic = [&](StaticCollider<T> *target) {
+            return form.overlap(target->form);
+        };
+        auto addStatic = [&](StaticCollider<T> *target) {
+            collidingObjects.push_back(target);
+        };
+        QueryCounters counters =
+            overlapIn(bakedStatics, form, filter, narrowStatic, addStatic);
+        if (!chunks.empty()) {
+            const Box box = form.bounds();
+            for (const AttachedChunk &chunk : chunks)
+                if (chunk.bounds.overlap(box))
+                    counters += overlapIn(
+                        *chunk.grid, form, filter, narrowStatic, addStatic);
+        }
+        counters +=
+            overlapIn(staticBroadPhase, form, filter, narrowStatic, addStatic);
+        counters += overlapIn(
+            dynamicBroadPhase,
+            form,
+            filter,
+            [&](DynamicCollider<T> *target) {
+                return form.overlap(target->form);
+            },
+            [&](DynamicCollider<T> *target) {
+                if (target != ignored)
+                    collidingObjects.push_back(target);
+            });
+        return counters;
+    }
+
+    /**
+     * @return true if a static collider accepted by filter overlaps form
+     */
+    template<class U>
+    bool overlapStatic(const U &form, const CollisionFilter &filter) const {
+        bool found = false;
+        auto narrow = [&](StaticCollider<T> *target) {
+            return !found && form.overlap(target->form);
+        };
+        auto add = [&](StaticCollider<T> *) { found = true; };
+        overlapIn(bakedStatics, form, filter, narrow, add);
+        if (!found && !chunks.empty()) {
+            const Box box = form.bounds();
+            for (const AttachedChunk &chunk : chunks)
+                if (!found && chunk.bounds.overlap(box))
+                    overlapIn(*chunk.grid, form, filter, narrow, add);
+        }
+        if (!found)
+            overlapIn(staticBroadPhase, form, filter, narrow, add);
+        return found;
+    }
+
+    /**
+     * Keep in nearest the collider hit first by the ray, if it is nearer than
+     * nearest.distance
+     * @param direction normalized
+     */
+    void raycast(RaycastHit &nearest,
+                 const Vec2<> &origin,
+                 const Vec2<> &direction,
+                 const CollisionFilter &filter,
+                 const PhysicalObject *ignored) const {
+        auto test = [&](auto *target) {
+            if (target == ignored)
+                return nearest.distance;
+            const auto hit =
+                target->form.raycast(origin, direction, nearest.distance);
+            if (hit && (!nearest.object || hit->distance < nearest.distance))
+                nearest = {target,
+                           origin + direction * hit->distance,
+                           hit->normal,
+                           hit->distance};
+            return nearest.distance;
+        };
+        raycastIn(bakedStatics, origin, direction, nearest, filter, test);
+        for (const AttachedChunk &chunk : chunks)
+            if (chunk.bounds.rayEntry(origin, direction, nearest.distance) !=
+                std::numeric_limits<float>::infinity())
+                raycastIn(
+                    *chunk.grid, origin, direction, nearest, filter, test);
+        raycastIn(staticBroadPhase, origin, direction, nearest, filter, test);
+        raycastIn(dynamicBroadPhase, origin, direction, nearest, filter, test);
+    }
+
+    /**
+     * Keep in nearest the collider touched first by form moving along
+     * direction, if it is nearer than nearest.distance. The candidates are
+     * the colliders in the box swept up to nearest.distance.
+     * @param direction normalized
+     */
+    template<class U>
+    void sweep(RaycastHit &nearest,
+               const U &form,
+               const Vec2<> &direction,
+               const CollisionFilter &filter,
+               const PhysicalObject *ignored) const {
+        const SweptBox volume{form.bounds(), direction * nearest.distance};
+        auto test = [&](auto *target) {
+            if (target == ignored ||
+                !filter.accepts(target->collisionFilter))
+                return;
+            const auto hit =
+                form.sweep(direction, nearest.distance, target->form);
+            if (hit && (!nearest.object || hit->distance < nearest.distance))
+                nearest = {target,
+                           form.bounds().center() + direction * hit->distance,
+                           hit->normal,
+                           hit->distance};
+        };
+        bakedStatics.query(volume, test);
+        const Box box = volume.bounds();
+        for (const AttachedChunk &chunk : chunks)
+            if (chunk.bounds.overlap(box))
+                chunk.grid->query(volume, test);
+        staticBroadPhase.query(volume, test);
+        dynamicBroadPhase.query(volume, test);
+    }
+
+    /**
+     * Walk the candidates of a broad phase along a ray, the candidates of the
+     * whole segment if the broad phase has no raycast
+     */
+    template<class BroadPhase, class F>
+    static void raycastIn(const BroadPhase &broadPhase,
+                          const Vec2<> &origin,
+                          const Vec2<> &direction,
+                          const RaycastHit &nearest,
+                          const CollisionFilter &filter,
+                          F &&f) {
+        if constexpr (requires {
+                          broadPhase.raycast(
+                              origin, direction, nearest.distance, filter, f);
+                      })
+            broadPhase.raycast(origin, direction, nearest.distance, filter, f);
+        else {
+            Vec2<> start = origin;
+            Vec2<> end = origin + direction * nearest.distance;
+            broadPhase.query(Line(start, end), [&](auto *collider) {
+                if (filter.accepts(collider->collisionFilter))
+                    f(collider);
+            });
+        }
+    }
+
+    /**
+     * Add to heap the colliders nearer to point than heap.radius
+     */
+    void nearest(NeighbourHeap &heap,
+                 const Vec2<> &point,
+                 const CollisionFilter &filter,
+                 const PhysicalObject *ignored) const {
+        auto test = [&](auto *target) {
+            if (target == ignored)
+                return heap.radius;
+            return heap.add(target, target->form.distance(point));
+        };
+        nearestIn(bakedStatics, point, heap.radius, filter, test);
+        for (const AttachedChunk &chunk : chunks)
+            if (chunk.bounds.distance(point) <= heap.radius)
+                nearestIn(*chunk.grid, point, heap.radius, filter, test);
+        nearestIn(staticBroadPhase, point, heap.radius, filter, test);
+        nearestIn(dynamicBroadPhase, point, heap.radius, filter, test);
+    }
+
+    /**
+     * Walk the candidates of a broad phase from the nearest to point, the
+     * candidates within maxDistance, or all of them, if the broad phase has
+     * no nearest
+     */
+    template<class BroadPhase, class F>
+    static void nearestIn(const BroadPhase &broadPhase,
+                          const Vec2<> &point,
+                          float maxDistance,
+                          const CollisionFilter &filter,
+                          F &&f) {
+        if constexpr (requires {
+                          broadPhase.nearest(point, maxDistance, filter, f);
+                      })
+            broadPhase.nearest(point, maxDistance, filter, f);
+        else {
+            auto accepted = [&](auto *collider) {
+                if (filter.accepts(collider->collisionFilter))
+                    f(collider);
+            };
+            if (maxDistance == std::numeric_limits<float>::infinity())
+                broadPhase.forEach(accepted);
+            else
+                broadPhase.query(Circle(point, maxDistance), accepted);
+        }
+    }
+
+    /**
+     * Narrow phase of the candidates of a broad phase accepted by filter, in
+     * batch if the broad phase can do it
+     */
+    template<class BroadPhase, class U, class Narrow, class F>
+    static QueryCounters overlapIn(const BroadPhase &broadPhase,
+                                   const U &form,
+                                   const CollisionFilter &filter,
+                                   Narrow &&narrow,
+                                   F &&f) {
+        if constexpr (requires { broadPhase.overlap(form, filter, narrow, f); })
+            return broadPhase.overlap(form, filter, narrow, f);
+        else {
+            QueryCounters counters;
+            broadPhase.query(form, [&](auto *collider) {
+                if (!filter.accepts(collider->collisionFilter))
+                    return;
+                counters.tests++;
+                if (narrow(collider))
+                    f(collider);
+            });
+            return counters;
         }
     }
 };
 
-template<class... Types>
-class CollisionDetectorTemplate : public FormDatabase<Types>... {
+/**
+ * Collision detector for the forms Types...
+ * @tparam Policy chooses the broad phase of each kind of collider, see
+ * BroadPhase.hpp
+ */
+template<class Policy, class... Types>
+class BasicCollisionDetector : public FormDatabase<Types, Policy>... {
 private:
+    // The collider being updated stays in the broad phase, testCollision
+    // must not report it. One per thread for the parallel update.
+    inline static thread_local const PhysicalObject *updatingCollider =
+        nullptr;
+
+    std::unique_ptr<ThreadPool> threadPool;
+
+    ContactCache contactCache;
+    ColliderPool colliderPool;
+    std::vector<StaticListener *> staticListeners;
+    // hits of the collider being updated by the serial update
+    std::vector<PhysicalObject *> hitedTargets;
+
+    // updates without moving before a dynamic collider sleeps, 0 to disable
+    uint32_t sleepDelay = 0;
+    // objects left by a collider during the update, woken if they sleep
+    std::vector<PhysicalObject *> leftTargets;
+
+    static constexpr size_t formCount = sizeof...(Types);
+
+    // index of T in Types, formCount if it is not one of them
+    template<class T>
+    static constexpr size_t formIndex() {
+        size_t index = 0;
+        ((std::is_same_v<T, Types> ? false : (index++, true)) && ...);
+        return index;
+    }
+
+    // Counters of the queries of one thread, added to frameCounters at once
+    struct QueryTally {
+        uint64_t queries = 0;
+        uint64_t cells = 0;
+        uint64_t tests = 0;
+        uint64_t hits = 0;
+        uint64_t peakCandidates = 0;
+        std::array<uint64_t, formCount * formCount> testsByPair{};
+        std::array<uint64_t, formCount * formCount> hitsByPair{};
+    };
+
+    // Counters of the queries of the current frame, from any thread
+    struct FrameCounters {
+        std::atomic<uint64_t> queries = 0;
+        std::atomic<uint64_t> cells = 0;
+        std::atomic<uint64_t> tests = 0;
+        std::atomic<uint64_t> hits = 0;
+        std::atomic<uint64_t> peakCandidates = 0;
+        std::array<std::atomic<uint64_t>, formCount * formCount> testsByPair{};
+        std::array<std::atomic<uint64_t>, formCount * formCount> hitsByPair{};
+    };
+    mutable FrameCounters frameCounters;
+    // written by update() on the calling thread
+    std::array<double, formCount> updateTimes{};
+    std::array<uint64_t, formCount> updatedColliders{};
+    // inserts and erases of the broad phases at the start of the frame
+    std::array<uint64_t, formCount> insertsBefore{};
+    std::array<uint64_t, formCount> erasesBefore{};
+    CollisionStatistics lastFrame;
+
+    void countQueries(const QueryTally &tally) const {
+        auto add = [](std::atomic<uint64_t> &counter, uint64_t value) {
+            if (value)
+                counter.fetch_add(value, std::memory_order_relaxed);
+        };
+        add(frameCounters.queries, tally.queries);
+        add(frameCounters.cells, tally.cells);
+        add(frameCounters.tests, tally.tests);
+        add(frameCounters.hits, tally.hits);
+        for (size_t i = 0; i < formCount * formCount; i++) {
+            add(frameCounters.testsByPair[i], tally.testsByPair[i]);
+            add(frameCounters.hitsByPair[i], tally.hitsByPair[i]);
+        }
+        uint64_t peak =
+            frameCounters.peakCandidates.load(std::memory_order_relaxed);
+        while (tally.peakCandidates > peak &&
+               !frameCounters.peakCandidates.compare_exchange_weak(
+                   peak, tally.peakCandidates, std::memory_order_relaxed)) {
+        }
+    }
+
+    template<class T, class U>
+    void overlapOneForm(std::vector<PhysicalObject *> &collidingObjects,
+                        const U &form,
+                        const CollisionFilter &filter,
+                        const PhysicalObject *ignored,
+                        QueryTally &tally) const {
+        const size_t found = collidingObjects.size();
+        const QueryCounters counters = FormDatabase<T, Policy>::overlap(
+            collidingObjects, form, filter, ignored);
+        const uint64_t hits = collidingObjects.size() - found;
+        tally.cells += counters.cells;
+        tally.tests += counters.tests;
+        tally.hits += hits;
+        if constexpr (formIndex<U>() < formCount) {
+            const size_t pair = formIndex<U>() * formCount + formIndex<T>();
+            tally.testsByPair[pair] += counters.tests;
+            tally.hitsByPair[pair] += hits;
+        }
+    }
+
+    /**
+     * Fill collidingObjects with the colliders overlapping form and accepted
+     * by filter, sorted by address without duplicates
+     */
+    template<class T>
+    void collide(std::vector<PhysicalObject *> &collidingObjects,
+                 const T &form,
+                 const CollisionFilter &filter,
+                 const PhysicalObject *ignored,
+                 QueryTally &tally) const {
+        collidingObjects.clear();
+        const uint64_t tests = tally.tests;
+        (overlapOneForm<Types>(
+             collidingObjects, form, filter, ignored, tally),
+         ...);
+        tally.queries++;
+        tally.peakCandidates =
+            std::max(tally.peakCandidates, tally.tests - tests);
+        std::sort(collidingObjects.begin(), collidingObjects.end());
+        collidingObjects.erase(
+            std::unique(collidingObjects.begin(), collidingObjects.end()),
+            collidingObjects.end());
+    }
+
+    // forms that can be swept against every form of the detector
+    template<class T>
+    static constexpr bool sweepable = (CanSweep<T, Types> && ...);
+
+    template<class T>
+    std::optional<RaycastHit> sweep(const T &form,
+                                    const Vec2<> &motion,
+                                    const CollisionFilter &filter,
+                                    const PhysicalObject *ignored) const {
+        const float length = motion.length();
+        if (length == 0)
+            return std::nullopt;
+
+        RaycastHit nearest;
+        nearest.distance = length;
+        (FormDatabase<Types, Policy>::sweep(
+             nearest, form, motion / length, filter, ignored),
+         ...);
+        if (!nearest.object)
+            return std::nullopt;
+        return nearest;
+    }
+
+    /**
+     * Sweep a continuous collider to nextForm, its first hit is added to
+     * hitedTargets, sorted by address
+     */
+    template<class T>
+    void sweepOneForm(DynamicCollider<T> *dynamicCollider,
+                      const T &nextForm,
+                      std::vector<PhysicalObject *> &hitedTargets) const {
+        if constexpr (sweepable<T>) {
+            if (!dynamicCollider->continuous)
+                return;
+            const Vec2<> motion = nextForm.bounds().center() -
+                                  dynamicCollider->form.bounds().center();
+            auto &firstHit = dynamicCollider->firstHit;
+            firstHit = sweep(dynamicCollider->form,
+                             motion,
+                             dynamicCollider->collisionFilter,
+                             dynamicCollider);
+            if (!firstHit)
+                return;
+            auto it = std::lower_bound(
+                hitedTargets.begin(), hitedTargets.end(), firstHit->object);
+            if (it == hitedTargets.end() || *it != firstHit->object)
+                hitedTargets.insert(it, firstHit->object);
+        }
+    }
+
     template<class T>
-    void updateOneForm(DynamicCollider<T> *dynamicCollider, float timeFlow) {
+    void commitOneForm(DynamicCollider<T> *dynamicCollider,
+                       const T &nextForm,
+                       std::span<PhysicalObject *const> hitedTargets,
+                       float timeFlow,
+                       bool ghost) {
+        updatingCollider = dynamicCollider;
+
+        // 2: send the hit events
+        bool contactsChanged = false;
+        contactCache.replace(
+            dynamicCollider->contacts,
+            hitedTargets,
+            [&](PhysicalObject *target) {
+                contactsChanged = true;
+                dynamicCollider->hitStart(target);
+            },
+            [&](PhysicalObject *target) {
+                contactsChanged = true;
+                if (sleepDelay && !ghost)
+                    leftTargets.push_back(target);
+                dynamicCollider->hitEnd(target);
+            });
+        // disabled by its own events
+        if (!dynamicCollider->enable) {
+            updatingCollider = nullptr;
+            return;
+        }
+
+        // 3: tell set the new position of the collider
+        T form = dynamicCollider->postCollisionUpdate(dynamicCollider->form,
+                                                      nextForm,
+                                                      timeFlow);
+        if (sleepDelay && !ghost) {
+            const bool resting = !contactsChanged &&
+                                 nextForm == dynamicCollider->form &&
+                                 form == dynamicCollider->form;
+            restOneForm(dynamicCollider, resting);
+        }
+        dynamicCollider->form = form;
+        updatingCollider = nullptr;
+    }
+
+    // Count the updates a dynamic collider rests, it sleeps after sleepDelay
+    // of them. The colliders that did not rest wake what they touch in
+    // settle().
+    template<class T>
+    void restOneForm(DynamicCollider<T> *dynamicCollider, bool resting) {
+        if (!resting) {
+            dynamicCollider->restingFrames = 0;
+            FormDatabase<T, Policy>::movers.push_back(dynamicCollider);
+        } else if (++dynamicCollider->restingFrames >= sleepDelay &&
+                   dynamicCollider->sleepState ==
+                       PhysicalObject::SleepState::Awake) {
+            dynamicCollider->sleepState = PhysicalObject::SleepState::Drowsy;
+            FormDatabase<T, Policy>::pendingSleeps.push_back(dynamicCollider);
+        }
+    }
+
+    void wakeObject(PhysicalObject *object) {
+        if (object->sleepState != PhysicalObject::SleepState::Awake)
+            (FormDatabase<Types, Policy>::wakeObject(object) || ...);
+    }
+
+    template<class T>
+    void wakeTouched() {
+        for (DynamicCollider<T> *mover : FormDatabase<T, Policy>::movers)
+            for (PhysicalObject *target : mover->contacts.targets())
+                wakeObject(target);
+    }
+
+    // After an update: the colliders touched or left by a moving collider
+    // wake up, the others resting for sleepDelay updates fall asleep
+    void settle() {
+        (wakeTouched<Types>(), ...);
+        for (PhysicalObject *target : leftTargets)
+            wakeObject(target);
+        leftTargets.clear();
+        (FormDatabase<Types, Policy>::settle(), ...);
+    }
+
+    template<class T>
+    void updateOneForm(DynamicCollider<T> *dynamicCollider,
+                       float timeFlow,
+                       bool ghost,
+                       QueryTally &tally) {
+        updatingCollider = dynamicCollider;
+
         // 1: get the nex position of the collider
         auto nextForm =
             dynamicCollider->preCollisionUpdate(dynamicCollider->form,
                                                 timeFlow);
+        if (!dynamicCollider->enable) {
+            updatingCollider = nullptr;
+            return;
+        }
 
-        std::unordered_set<PhysicalObject *> hitedTargets =
-            testCollision(nextForm);
+        collide(hitedTargets,
+                nextForm,
+                dynamicCollider->collisionFilter,
+                dynamicCollider,
+                tally);
+        sweepOneForm(dynamicCollider, nextForm, hitedTargets);
 
-        for (PhysicalObject *physicalObjects : hitedTargets) {
-            if (dynamicCollider->hitting.erase(physicalObjects) == 0)
-                dynamicCollider->hitStart(physicalObjects);
+        commitOneForm(
+            dynamicCollider, nextForm, hitedTargets, timeFlow, ghost);
+    }
+
+    template<class T>
+    void updateOneFormDatabase(float timeFlow) {
+        QueryTally tally;
+        // The events may enable or disable colliders: the ones enabled are
+        // appended and updated from the next frame, the ones disabled leave a
+        // null entry
+        const auto &dynamicColliders =
+            FormDatabase<T, Policy>::dynamicColliders;
+        const size_t dynamicCount = dynamicColliders.size();
+        for (size_t i = 0; i < dynamicCount; i++) {
+            DynamicCollider<T> *dynamicCollider = dynamicColliders[i];
+            if (!dynamicCollider)
+                continue;
+            updateOneForm(dynamicCollider, timeFlow, false, tally);
+            if (dynamicCollider->enable)
+                FormDatabase<T, Policy>::moveCollision(*dynamicCollider);
         }
-        for (PhysicalObject *physicalObjects : dynamicCollider->hitting) {
-            dynamicCollider->hitEnd(physicalObjects);
+        const auto &ghostColliders = FormDatabase<T, Policy>::ghostColliders;
+        const size_t ghostCount = ghostColliders.size();
+        for (size_t i = 0; i < ghostCount; i++)
+            if (DynamicCollider<T> *ghostCollider = ghostColliders[i])
+                updateOneForm(ghostCollider, timeFlow, true, tally);
+        countQueries(tally);
+    }
+
+    // Parallel update, phase one: compute the next forms and the hits against
+    // the broad phases left untouched
+    template<class T, class PendingUpdate>
+    void prepareUpdates(const std::vector<DynamicCollider<T> *> &colliders,
+                        std::vector<PendingUpdate> &pendingUpdates,
+                        float timeFlow) {
+        pendingUpdates.resize(colliders.size());
+        threadPool->parallelFor(colliders.size(), [&](size_t begin, size_t end) {
+            QueryTally tally;
+            for (size_t i = begin; i < end; i++) {
+                DynamicCollider<T> *dynamicCollider = colliders[i];
+                updatingCollider = dynamicCollider;
+                auto &pending = pendingUpdates[i];
+                pending.nextForm.emplace(
+                    dynamicCollider->preCollisionUpdate(dynamicCollider->form,
+                                                        timeFlow));
+                collide(pending.hitedTargets,
+                        *pending.nextForm,
+                        dynamicCollider->collisionFilter,
+                        dynamicCollider,
+                        tally);
+                sweepOneForm(
+                    dynamicCollider, *pending.nextForm, pending.hitedTargets);
+            }
+            updatingCollider = nullptr;
+            countQueries(tally);
+        });
+    }
+
+    template<class T>
+    void prepareOneFormDatabase(float timeFlow) {
+        prepareUpdates(FormDatabase<T, Policy>::dynamicColliders,
+                       FormDatabase<T, Policy>::pendingDynamics,
+                       timeFlow);
+        prepareUpdates(FormDatabase<T, Policy>::ghostColliders,
+                       FormDatabase<T, Policy>::pendingGhosts,
+                       timeFlow);
+    }
+
+    // Parallel update, phase two: events and new positions, in the collider
+    // order, on the calling thread
+    template<class T>
+    void commitOneFormDatabase(float timeFlow) {
+        // the colliders prepared, see updateOneFormDatabase for the ones
+        // enabled or disabled by the events
+        const auto &dynamicColliders =
+            FormDatabase<T, Policy>::dynamicColliders;
+        const auto &pendingDynamics = FormDatabase<T, Policy>::pendingDynamics;
+        for (size_t i = 0; i < pendingDynamics.size(); i++) {
+            DynamicCollider<T> *dynamicCollider = dynamicColliders[i];
+            if (!dynamicCollider)
+                continue;
+            commitOneForm(dynamicCollider,
+                          *pendingDynamics[i].nextForm,
+                          pendingDynamics[i].hitedTargets,
+                          timeFlow,
+                          false);
+            if (dynamicCollider->enable)
+                FormDatabase<T, Policy>::moveCollision(*dynamicCollider);
         }
-        dynamicCollider->hitting = std::move(hitedTargets);
+        const auto &ghostColliders = FormDatabase<T, Policy>::ghostColliders;
+        const auto &pendingGhosts = FormDatabase<T, Policy>::pendingGhosts;
+        for (size_t i = 0; i < pendingGhosts.size(); i++)
+            if (DynamicCollider<T> *ghostCollider = ghostColliders[i])
+                commitOneForm(ghostCollider,
+                              *pendingGhosts[i].nextForm,
+                              pendingGhosts[i].hitedTargets,
+                              timeFlow,
+                              true);
+    }
 
-        // 3: tell set the new position of the collider
-        dynamicCollider->form =
-            dynamicCollider->postCollisionUpdate(dynamicCollider->form,
-                                                 nextForm,
-                                                 timeFlow);
+    // Run f, a step of the update of the colliders of form T, and add its
+    // time to the frame
+    template<class T, class F>
+    void measure(F &&f) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        updateTimes[formIndex<T>()] += std::chrono::duration<double>(
+                                           std::chrono::steady_clock::now() -
+                                           start)
+                                           .count();
     }
 
     template<class T>
-    void updateOneFormDatabase(float timeFlow) {
-        for (auto dynamicCollider : FormDatabase<T>::dynamicColliders) {
-            // Remove the collider from the dynamicSpacialHash so he cannot find
-            // himself
-            for (const auto &position : dynamicCollider->form.rasterize())
-                if (FormDatabase<T>::dynamicSpacialHash[position].erase(
-                        dynamicCollider) == 0)
-                    throw Exception(
-                        std::string("erase ") + typeid(dynamicCollider).name() +
-                        " in dynamic Spacial Hash but element does not exist");
-
-            updateOneForm(dynamicCollider, timeFlow);
-
-            // set back the new position in the dynamicSpacialHash
-            for (const auto &position : dynamicCollider->form.rasterize())
-                if (!FormDatabase<T>::dynamicSpacialHash[position]
-                         .insert(dynamicCollider)
-                         .second)
-                    throw Exception(
-                        std::string("insert ") +
-                        typeid(dynamicCollider).name() +
-                        " in dynamic Spacial Hash but element already exist");
-        }
-        for (auto ghostCollider : FormDatabase<T>::ghostColliders)
-            updateOneForm(ghostCollider, timeFlow);
+    void countUpdated() {
+        updatedColliders[formIndex<T>()] =
+            FormDatabase<T, Policy>::dynamicColliders.size() +
+            FormDatabase<T, Policy>::ghostColliders.size();
+    }
+
+    template<class BroadPhase>
+    static void countEdits(const BroadPhase &broadPhase,
+                           uint64_t &inserts,
+                           uint64_t &erases) {
+        if constexpr (requires { broadPhase.statistics().inserts; }) {
+            const auto statistics = broadPhase.statistics();
+            inserts += statistics.inserts;
+            erases += statistics.erases;
+        }
+    }
+
+    template<class T>
+    void finishFormStatistics() {
+        const size_t index = formIndex<T>();
+        uint64_t inserts = 0;
+        uint64_t erases = 0;
+        countEdits(FormDatabase<T, Policy>::staticBroadPhase, inserts, erases);
+        countEdits(FormDatabase<T, Policy>::dynamicBroadPhase, inserts, erases);
+
+        CollisionStatistics::Form &form = lastFrame.forms[index];
+        form.updateTime = std::exchange(updateTimes[index], 0.);
+        form.updated = std::exchange(updatedColliders[index], 0);
+        form.inserts = inserts - std::exchange(insertsBefore[index], inserts);
+        form.erases = erases - std::exchange(erasesBefore[index], erases);
+    }
+
+    // Move the counters of the frame to lastFrame and start the next frame
+    void finishFrameStatistics() {
+        (finishFormStatistics<Types>(), ...);
+        auto take = [](std::atomic<uint64_t> &counter) {
+            return counter.exchange(0, std::memory_order_relaxed);
+        };
+        lastFrame.queries = take(frameCounters.queries);
+        lastFrame.cells = take(frameCounters.cells);
+        lastFrame.tests = take(frameCounters.tests);
+        lastFrame.hits = take(frameCounters.hits);
+        lastFrame.peakCandidates = take(frameCounters.peakCandidates);
+        for (size_t i = 0; i < formCount * formCount; i++) {
+            lastFrame.testsByPair[i] = take(frameCounters.testsByPair[i]);
+            lastFrame.hitsByPair[i] = take(frameCounters.hitsByPair[i]);
+        }
     }
 
 public:
-    using FormDatabase<Types>::enableCollision...;
-    using FormDatabase<Types>::enableGhostCollision...;
+    /**
+     * State of the dynamic and ghost colliders saved by snapshot(). The
+     * buffers are kept from one snapshot to the next, keep one per frame of
+     * rollback.
+     */
+    class Snapshot {
+        friend class BasicCollisionDetector;
+
+    private:
+        std::tuple<typename FormDatabase<Types, Policy>::Snapshot...> forms;
+        ContactCache::Snapshot contacts;
+    };
+
+    BasicCollisionDetector() {
+        ((FormDatabase<Types, Policy>::contactCache = &contactCache), ...);
+        ((FormDatabase<Types, Policy>::colliderPool = &colliderPool), ...);
+        ((FormDatabase<Types, Policy>::staticListeners = &staticListeners),
+         ...);
+        (lastFrame.forms.push_back({typeid(Types).name()}), ...);
+        lastFrame.testsByPair.resize(formCount * formCount);
+        lastFrame.hitsByPair.resize(formCount * formCount);
+    }
+
+    BasicCollisionDetector(const BasicCollisionDetector &) = delete;
+
+    BasicCollisionDetector(BasicCollisionDetector &&) = delete;
+
+    using FormDatabase<Types, Policy>::enableCollision...;
+    using FormDatabase<Types, Policy>::enableGhostCollision...;
 
-    using FormDatabase<Types>::disableCollision...;
-    using FormDatabase<Types>::disableGhostCollision...;
+    using FormDatabase<Types, Policy>::disableCollision...;
+    using FormDatabase<Types, Policy>::disableGhostCollision...;
+
+    using FormDatabase<Types, Policy>::wakeUp...;
+
+    /**
+     * Add the static colliders of a chunk to the queries, in constant time.
+     * The chunk must be baked, and stay alive and unchanged until
+     * detachChunk. See BasicCollisionChunk and BasicChunkStreamer.
+     */
+    template<class Chunk>
+    void attachChunk(const Chunk &chunk) {
+        (FormDatabase<Types, Policy>::attachChunk(
+             chunk.template grid<Types>(), chunk.template bounds<Types>()),
+         ...);
+    }
+
+    /**
+     * Remove the static colliders of a chunk from the queries. The contacts
+     * with them end before the chunk can be destroyed: hitEnd is called for
+     * each, also for the disabled colliders that keep their contacts.
+     */
+    template<class Chunk>
+    void detachChunk(const Chunk &chunk) {
+        (FormDatabase<Types, Policy>::detachChunk(chunk.template grid<Types>()),
+         ...);
+
+        std::vector<PhysicalObject *> removed;
+        (chunk.template grid<Types>().forEach(
+             [&](StaticCollider<Types> *collider) {
+                 removed.push_back(collider);
+             }),
+         ...);
+        std::sort(removed.begin(), removed.end());
+        std::vector<ContactCache::Contact> ended;
+        contactCache.removeTargets(removed, ended);
+        // once the cache no longer holds them, the events may change it
+        for (const auto &[owner, target] : ended)
+            (FormDatabase<Types, Policy>::endContact(owner, target) || ...);
+    }
+
+    /**
+     * Enable many static colliders at once, for instance when loading a
+     * level. They go in a read-only grid built in one pass, on the threads of
+     * setParallelUpdate if enabled, instead of the static broad phase. A baked
+     * collider can be disabled, a collider added later is rebuilt with the
+     * others, so bake in large batches.
+     * @param colliders range of colliders or of pointers to colliders, all
+     * with the same form
+     */
+    template<std::ranges::range R>
+    void bakeStatic(R &&colliders) {
+        using Collider = std::remove_pointer_t<
+            std::remove_cvref_t<std::ranges::range_reference_t<R>>>;
+        using T = std::remove_cv_t<decltype(Collider::form)>;
+        FormDatabase<T, Policy>::bakeStatic(colliders, threadPool.get());
+    }
+
+    /**
+     * @return the enabled collider of a handle, see PhysicalObject::getHandle,
+     * nullptr if the collider was disabled since
+     */
+    PhysicalObject *find(ColliderHandle handle) const {
+        return colliderPool[handle];
+    }
+
+    /**
+     * @return the enabled collider of a handle if it is a Collider, nullptr
+     * otherwise
+     */
+    template<class Collider>
+    Collider *find(ColliderHandle handle) const {
+        return dynamic_cast<Collider *>(colliderPool[handle]);
+    }
+
+    /**
+     * Tell listener about the changes of the static colliders, until
+     * removeStaticListener. The listener must outlive the detector or be
+     * removed before it is destroyed.
+     */
+    void addStaticListener(StaticListener &listener) {
+        staticListeners.push_back(&listener);
+    }
+
+    void removeStaticListener(StaticListener &listener) {
+        std::erase(staticListeners, &listener);
+    }
 
     template<class T>
     std::unordered_set<PhysicalObject *> testCollision(const T &form) const {
-        auto rasters = form.rasterize();
-        std::unordered_set<PhysicalObject *> collidingObjects;
-        (FormDatabase<Types>::template overlap<T>(collidingObjects,
-                                                  form,
-                                                  rasters),
+        return testCollision(form, CollisionFilter::all());
+    }
+
+    /**
+     * @return the colliders overlapping form whose layers are accepted by
+     * filter
+     */
+    template<class T>
+    std::unordered_set<PhysicalObject *>
+    testCollision(const T &form, const CollisionFilter &filter) const {
+        std::vector<PhysicalObject *> collidingObjects;
+        QueryTally tally;
+        collide(collidingObjects, form, filter, updatingCollider, tally);
+        countQueries(tally);
+        return {collidingObjects.begin(), collidingObjects.end()};
+    }
+
+    /**
+     * @return true if a static collider accepted by filter overlaps form,
+     * without the dynamic colliders. It stops at the first one found and can
+     * run on several threads while the colliders do not change.
+     */
+    template<class T>
+    bool testStaticCollision(
+        const T &form,
+        const CollisionFilter &filter = CollisionFilter::all()) const {
+        return (FormDatabase<Types, Policy>::overlapStatic(form, filter) ||
+                ...);
+    }
+
+    /**
+     * testCollision of many forms at once, for sensors and area effects, on
+     * the threads of setParallelUpdate if enabled, on the calling thread from
+     * the callbacks of an update. The results are written in flat buffers
+     * reused from one call to the next.
+     * @param forms random access range of forms, all of the same type
+     * @param results replaced by the colliders overlapping each form
+     */
+    template<std::ranges::random_access_range R>
+    void testCollisions(
+        const R &forms,
+        CollisionQueryResults &results,
+        const CollisionFilter &filter = CollisionFilter::all()) const {
+        const size_t count = std::ranges::size(forms);
+        if (results.found.size() < count)
+            results.found.resize(count);
+        // the one of the calling thread, the workers have their own
+        const PhysicalObject *ignored = updatingCollider;
+        auto query = [&](size_t begin, size_t end) {
+            QueryTally tally;
+            for (size_t i = begin; i < end; i++)
+                collide(results.found[i],
+                        std::ranges::begin(forms)[i],
+                        filter,
+                        ignored,
+                        tally);
+            countQueries(tally);
+        };
+        // from the callbacks of an update, where the pool may be running it
+        if (threadPool && count > 1 && !ignored)
+            // a single capture keeps the std::function from allocating
+            threadPool->parallelFor(count,
+                                    [&query](size_t begin, size_t end) {
+                                        query(begin, end);
+                                    });
+        else
+            query(0, count);
+
+        results.offsets.resize(count + 1);
+        results.offsets[0] = 0;
+        for (size_t i = 0; i < count; i++)
+            results.offsets[i + 1] =
+                results.offsets[i] + (uint32_t) results.found[i].size();
+        results.hits.resize(results.offsets.back());
+        for (size_t i = 0; i < count; i++) {
+            CollisionQueryResults::Hit *hit =
+                results.hits.data() + results.offsets[i];
+            for (PhysicalObject *object : results.found[i])
+                *hit++ = {(uint32_t) i, object};
+        }
+    }
+
+    /**
+     * Find the k colliders nearest to a point, for instance for steering. The
+     * grids are walked ring after ring of cells from the point, until k
+     * colliders are found nearer than the next ring. The collider being
+     * updated is ignored like in testCollision.
+     * @param neighbours replaced by at most k colliders, the nearest first,
+     * kept from one call to the next to not allocate
+     * @param maxDistance to the form of the colliders, 0 inside it
+     */
+    void nearest(const Vec2<> &point,
+                 size_t k,
+                 std::vector<Neighbour> &neighbours,
+                 float maxDistance = std::numeric_limits<float>::infinity(),
+                 const CollisionFilter &filter = CollisionFilter::all()) const {
+        NeighbourHeap heap{neighbours, k, maxDistance};
+        (FormDatabase<Types, Policy>::nearest(
+             heap, point, filter, updatingCollider),
          ...);
-        return collidingObjects;
+        heap.finish();
+    }
+
+    /**
+     * Find every collider within radius of a point, the nearest first, see
+     * nearest
+     */
+    void withinRadius(
+        const Vec2<> &point,
+        float radius,
+        std::vector<Neighbour> &neighbours,
+        const CollisionFilter &filter = CollisionFilter::all()) const {
+        NeighbourHeap heap{
+            neighbours, std::numeric_limits<size_t>::max(), radius};
+        (FormDatabase<Types, Policy>::nearest(
+             heap, point, filter, updatingCollider),
+         ...);
+        heap.finish();
+    }
+
+    /**
+     * Find the first collider hit by a ray, only looking at the cells or boxes
+     * the ray goes through. The collider being updated is ignored like in
+     * testCollision.
+     * @param direction does not need to be normalized
+     */
+    std::optional<RaycastHit>
+    raycast(const Vec2<> &origin,
+            const Vec2<> &direction,
+            float maxDistance,
+            const CollisionFilter &filter = CollisionFilter::all()) const {
+        const float length = direction.length();
+        if (length == 0)
+            return std::nullopt;
+
+        RaycastHit nearest;
+        nearest.distance = maxDistance;
+        (FormDatabase<Types, Policy>::raycast(nearest,
+                                              origin,
+                                              direction / length,
+                                              filter,
+                                              updatingCollider),
+         ...);
+        if (!nearest.object)
+            return std::nullopt;
+        return nearest;
+    }
+
+    /**
+     * Find the first collider hit on the segment from a to b, for line of
+     * sight checks
+     */
+    std::optional<RaycastHit>
+    segmentCast(const Vec2<> &a,
+                const Vec2<> &b,
+                const CollisionFilter &filter = CollisionFilter::all()) const {
+        return raycast(a, b - a, (b - a).length(), filter);
+    }
+
+    /**
+     * Find the first collider touched by a point, a circle or a rectangle
+     * moving in a straight line, testing the box it sweeps once. The collider
+     * being updated is ignored like in testCollision.
+     * @param motion from the current position of form to its destination
+     * @return the collider, the normal of its border facing form and the
+     * position of the center of form when they touch, at distance 0 if they
+     * overlap already
+     */
+    template<class T>
+        requires sweepable<T>
+    std::optional<RaycastHit>
+    sweep(const T &form,
+          const Vec2<> &motion,
+          const CollisionFilter &filter = CollisionFilter::all()) const {
+        return sweep(form, motion, filter, updatingCollider);
+    }
+
+    /**
+     * Sweep a dynamic collider from its form to the form preCollisionUpdate
+     * returns, in addition to testing the new form: it hits the first
+     * collider on the way even when it goes through it in one update, see
+     * DynamicCollider::sweepHit. For fast colliders, instead of updating
+     * several times per frame.
+     */
+    template<class T>
+        requires sweepable<T>
+    void setContinuous(DynamicCollider<T> &collider, bool continuous) {
+        collider.continuous = continuous;
+        collider.firstHit.reset();
     }
 
     void update(float timeFlow) {
-        (updateOneFormDatabase<Types>(timeFlow), ...);
+        (countUpdated<Types>(), ...);
+        contactCache.beginFrame();
+        if (threadPool) {
+            (measure<Types>([&] { prepareOneFormDatabase<Types>(timeFlow); }),
+             ...);
+            (measure<Types>([&] { commitOneFormDatabase<Types>(timeFlow); }),
+             ...);
+        } else
+            (measure<Types>([&] { updateOneFormDatabase<Types>(timeFlow); }),
+             ...);
+        contactCache.endFrame();
+        (FormDatabase<Types, Policy>::compact(), ...);
+        (FormDatabase<Types, Policy>::sweepPairs(), ...);
+        settle();
+        finishFrameStatistics();
+    }
+
+    /**
+     * Counters of the last frame, to size the grids and follow the cost of
+     * the collisions in captures. They are collected all the time, with a few
+     * relaxed atomic additions per thread and per batch of queries.
+     * @return the statistics of the frame ended by the last update()
+     */
+    const CollisionStatistics &statistics() const { return lastFrame; }
+
+    /**
+     * Save the forms, the sleep state and the contacts of the dynamic and
+     * ghost colliders, between two updates, for rollback. The static
+     * colliders and the chunks are not saved.
+     */
+    void snapshot(Snapshot &snapshot) const {
+        (FormDatabase<Types, Policy>::snapshot(
+             std::get<typename FormDatabase<Types, Policy>::Snapshot>(
+                 snapshot.forms)),
+         ...);
+        contactCache.snapshot(snapshot.contacts);
+    }
+
+    /**
+     * Go back to the state of a snapshot, without calling the hit or sleep
+     * events, so the next update() sends the events of the frame after the
+     * snapshot again. The dynamic and ghost colliders must be the ones of the
+     * snapshot: enabling or disabling one in between throws.
+     */
+    void restore(const Snapshot &snapshot) {
+        if (contactCache.isUpdating())
+            throw Exception("Collision world restored during an update");
+        (FormDatabase<Types, Policy>::checkSnapshot(
+             std::get<typename FormDatabase<Types, Policy>::Snapshot>(
+                 snapshot.forms)),
+         ...);
+        (FormDatabase<Types, Policy>::restore(
+             std::get<typename FormDatabase<Types, Policy>::Snapshot>(
+                 snapshot.forms)),
+         ...);
+        contactCache.restore(snapshot.contacts);
+    }
+
+    /**
+     * Let the dynamic colliders sleep once their form and contacts did not
+     * change for delay updates. A sleeping collider is not updated, it wakes
+     * up when a moving dynamic collider touches it or leaves it. A change of
+     * the static colliders does not wake it, call wakeUp.
+     * @param delay number of updates, 0 to never sleep
+     */
+    void setSleepDelay(uint32_t delay) {
+        sleepDelay = delay;
+        if (!delay)
+            (FormDatabase<Types, Policy>::wakeAll(), ...);
+    }
+
+    /**
+     * Call f(collider, target) for every dynamic or ghost collider and every
+     * object it hits
+     */
+    template<class F>
+    void forEachContact(F &&f) const {
+        contactCache.forEach(f);
+    }
+
+    /**
+     * Call f(a, b) once for every pair of dynamic colliders of the same form
+     * whose forms overlap and whose filters accept each other, sleeping ones
+     * included. With SweepAndPrunePolicy the pairs come from the sweep run
+     * at the end of update(), until a dynamic collider is enabled, disabled
+     * or restored; the other policies query their broad phase per collider.
+     */
+    template<class F>
+    void forEachDynamicPair(F &&f) const {
+        (FormDatabase<Types, Policy>::forEachDynamicPair(
+             [&](PhysicalObject *a, PhysicalObject *b) { f(a, b); }),
+         ...);
+    }
+
+    /**
+     * Run update() on several threads. Every preCollisionUpdate and every
+     * collision test is computed in parallel against the positions of the
+     * previous frame, then the hit events, postCollisionUpdate and the new
+     * positions are applied on the calling thread in the order of the serial
+     * update. The result does not depend on the number of threads.
+     * @param threadCount number of threads including the caller of update, 0
+     * or 1 to go back to the serial update
+     */
+    void setParallelUpdate(unsigned threadCount) {
+        if (threadCount > 1)
+            threadPool = std::make_unique<ThreadPool>(threadCount);
+        else
+            threadPool.reset();
+    }
+
+    /**
+     * @return the broad phase of the static colliders of form T, to configure
+     * it or read its statistics
+     */
+    template<class T>
+    auto &getStaticBroadPhase() {
+        return FormDatabase<T, Policy>::staticBroadPhase;
+    }
+
+    template<class T>
+    const auto &getStaticBroadPhase() const {
+        return FormDatabase<T, Policy>::staticBroadPhase;
+    }
+
+    /**
+     * @return the broad phase of the dynamic colliders of form T, to configure
+     * it or read its statistics
+     */
+    template<class T>
+    auto &getDynamicBroadPhase() {
+        return FormDatabase<T, Policy>::dynamicBroadPhase;
+    }
+
+    template<class T>
+    const auto &getDynamicBroadPhase() const {
+        return FormDatabase<T, Policy>::dynamicBroadPhase;
     }
 
 #ifdef BLOB_COLLISION_IMGUI
@@ -283,36 +1986,40 @@ public:
     Vec2<int32_t> scanPos;
     Circle testCircle;
 
+    template<class Collider>
+    void printCollider(const Collider *collider) {
+        ImGui::TableNextColumn();
+        ImGui::Text("%llu", collider);
+        ImGui::TableNextColumn();
+        std::stringstream ss;
+        ss << collider->form;
+        ImGui::Text("%s", ss.str().c_str());
+    }
+
     template<class T>
     void printSingleDynamicDatabse() {
-        for (auto dynamicCollider : FormDatabase<T>::dynamicColliders) {
-            ImGui::TableNextColumn();
-            ImGui::Text("%llu", dynamicCollider);
-            ImGui::TableNextColumn();
-            std::stringstream ss;
-            ss << dynamicCollider->form;
-            ImGui::Text("%s", ss.str().c_str());
-        }
+        for (auto dynamicCollider : FormDatabase<T, Policy>::dynamicColliders)
+            printCollider(dynamicCollider);
+        for (auto dynamicCollider : FormDatabase<T, Policy>::sleepingColliders)
+            printCollider(dynamicCollider);
     }
 
     template<class T>
     void printSingleSpacialHash(const Vec2<int32_t> &scanPos) {
-        for (auto colliders : FormDatabase<T>::staticSpacialHash[scanPos]) {
-            ImGui::TableNextColumn();
-            ImGui::Text("%llu", colliders);
-            ImGui::TableNextColumn();
-            std::stringstream ss;
-            ss << colliders->form;
-            ImGui::Text("%s", ss.str().c_str());
-        }
-        for (auto colliders : FormDatabase<T>::dynamicSpacialHash[scanPos]) {
-            ImGui::TableNextColumn();
-            ImGui::Text("%llu", colliders);
-            ImGui::TableNextColumn();
-            std::stringstream ss;
-            ss << colliders->form;
-            ImGui::Text("%s", ss.str().c_str());
-        }
+        const RasterArea scan(std::unordered_set<Vec2<int32_t>>{scanPos});
+        FormDatabase<T, Policy>::bakedStatics.query(
+            scan,
+            [&](const StaticCollider<T> *c) { printCollider(c); });
+        for (const auto &chunk : FormDatabase<T, Policy>::chunks)
+            chunk.grid->query(
+                scan,
+                [&](const StaticCollider<T> *c) { printCollider(c); });
+        FormDatabase<T, Policy>::staticBroadPhase.query(
+            scan,
+            [&](const StaticCollider<T> *c) { printCollider(c); });
+        FormDatabase<T, Policy>::dynamicBroadPhase.query(
+            scan,
+            [&](const DynamicCollider<T> *c) { printCollider(c); });
     }
 
     constexpr static float zoomIn = 20;
@@ -332,34 +2039,140 @@ public:
 
     void draw(const Line &c, ImDrawList *draw_list, Vec2<> offset) {}
 
-    template<class T>
-    void drawSpacialHash(ImDrawList *draw_list, Vec2<> offset) {
-        for (const auto &[pos, colliders] :
-             FormDatabase<T>::staticSpacialHash) {
-            if (!colliders.empty())
+    void draw(const Polygon &c, ImDrawList *draw_list, Vec2<> offset) {
+        for (size_t i = 0; i < c.size(); i++)
+            draw_list->AddLine(offset + c.vertex(i) * zoomIn,
+                               offset + c.vertex(c.next(i)) * zoomIn,
+                               ImColor(ImVec4(1.0f, 1.0f, 0.4f, 1.0f)));
+    }
+
+    template<class BroadPhase>
+    void drawBroadPhase(const BroadPhase &broadPhase,
+                        ImDrawList *draw_list,
+                        Vec2<> offset,
+                        ImColor color) {
+        if constexpr (requires { broadPhase.forEachCell([](auto, auto) {}); })
+            broadPhase.forEachCell([&](const Vec2<int32_t> &pos, auto) {
                 draw_list->AddRect(
                     offset + pos.template cast<float>() * zoomIn,
                     offset + pos.template cast<float>() * zoomIn + zoomIn,
-                    ImColor(ImVec4(0.8f, 0.8f, 0.4f, 1.0f)),
+                    color,
                     0.0f,
                     ImDrawFlags_None,
                     1.f);
-            for (const auto &c : colliders)
-                draw(c->form, draw_list, offset);
+            });
+        if constexpr (requires { broadPhase.forEachBox([](auto) {}); })
+            broadPhase.forEachBox([&](const Box &box) {
+                draw_list->AddRect(offset + box.min * zoomIn,
+                                   offset + box.max * zoomIn,
+                                   color,
+                                   0.0f,
+                                   ImDrawFlags_None,
+                                   1.f);
+            });
+        broadPhase.forEach(
+            [&](const auto *c) { draw(c->form, draw_list, offset); });
+    }
+
+    template<class T>
+    void drawSpacialHash(ImDrawList *draw_list, Vec2<> offset) {
+        drawBroadPhase(FormDatabase<T, Policy>::bakedStatics,
+                       draw_list,
+                       offset,
+                       ImColor(ImVec4(0.6f, 0.6f, 0.6f, 1.0f)));
+        for (const auto &chunk : FormDatabase<T, Policy>::chunks)
+            drawBroadPhase(*chunk.grid,
+                           draw_list,
+                           offset,
+                           ImColor(ImVec4(0.6f, 0.6f, 0.6f, 1.0f)));
+        drawBroadPhase(FormDatabase<T, Policy>::staticBroadPhase,
+                       draw_list,
+                       offset,
+                       ImColor(ImVec4(0.8f, 0.8f, 0.4f, 1.0f)));
+        drawBroadPhase(FormDatabase<T, Policy>::dynamicBroadPhase,
+                       draw_list,
+                       offset,
+                       ImColor(ImVec4(0.0f, 1.0f, 0.4f, 1.0f)));
+    }
+
+    template<class BroadPhase>
+    void printStatistics(const char *name, const BroadPhase &broadPhase) {
+        if constexpr (requires { broadPhase.statistics().levels; }) {
+            const auto statistics = broadPhase.statistics();
+            ImGui::Text("%s: %.1f candidates per query",
+                        name,
+                        statistics.averageCandidates());
+            for (const auto &level : statistics.levels)
+                ImGui::Text("  cell %.2f: %zu colliders, %zu cells, %.2f per "
+                            "cell",
+                            level.cellSize,
+                            level.colliders,
+                            level.cells,
+                            level.occupancy());
+        } else if constexpr (requires { broadPhase.statistics(); }) {
+            const auto statistics = broadPhase.statistics();
+            ImGui::Text("%s: %zu cells, %.2f per cell",
+                        name,
+                        statistics.cells,
+                        statistics.occupancy());
         }
-        for (const auto &[pos, colliders] :
-             FormDatabase<T>::dynamicSpacialHash) {
-            if (!colliders.empty())
-                draw_list->AddRect(
-                    offset + pos.template cast<float>() * zoomIn,
-                    offset + pos.template cast<float>() * zoomIn + zoomIn,
-                    ImColor(ImVec4(0.0f, 1.0f, 0.4f, 1.0f)),
-                    0.0f,
-                    ImDrawFlags_None,
-                    1.f);
-            for (const auto &c : colliders)
-                draw(c->form, draw_list, offset);
+    }
+
+    template<class T>
+    void printSingleStatistics() {
+        printStatistics(typeid(T).name(),
+                        FormDatabase<T, Policy>::staticBroadPhase);
+        printStatistics(typeid(T).name(),
+                        FormDatabase<T, Policy>::dynamicBroadPhase);
+    }
+
+    void printFrameStatistics() {
+        const CollisionStatistics &frame = lastFrame;
+        ImGui::Text("update %.3f ms, %llu queries, %llu cells, %.1f "
+                    "candidates per query, peak %llu",
+                    frame.updateTime() * 1000.,
+                    (unsigned long long) frame.queries,
+                    (unsigned long long) frame.cells,
+                    frame.averageCandidates(),
+                    (unsigned long long) frame.peakCandidates);
+        ImGui::Text("%llu narrow phase tests, %llu hits",
+                    (unsigned long long) frame.tests,
+                    (unsigned long long) frame.hits);
+
+        ImGui::BeginTable("Frame statistics forms", 5);
+        for (const CollisionStatistics::Form &form : frame.forms) {
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", form.name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f ms", form.updateTime * 1000.);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu updated", (unsigned long long) form.updated);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu inserts", (unsigned long long) form.inserts);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu erases", (unsigned long long) form.erases);
+        }
+        ImGui::EndTable();
+
+        // tests/hits, a row per query form and a column per collider form
+        ImGui::BeginTable("Frame statistics pairs", (int) formCount + 1);
+        ImGui::TableNextColumn();
+        for (const CollisionStatistics::Form &form : frame.forms) {
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", form.name);
+        }
+        for (size_t query = 0; query < formCount; query++) {
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", frame.forms[query].name);
+            for (size_t collider = 0; collider < formCount; collider++) {
+                ImGui::TableNextColumn();
+                ImGui::Text(
+                    "%llu/%llu",
+                    (unsigned long long) frame.pairTests(query, collider),
+                    (unsigned long long) frame.pairHits(query, collider));
+            }
         }
+        ImGui::EndTable();
     }
 
     void ImGuiDebugWindow() {
@@ -373,6 +2186,9 @@ public:
         (printSingleSpacialHash<Types>(scanPos), ...);
         ImGui::EndTable();
 
+        printFrameStatistics();
+        (printSingleStatistics<Types>(), ...);
+
         ImGui::DragFloat2("test circle pos", &testCircle.position.x);
         ImGui::DragFloat("test circle rayon", &testCircle.rayon);
         auto forms = testCollision(testCircle);
@@ -388,7 +2204,15 @@ public:
 #endif
 };
 
-typedef CollisionDetectorTemplate<Circle, Rectangle, Point, Line, RasterArea>
+template<class... Types>
+using CollisionDetectorTemplate = BasicCollisionDetector<GridPolicy, Types...>;
+
+typedef CollisionDetectorTemplate<Circle,
+                                  Rectangle,
+                                  Point,
+                                  Line,
+                                  Polygon,
+                                  RasterArea>
     CollisionDetector;
 
 } // namespace Blob
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Blob {
+
+/**
+ * Collision layers of a collider. category holds the layers of the collider
+ * and mask the layers it collides with. Two colliders are tested only if each
+ * one is in the mask of the other, before any narrow phase.
+ */
+struct CollisionFilter {
+    uint16_t category = 1;
+    uint16_t mask = 0xFFFF;
+
+    /**
+     * @return a filter accepting every collider with a non empty mask, used by
+     * the queries without filter
+     */
+    static constexpr CollisionFilter all() { return {0xFFFF, 0xFFFF}; }
+
+    constexpr bool accepts(const CollisionFilter &other) const {
+        return (category & other.mask) && (other.category & mask);
+    }
+
+    bool operator==(const CollisionFilter &) const = default;
+};
+
+} // namespace Blob
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Blob {
+
+/**
+ * Work done by a broad phase for one overlap query
+ */
+struct QueryCounters {
+    // cells of the grid read, 0 for the broad phases without cells
+    uint64_t cells = 0;
+    // candidates accepted by the filter and tested by the narrow phase
+    uint64_t tests = 0;
+
+    QueryCounters &operator+=(const QueryCounters &other) {
+        cells += other.cells;
+        tests += other.tests;
+        return *this;
+    }
+};
+
+/**
+ * Counters of one frame of a BasicCollisionDetector, from the end of an
+ * update() to the end of the next one, so the queries of the game between two
+ * updates are counted with the second. The forms are indexed in the order of
+ * the Types of the detector.
+ */
+struct CollisionStatistics {
+    struct Form {
+        const char *name = "";
+        // time spent in update() on the colliders of the form, in seconds
+        double updateTime = 0;
+        // dynamic and ghost colliders updated
+        uint64_t updated = 0;
+        // entries added to and removed from the cells of the broad phases of
+        // the form, 0 for the broad phases without cells
+        uint64_t inserts = 0;
+        uint64_t erases = 0;
+    };
+    std::vector<Form> forms;
+
+    // overlap queries: one per collider updated, one per form tested by
+    // testCollision or testCollisions
+    uint64_t queries = 0;
+    // grid cells read by the queries
+    uint64_t cells = 0;
+    // narrow phase tests and hits, a collider sharing several cells with the
+    // query is counted in each of them
+    uint64_t tests = 0;
+    uint64_t hits = 0;
+    // most narrow phase tests done by a single query
+    uint64_t peakCandidates = 0;
+    // tests and hits by pair of forms, see pairTests
+    std::vector<uint64_t> testsByPair;
+    std::vector<uint64_t> hitsByPair;
+
+    /**
+     * @return the narrow phase tests between a query of form queryForm and
+     * the colliders of form colliderForm
+     */
+    uint64_t pairTests(size_t queryForm, size_t colliderForm) const {
+        return testsByPair[queryForm * forms.size() + colliderForm];
+    }
+
+    uint64_t pairHits(size_t queryForm, size_t colliderForm) const {
+        return hitsByPair[queryForm * forms.size() + colliderForm];
+    }
+
+    float averageCandidates() const {
+        return queries == 0 ? 0.f : (float) tests / (float) queries;
+    }
+
+    double updateTime() const {
+        double time = 0;
+        for (const Form &form : forms)
+            time += form.updateTime;
+        return time;
+    }
+};
+
+} // namespace Blob
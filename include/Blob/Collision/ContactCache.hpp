@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace Blob {
+
+class PhysicalObject;
+class ContactCache;
+
+/**
+ * Where the contacts of one dynamic collider are in the ContactCache
+ */
+struct ContactRun {
+    PhysicalObject *const owner;
+    // nullptr while the collider is disabled, its contacts are then parked
+    ContactCache *cache = nullptr;
+    uint32_t offset = 0;
+    uint32_t count = 0;
+    // frame of the ContactCache when the run was written
+    uint64_t frame = 0;
+    std::vector<PhysicalObject *> parked;
+    // cache listing the run while it is detached with parked contacts, and
+    // its position in ContactCache::parkedRuns
+    ContactCache *parkedIn = nullptr;
+    size_t parkedIndex = 0;
+
+    explicit ContactRun(PhysicalObject *owner) : owner(owner) {}
+
+    ~ContactRun();
+
+    /**
+     * @return the objects hit by the owner, sorted by address
+     */
+    std::span<PhysicalObject *const> targets() const;
+};
+
+/**
+ * Table of the (collider, target) contacts of every dynamic collider.
+ *
+ * The contacts of a collider are a sorted run of targets. Each frame the runs
+ * are written to a new table in update order, and the hit events come from a
+ * sorted merge of the old and the new run. Runs that were not updated are
+ * carried over by endFrame.
+ */
+class ContactCache {
+    friend struct ContactRun;
+
+public:
+    // (collider, target)
+    using Contact = std::pair<PhysicalObject *, PhysicalObject *>;
+
+private:
+    std::vector<PhysicalObject *> targets;
+    std::vector<ContactRun *> runs;
+    std::vector<PhysicalObject *> nextTargets;
+    std::vector<ContactRun *> nextRuns;
+    // detached runs with parked contacts
+    std::vector<ContactRun *> parkedRuns;
+    uint64_t frame = 0;
+    bool updating = false;
+
+    bool isNext(const ContactRun &run) const {
+        return updating && run.frame == frame;
+    }
+
+    void unpark(ContactRun &run);
+
+    void removeTargetsFrom(std::vector<PhysicalObject *> &table,
+                           std::vector<ContactRun *> &tableRuns,
+                           bool next,
+                           std::span<PhysicalObject *const> removed,
+                           std::vector<Contact> &ended);
+
+public:
+    // The contacts of every run, see snapshot
+    struct Snapshot {
+        std::vector<PhysicalObject *> targets;
+        std::vector<ContactRun *> runs;
+    };
+
+    ContactCache() = default;
+
+    ContactCache(const ContactCache &) = delete;
+
+    ~ContactCache();
+
+    bool isUpdating() const { return updating; }
+
+    /**
+     * Start writing a new table, the runs not written yet stay readable
+     */
+    void beginFrame();
+
+    /**
+     * Carry over the runs that were not written this frame and swap the tables
+     */
+    void endFrame();
+
+    /**
+     * Give the run its new contacts, call start(target) for every target not
+     * in the previous contacts, then end(target) for every previous target
+     * not in the new ones. At most once per frame for a run, and not for a
+     * run attached during the frame.
+     * @param hits the new contacts, sorted by address without duplicates
+     */
+    template<class Start, class End>
+    void replace(ContactRun &run,
+                 std::span<PhysicalObject *const> hits,
+                 Start &&start,
+                 End &&end) {
+        std::span<PhysicalObject *const> previous = run.targets();
+
+        run.offset = (uint32_t) nextTargets.size();
+        run.count = (uint32_t) hits.size();
+        run.frame = frame;
+        nextTargets.insert(nextTargets.end(), hits.begin(), hits.end());
+        nextRuns.insert(nextRuns.end(), hits.size(), &run);
+
+        auto p = previous.begin();
+        for (PhysicalObject *target : hits) {
+            while (p != previous.end() && *p < target)
+                ++p;
+            if (p == previous.end() || *p != target)
+                start(target);
+        }
+        auto h = hits.begin();
+        for (PhysicalObject *target : previous) {
+            while (h != hits.end() && *h < target)
+                ++h;
+            if (h == hits.end() || *h != target)
+                end(target);
+        }
+    }
+
+    /**
+     * Attach a run enabled again, with the contacts it had when disabled,
+     * between two frames or during one
+     */
+    void attach(ContactRun &run);
+
+    /**
+     * Detach a disabled run, its contacts are kept in ContactRun::parked
+     */
+    void detach(ContactRun &run);
+
+    /**
+     * Remove the contacts with targets about to be destroyed, from the
+     * attached runs and from the parked ones, between two frames or during
+     * one
+     * @param removed the targets, sorted by address
+     * @param ended appended with the contacts removed
+     */
+    void removeTargets(std::span<PhysicalObject *const> removed,
+                       std::vector<Contact> &ended);
+
+    /**
+     * Copy the contacts to a snapshot, between two frames
+     */
+    void snapshot(Snapshot &snapshot) const;
+
+    /**
+     * Give back to every attached run the contacts it had in a snapshot, empty
+     * if it had none. The runs of the snapshot must still be attached.
+     */
+    void restore(const Snapshot &snapshot);
+
+    /**
+     * Call f(collider, target) for every contact
+     */
+    template<class F>
+    void forEach(F &&f) const {
+        for (size_t i = 0; i < targets.size(); i++)
+            if (runs[i])
+                f(runs[i]->owner, targets[i]);
+    }
+};
+
+} // namespace Blob
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <Blob/Collision/NavigationGrid.hpp>
+#include <Blob/Collision/ThreadPool.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace Blob {
+
+/**
+ * Directions toward a goal for every walkable cell of a region of a
+ * NavigationGrid, to move a crowd of agents to the same goal without a path
+ * each. The distances to the goal are integrated with Dijkstra, with the
+ * moves of NavigationGrid, and each cell points to the neighbour it was
+ * reached from. With threads the region is cut in square tiles integrated in
+ * parallel, the tiles near the front of the distances first, and a tile is
+ * integrated again when its neighbours bring shorter distances.
+ */
+class FlowField {
+public:
+    // side of the tiles integrated in parallel, in cells
+    static constexpr int32_t tileSize = 32;
+
+private:
+    // no direction, on the goal and on the cells not joined to it
+    static constexpr uint8_t none = 8;
+
+    // cells of the region, inclusive
+    struct Tile {
+        int32_t x0, y0, x1, y1;
+    };
+
+    // neighbour tiles to integrate again after a tile, bit (dy + 1) * 3 +
+    // dx + 1 for the tile at dx, dy, and the shortest distance brought to
+    // them
+    struct Spread {
+        uint16_t tiles = 0;
+        float distance = std::numeric_limits<float>::infinity();
+    };
+
+    Vec2<> origin;
+    float cellSize;
+    // first cell of the region in the grid
+    Vec2<int32_t> first;
+    int32_t width, height;
+    Vec2<int32_t> goal;
+
+    std::vector<float> distances;
+    std::vector<uint8_t> directions;
+
+    int32_t localIndex(const Vec2<> &point) const {
+        const int32_t x =
+            (int32_t) std::floor((point.x - origin.x) / cellSize);
+        const int32_t y =
+            (int32_t) std::floor((point.y - origin.y) / cellSize);
+        if (x < 0 || y < 0 || x >= width || y >= height)
+            return -1;
+        return y * width + x;
+    }
+
+    static const Vec2<> moveDirections[none + 1];
+
+    Tile tileOf(int32_t tile) const;
+
+    // integrate the tile, from the distances of the cells around it in
+    // previous
+    Spread integrate(const NavigationGrid &grid,
+                     const Tile &cells,
+                     const std::vector<float> &previous,
+                     std::vector<std::pair<float, uint32_t>> &heap);
+
+    // integrate the tiles in passes until no distance changes, the tiles
+    // closest to the goal first
+    void integrateTiles(const NavigationGrid &grid, ThreadPool &threadPool);
+
+public:
+    /**
+     * @param grid giving the cells, not kept
+     * @param goal point the directions lead to
+     * @param region where the directions are computed, clamped to the grid.
+     * The paths stay in the region.
+     */
+    FlowField(const NavigationGrid &grid,
+              const Vec2<> &goal,
+              const Box &region);
+
+    /**
+     * Compute the distances and the directions from the walkable cells of
+     * grid, on the threads of threadPool if any. Call it again when the
+     * walkable cells in the region change.
+     */
+    void build(const NavigationGrid &grid, ThreadPool *threadPool = nullptr);
+
+    /**
+     * @return the normalized direction of the cell containing point, 0 out of
+     * the region, on the goal cell and where no path reaches the goal
+     */
+    Vec2<> direction(const Vec2<> &point) const {
+        const int32_t cell = localIndex(point);
+        return moveDirections[cell < 0 ? none : directions[cell]];
+    }
+
+    /**
+     * @return the length of the path from the cell containing point to the
+     * goal, in cells, infinity if there is none
+     */
+    float distance(const Vec2<> &point) const;
+
+    /**
+     * @return the area covered by the cells of the region
+     */
+    Box getRegion() const;
+
+    Vec2<int32_t> getGoal() const { return goal; }
+};
+
+} // namespace Blob
@@ -2,10 +2,16 @@
 
 #include <Blob/Maths.inl>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <tuple>
 #include <ostream>
 #include <string>
+#include <type_traits>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -15,6 +21,7 @@ namespace Blob {
 class Circle;
 class Line;
 class Rectangle;
+class Polygon;
 class RasterArea;
 
 struct CollisionResolution {
@@ -22,6 +29,605 @@ struct CollisionResolution {
     Vec2<> collisionPoint, normal, bounce, shift;
 };
 
+/**
+ * Axis aligned bounding box
+ */
+struct Box {
+    Vec2<> min, max;
+
+    bool overlap(const Box &box) const {
+        return min.x <= box.max.x && max.x >= box.min.x &&
+               min.y <= box.max.y && max.y >= box.min.y;
+    }
+
+    bool contains(const Box &box) const {
+        return min.x <= box.min.x && min.y <= box.min.y &&
+               max.x >= box.max.x && max.y >= box.max.y;
+    }
+
+    Box merge(const Box &box) const {
+        return {{std::min(min.x, box.min.x), std::min(min.y, box.min.y)},
+                {std::max(max.x, box.max.x), std::max(max.y, box.max.y)}};
+    }
+
+    Box expand(float margin) const { return {min - margin, max + margin}; }
+
+    Vec2<> center() const { return (min + max) / 2; }
+
+    /**
+     * @return the distance from point to the box, 0 inside it
+     */
+    float distance(const Vec2<> &point) const {
+        const float dx = std::max({min.x - point.x, 0.f, point.x - max.x});
+        const float dy = std::max({min.y - point.y, 0.f, point.y - max.y});
+        return std::sqrt(dx * dx + dy * dy);
+    }
+
+    float perimeter() const { return 2 * (max.x - min.x + max.y - min.y); }
+
+    /**
+     * @param direction normalized
+     * @return the distance where the ray from origin enters the box, 0 if
+     * origin is inside, infinity if the ray misses it before maxDistance
+     */
+    float rayEntry(const Vec2<> &origin,
+                   const Vec2<> &direction,
+                   float maxDistance) const {
+        float near = 0, far = maxDistance;
+        auto slab = [&](float o, float d, float low, float high) {
+            if (d == 0)
+                return o >= low && o <= high;
+            float t1 = (low - o) / d, t2 = (high - o) / d;
+            if (t1 > t2)
+                std::swap(t1, t2);
+            near = std::max(near, t1);
+            far = std::min(far, t2);
+            return near <= far;
+        };
+        if (slab(origin.x, direction.x, min.x, max.x) &&
+            slab(origin.y, direction.y, min.y, max.y))
+            return near;
+        return std::numeric_limits<float>::infinity();
+    }
+};
+
+/**
+ * Inclusive rectangle of integer cells, iterable cell by cell. This is what
+ * the forms return from rasterize(), so walking the cells of a form does not
+ * allocate.
+ */
+struct CellRange {
+    Vec2<int32_t> first, last;
+
+    class iterator {
+    private:
+        Vec2<int32_t> cell;
+        int32_t startX, endX;
+
+    public:
+        iterator(const Vec2<int32_t> &cell, int32_t startX, int32_t endX) :
+            cell(cell), startX(startX), endX(endX) {}
+
+        const Vec2<int32_t> &operator*() const { return cell; }
+
+        iterator &operator++() {
+            if (++cell.x > endX) {
+                cell.x = startX;
+                ++cell.y;
+            }
+            return *this;
+        }
+
+        bool operator==(const iterator &other) const {
+            return cell == other.cell;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return cell != other.cell;
+        }
+    };
+
+    bool empty() const { return first.x > last.x || first.y > last.y; }
+
+    // number of cells, in 64 bits for the ranges of huge boxes
+    uint64_t size() const {
+        if (empty())
+            return 0;
+        return (uint64_t) ((int64_t) last.x - first.x + 1) *
+               (uint64_t) ((int64_t) last.y - first.y + 1);
+    }
+
+    bool contains(const Vec2<int32_t> &cell) const {
+        return cell.x >= first.x && cell.x <= last.x && cell.y >= first.y &&
+               cell.y <= last.y;
+    }
+
+    iterator begin() const {
+        return empty() ? end() : iterator{first, first.x, last.x};
+    }
+
+    iterator end() const { return {{first.x, last.y + 1}, first.x, last.x}; }
+
+    bool operator==(const CellRange &other) const {
+        return first == other.first && last == other.last;
+    }
+
+    bool operator!=(const CellRange &other) const {
+        return !operator==(other);
+    }
+};
+
+/**
+ * Cells crossed by the segment from a to b, in order from the cell of a
+ * (Amanatides and Woo traversal). When the segment goes exactly through a
+ * corner, the cell in the vertical direction is visited first.
+ *
+ * The crossing times are computed from the cell boundaries instead of being
+ * accumulated, so contains() gives the same answer as a full traversal in
+ * constant time.
+ */
+struct GridTraversal {
+    Vec2<> a, b;
+
+    // when the segment crosses boundary on one axis, in [0, 1] along it
+    static float time(float boundary, float start, float delta) {
+        return (boundary - start) / delta;
+    }
+
+    // An end on the lower boundary of a cell is in that cell: going down,
+    // reaching the boundary at time 1 does not cross it
+    static bool crosses(float time, int32_t step) {
+        return time < 1 || (time == 1 && step > 0);
+    }
+
+    class iterator {
+    private:
+        Vec2<> start, delta;
+        Vec2<int32_t> cell, step;
+        float nextX = 0, nextY = 0, entry = 0;
+        // step of the last move, zero in the first cell
+        Vec2<int32_t> moved;
+        bool done;
+
+        float crossingX() const {
+            if (step.x == 0)
+                return std::numeric_limits<float>::infinity();
+            const float t = time(float(step.x > 0 ? cell.x + 1 : cell.x),
+                                 start.x,
+                                 delta.x);
+            return crosses(t, step.x) ? t
+                                      : std::numeric_limits<float>::infinity();
+        }
+
+        float crossingY() const {
+            if (step.y == 0)
+                return std::numeric_limits<float>::infinity();
+            const float t = time(float(step.y > 0 ? cell.y + 1 : cell.y),
+                                 start.y,
+                                 delta.y);
+            return crosses(t, step.y) ? t
+                                      : std::numeric_limits<float>::infinity();
+        }
+
+    public:
+        iterator() : done(true) {}
+
+        explicit iterator(const GridTraversal &traversal) :
+            start(traversal.a),
+            delta(traversal.b - traversal.a),
+            cell((int32_t) std::floor(start.x), (int32_t) std::floor(start.y)),
+            step(delta.x > 0 ? 1 : (delta.x < 0 ? -1 : 0),
+                 delta.y > 0 ? 1 : (delta.y < 0 ? -1 : 0)),
+            done(false) {
+            nextX = crossingX();
+            nextY = crossingY();
+        }
+
+        const Vec2<int32_t> &operator*() const { return cell; }
+
+        /**
+         * @return when the segment enters the current cell, in [0, 1]
+         */
+        float entryTime() const { return entry; }
+
+        /**
+         * @return when the segment leaves the current cell, more than 1 for
+         * the last cell
+         */
+        float exitTime() const { return std::min(nextX, nextY); }
+
+        /**
+         * @return the normal of the boundary crossed to enter the current
+         * cell, facing the segment, zero in the first cell
+         */
+        Vec2<> crossedNormal() const { return -moved.cast<float>(); }
+
+        iterator &operator++() {
+            if (nextX > 1 && nextY > 1)
+                done = true;
+            else if (nextX < nextY) {
+                entry = nextX;
+                moved = {step.x, 0};
+                cell.x += step.x;
+                nextX = crossingX();
+            } else {
+                entry = nextY;
+                moved = {0, step.y};
+                cell.y += step.y;
+                nextY = crossingY();
+            }
+            return *this;
+        }
+
+        bool operator==(const iterator &other) const {
+            return done == other.done && (done || cell == other.cell);
+        }
+
+        bool operator!=(const iterator &other) const {
+            return !operator==(other);
+        }
+    };
+
+    bool empty() const { return false; }
+
+    bool contains(const Vec2<int32_t> &cell) const {
+        // A cell is visited when the segment is in its column and in its row
+        // at the same time. The crossings are ordered by time, then the
+        // vertical one first, like in iterator::operator++.
+        typedef std::pair<float, int> Crossing;
+        constexpr float infinity = std::numeric_limits<float>::infinity();
+        Crossing enter{-infinity, 0}, exit{infinity, 0};
+        const Vec2<> delta = b - a;
+
+        auto axis = [&](int32_t c, float start, float d, int order) {
+            const int32_t first = (int32_t) std::floor(start);
+            if (d == 0)
+                return c == first;
+            const int32_t step = d > 0 ? 1 : -1;
+            if ((int64_t) (c - first) * step < 0)
+                return false;
+            if (c != first) {
+                const float t = time(float(step > 0 ? c : c + 1), start, d);
+                if (!crosses(t, step))
+                    return false;
+                enter = std::max(enter, Crossing{t, order});
+            }
+            const float t = time(float(step > 0 ? c + 1 : c), start, d);
+            if (crosses(t, step))
+                exit = std::min(exit, Crossing{t, order});
+            return true;
+        };
+
+        return axis(cell.x, a.x, delta.x, 1) && axis(cell.y, a.y, delta.y, 0) &&
+               enter < exit;
+    }
+
+    iterator begin() const { return iterator{*this}; }
+
+    iterator end() const { return {}; }
+
+    bool operator==(const GridTraversal &other) const {
+        return a == other.a && b == other.b;
+    }
+
+    bool operator!=(const GridTraversal &other) const {
+        return !operator==(other);
+    }
+};
+
+/**
+ * Cells touched by a disc, as one span of cells per row. The span of a row is
+ * the width of the disc at the point of the row nearest to the center, so the
+ * corners of the bounding square are left out.
+ */
+struct DiscCells {
+    typedef std::pair<int32_t, int32_t> Span;
+
+    Vec2<> center;
+    float rayon = 0;
+    int32_t firstRow = 0, lastRow = -1;
+
+private:
+    // spans of the small discs, computed once since a moving collider
+    // compares and walks its cells several times per update
+    static constexpr int32_t cachedRows = 3;
+    std::array<Span, cachedRows> rows;
+
+    Span computeSpan(int32_t row) const {
+        float dy = 0;
+        if (center.y < float(row))
+            dy = float(row) - center.y;
+        else if (center.y > float(row + 1))
+            dy = center.y - float(row + 1);
+        const float half = std::sqrt(std::max(0.f, rayon * rayon - dy * dy));
+        return {(int32_t) std::floor(center.x - half),
+                (int32_t) std::floor(center.x + half)};
+    }
+
+    bool cached() const { return lastRow - firstRow < cachedRows; }
+
+public:
+    DiscCells() = default;
+
+    /**
+     * @param conservative also keep the cells at a rounding error from the
+     * disc, so a broad phase never misses an overlap the narrow phase finds
+     */
+    DiscCells(const Vec2<> &center, float rayon, bool conservative) :
+        center(center), rayon(rayon) {
+        if (conservative)
+            this->rayon +=
+                (std::abs(center.x) + std::abs(center.y) + rayon) * 1e-6f;
+        firstRow = (int32_t) std::floor(center.y - this->rayon);
+        lastRow = (int32_t) std::floor(center.y + this->rayon);
+        if (cached())
+            for (int32_t row = firstRow; row <= lastRow; row++)
+                rows[row - firstRow] = computeSpan(row);
+    }
+
+    /**
+     * @return the first and last cell of a row between firstRow and lastRow
+     */
+    Span span(int32_t row) const {
+        return cached() ? rows[row - firstRow] : computeSpan(row);
+    }
+
+    class iterator {
+    private:
+        const DiscCells *cells;
+        Vec2<int32_t> cell;
+        int32_t last = 0;
+
+    public:
+        iterator(const DiscCells *cells, int32_t row) : cells(cells) {
+            cell.y = row;
+            if (row <= cells->lastRow)
+                std::tie(cell.x, last) = cells->span(row);
+        }
+
+        const Vec2<int32_t> &operator*() const { return cell; }
+
+        iterator &operator++() {
+            if (++cell.x > last) {
+                cell.x = 0;
+                if (++cell.y <= cells->lastRow)
+                    std::tie(cell.x, last) = cells->span(cell.y);
+            }
+            return *this;
+        }
+
+        bool operator==(const iterator &other) const {
+            return cell == other.cell;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return cell != other.cell;
+        }
+    };
+
+    bool empty() const { return firstRow > lastRow; }
+
+    bool contains(const Vec2<int32_t> &cell) const {
+        if (cell.y < firstRow || cell.y > lastRow)
+            return false;
+        const auto [first, last] = span(cell.y);
+        return cell.x >= first && cell.x <= last;
+    }
+
+    iterator begin() const { return {this, firstRow}; }
+
+    iterator end() const { return {this, lastRow + 1}; }
+
+    /**
+     * Same cells, compared row by row
+     */
+    bool operator==(const DiscCells &other) const {
+        if (firstRow != other.firstRow || lastRow != other.lastRow)
+            return false;
+        if (center == other.center && rayon == other.rayon)
+            return true;
+        for (int32_t row = firstRow; row <= lastRow; row++)
+            if (span(row) != other.span(row))
+                return false;
+        return true;
+    }
+
+    bool operator!=(const DiscCells &other) const {
+        return !operator==(other);
+    }
+};
+
+/**
+ * Cells touched by a box moving along a segment, as one span of cells per
+ * row. The swept box is convex, so the cells of a row are the columns of the
+ * segment while it is at less than the half height of the box from the row.
+ */
+struct SweptCells {
+    typedef std::pair<int32_t, int32_t> Span;
+
+    // path of the center of the box
+    Vec2<> from, to;
+    Vec2<> halfSize;
+    int32_t firstRow = 0, lastRow = -1;
+
+    SweptCells() = default;
+
+    /**
+     * The cells at a rounding error from the box are kept, like the
+     * conservative cells of DiscCells
+     */
+    SweptCells(const Vec2<> &from, const Vec2<> &to, const Vec2<> &halfSize) :
+        from(from), to(to), halfSize(halfSize) {
+        this->halfSize += (std::abs(from.x) + std::abs(from.y) +
+                           std::abs(to.x) + std::abs(to.y)) *
+                              1e-6f +
+                          1e-6f;
+        firstRow =
+            (int32_t) std::floor(std::min(from.y, to.y) - this->halfSize.y);
+        lastRow =
+            (int32_t) std::floor(std::max(from.y, to.y) + this->halfSize.y);
+    }
+
+    /**
+     * @return the first and last cell of a row between firstRow and lastRow
+     */
+    Span span(int32_t row) const {
+        const float dy = to.y - from.y;
+        float start = 0, end = 1;
+        if (dy != 0) {
+            start = (float(row) - halfSize.y - from.y) / dy;
+            end = (float(row + 1) + halfSize.y - from.y) / dy;
+            if (start > end)
+                std::swap(start, end);
+            start = std::max(start, 0.f);
+            end = std::min(end, 1.f);
+        }
+        const float x1 = from.x + (to.x - from.x) * start;
+        const float x2 = from.x + (to.x - from.x) * end;
+        return {(int32_t) std::floor(std::min(x1, x2) - halfSize.x),
+                (int32_t) std::floor(std::max(x1, x2) + halfSize.x)};
+    }
+
+    class iterator {
+    private:
+        const SweptCells *cells;
+        Vec2<int32_t> cell;
+        int32_t last = 0;
+
+    public:
+        iterator(const SweptCells *cells, int32_t row) : cells(cells) {
+            cell.y = row;
+            if (row <= cells->lastRow)
+                std::tie(cell.x, last) = cells->span(row);
+        }
+
+        const Vec2<int32_t> &operator*() const { return cell; }
+
+        iterator &operator++() {
+            if (++cell.x > last) {
+                cell.x = 0;
+                if (++cell.y <= cells->lastRow)
+                    std::tie(cell.x, last) = cells->span(cell.y);
+            }
+            return *this;
+        }
+
+        bool operator==(const iterator &other) const {
+            return cell == other.cell;
+        }
+
+        bool operator!=(const iterator &other) const {
+            return cell != other.cell;
+        }
+    };
+
+    bool empty() const { return firstRow > lastRow; }
+
+    bool contains(const Vec2<int32_t> &cell) const {
+        if (cell.y < firstRow || cell.y > lastRow)
+            return false;
+        const auto [first, last] = span(cell.y);
+        return cell.x >= first && cell.x <= last;
+    }
+
+    iterator begin() const { return {this, firstRow}; }
+
+    iterator end() const { return {this, lastRow + 1}; }
+};
+
+/**
+ * Bounding box of a form moving along a segment, the query form of the swept
+ * tests. It holds the capsule swept by a circle and the hexagon swept by a
+ * rectangle.
+ */
+struct SweptBox {
+    Box box;
+    Vec2<> motion;
+
+    Box bounds() const {
+        return box.merge({box.min + motion, box.max + motion});
+    }
+
+    SweptCells rasterize() const {
+        return {box.center(), box.center() + motion, (box.max - box.min) / 2};
+    }
+};
+
+/**
+ * Square rings of cells around the cell of a point: ring r holds the cells r
+ * columns or r rows away from it. The nearest queries walk the rings from the
+ * point and stop at the first one farther than what they look for.
+ */
+struct CellRings {
+    Vec2<> origin;
+    Vec2<int32_t> center;
+
+    explicit CellRings(const Vec2<> &origin) :
+        origin(origin),
+        center((int32_t) std::floor(origin.x),
+               (int32_t) std::floor(origin.y)) {}
+
+    /**
+     * @return the distance from origin to the nearest cell of a ring
+     */
+    float distance(int32_t ring) const {
+        if (ring == 0)
+            return 0;
+        return std::min({origin.x - float(center.x - ring + 1),
+                         float(center.x + ring) - origin.x,
+                         origin.y - float(center.y - ring + 1),
+                         float(center.y + ring) - origin.y});
+    }
+
+    /**
+     * @return the distance from origin to a cell
+     */
+    float distance(const Vec2<int32_t> &cell) const {
+        return Box{cell.cast<float>(), (cell + 1).cast<float>()}.distance(
+            origin);
+    }
+
+    int32_t ringOf(const Vec2<int32_t> &cell) const {
+        return std::max(std::abs(cell.x - center.x),
+                        std::abs(cell.y - center.y));
+    }
+
+    /**
+     * @return the number of cells of a ring
+     */
+    static size_t size(int32_t ring) { return ring ? 8 * (size_t) ring : 1; }
+
+    /**
+     * Call f(cell) for every cell of a ring
+     */
+    template<class F>
+    void forEach(int32_t ring, F &&f) const {
+        if (ring == 0) {
+            f(center);
+            return;
+        }
+        for (int32_t x = center.x - ring; x <= center.x + ring; x++) {
+            f(Vec2<int32_t>{x, center.y - ring});
+            f(Vec2<int32_t>{x, center.y + ring});
+        }
+        for (int32_t y = center.y - ring + 1; y < center.y + ring; y++) {
+            f(Vec2<int32_t>{center.x - ring, y});
+            f(Vec2<int32_t>{center.x + ring, y});
+        }
+    }
+};
+
+/**
+ * Where a ray enters a form
+ */
+struct RayHit {
+    // from the origin of the ray, 0 if the origin is inside the form
+    float distance;
+    // facing the ray, the opposite of the ray direction if the origin is
+    // inside the form
+    Vec2<> normal;
+};
+
 class Point : public Vec2<> {
 public:
     using Vec2<>::Vec2;
@@ -41,9 +647,39 @@ public:
 
     bool overlap(const Circle &circle) const;
 
+    bool overlap(const Polygon &polygon) const;
+
     constexpr static bool overlap(const RasterArea &rasterArea) { return true; }
 
-    std::unordered_set<Vec2<int32_t>> rasterize() const;
+    /**
+     * A point has no area, rays go through it like the lines do
+     */
+    constexpr static std::optional<RayHit>
+    raycast(const Vec2<> &origin, const Vec2<> &direction, float maxDistance) {
+        return std::nullopt;
+    }
+
+    /**
+     * @param direction normalized
+     * @return where the point moving along direction enters form, the ray
+     * from the point
+     */
+    template<class U>
+    std::optional<RayHit>
+    sweep(const Vec2<> &direction, float maxDistance, const U &form) const {
+        return form.raycast(*this, direction, maxDistance);
+    }
+
+    Box bounds() const { return {*this, *this}; }
+
+    /**
+     * @return the distance from point to the form, 0 inside it
+     */
+    float distance(const Vec2<> &point) const {
+        return Vec2<>(*this, point).length();
+    }
+
+    CellRange rasterize() const;
 
     friend std::ostream &operator<<(std::ostream &os, const Point &p) {
         return os << "Point: " << (Vec2<>) p;
@@ -71,6 +707,8 @@ public:
 
     bool overlap(const Point &point) const;
 
+    bool overlap(const Polygon &polygon) const;
+
     CollisionResolution resolve(const Circle &circle, Vec2<> destination) const;
 
     CollisionResolution resolve(const Line &line, Vec2<> destination) const;
@@ -82,7 +720,60 @@ public:
 
     constexpr static bool overlap(const RasterArea &rasterArea) { return true; }
 
-    std::unordered_set<Vec2<int32_t>> rasterize() const;
+    /**
+     * @param direction normalized
+     * @return where the ray from origin enters the form, if it does before
+     * maxDistance
+     */
+    std::optional<RayHit> raycast(const Vec2<> &origin,
+                                  const Vec2<> &direction,
+                                  float maxDistance) const;
+
+    /**
+     * @param direction normalized
+     * @return where the circle moving along direction first touches form:
+     * the distance moved and the normal of form facing it, 0 if they overlap
+     * already. Nothing if it does not before maxDistance.
+     */
+    std::optional<RayHit> sweep(const Vec2<> &direction,
+                                float maxDistance,
+                                const Circle &form) const;
+
+    std::optional<RayHit> sweep(const Vec2<> &direction,
+                                float maxDistance,
+                                const Rectangle &form) const;
+
+    std::optional<RayHit> sweep(const Vec2<> &direction,
+                                float maxDistance,
+                                const Point &form) const;
+
+    std::optional<RayHit> sweep(const Vec2<> &direction,
+                                float maxDistance,
+                                const Line &form) const;
+
+    std::optional<RayHit> sweep(const Vec2<> &direction,
+                                float maxDistance,
+                                const Polygon &form) const;
+
+    std::optional<RayHit> sweep(const Vec2<> &direction,
+                                float maxDistance,
+                                const RasterArea &form) const;
+
+    Box bounds() const { return {position - rayon, position + rayon}; }
+
+    float distance(const Vec2<> &point) const {
+        return std::max(0.f, Vec2<>(position, point).length() - rayon);
+    }
+
+    bool operator==(const Circle &) const = default;
+
+    /**
+     * @param conservative see DiscCells, the broad phases use the
+     * conservative cells
+     */
+    DiscCells rasterize(bool conservative = true) const {
+        return {position, rayon, conservative};
+    }
 
     friend std::ostream &operator<<(std::ostream &os, const Circle &p) {
         return os << "Circle: {position: " << (Vec2<>) p.position
@@ -116,9 +807,31 @@ public:
 
     bool overlap(const Point &point) const;
 
+    bool overlap(const Polygon &polygon) const;
+
     constexpr static bool overlap(const RasterArea &rasterArea) { return true; }
 
-    std::unordered_set<Vec2<int32_t>> rasterize() const;
+    /**
+     * @param direction normalized
+     * @return where the ray from origin enters the form, if it does before
+     * maxDistance
+     */
+    std::optional<RayHit> raycast(const Vec2<> &origin,
+                                  const Vec2<> &direction,
+                                  float maxDistance) const;
+
+    Box bounds() const {
+        return {{std::min(positionA.x, positionB.x),
+                 std::min(positionA.y, positionB.y)},
+                {std::max(positionA.x, positionB.x),
+                 std::max(positionA.y, positionB.y)}};
+    }
+
+    float distance(const Vec2<> &point) const;
+
+    GridTraversal rasterize() const;
+
+    bool operator==(const Line &) const = default;
 
     //        double getGradient() const { return vector.y /
     //        vector.x; }
@@ -149,6 +862,8 @@ public:
 
     bool overlap(const Point &point) const;
 
+    bool overlap(const Polygon &polygon) const;
+
     constexpr static bool overlap(const RasterArea &rasterArea) { return true; }
 
     CollisionResolution resolve(const Rectangle &rectangle,
@@ -156,7 +871,54 @@ public:
 
     CollisionResolution resolve(const Point &point, Vec2<> destination) const;
 
-    std::unordered_set<Vec2<int32_t>> rasterize() const;
+    /**
+     * @param direction normalized
+     * @return where the ray from origin enters the form, if it does before
+     * maxDistance
+     */
+    std::optional<RayHit> raycast(const Vec2<> &origin,
+                                  const Vec2<> &direction,
+                                  float maxDistance) const;
+
+    /**
+     * @param direction normalized
+     * @return where the rectangle moving along direction first touches form:
+     * the distance moved and the normal of form facing it, 0 if they overlap
+     * already. Nothing if it does not before maxDistance.
+     */
+    std::optional<RayHit> sweep(const Vec2<> &direction,
+                                float maxDistance,
+                                const Circle &form) const;
+
+    std::optional<RayHit> sweep(const Vec2<> &direction,
+                                float maxDistance,
+                                const Rectangle &form) const;
+
+    std::optional<RayHit> sweep(const Vec2<> &direction,
+                                float maxDistance,
+                                const Point &form) const;
+
+    std::optional<RayHit> sweep(const Vec2<> &direction,
+                                float maxDistance,
+                                const Line &form) const;
+
+    std::optional<RayHit> sweep(const Vec2<> &direction,
+                                float maxDistance,
+                                const Polygon &form) const;
+
+    std::optional<RayHit> sweep(const Vec2<> &direction,
+                                float maxDistance,
+                                const RasterArea &form) const;
+
+    Box bounds() const { return {position - size / 2, position + size / 2}; }
+
+    float distance(const Vec2<> &point) const {
+        return bounds().distance(point);
+    }
+
+    CellRange rasterize() const;
+
+    bool operator==(const Rectangle &) const = default;
 
     friend std::ostream &operator<<(std::ostream &os, const Rectangle &p) {
         return os << "Rectangle: {position: " << (Vec2<>) p.position
@@ -164,6 +926,138 @@ public:
     }
 };
 
+/**
+ * How deep two forms overlap
+ */
+struct Penetration {
+    float depth;
+    // direction to move the other form by depth to separate the forms
+    Vec2<> normal;
+};
+
+/**
+ * Convex polygon. The vertices are given once around the origin and shared by
+ * the copies of the form, which only hold its position and angle: a vertex is
+ * turned and moved when read, so copying a polygon does not allocate. The
+ * shared vertices are also stored as two arrays for the SIMD support function.
+ */
+class Polygon {
+private:
+    // counterclockwise convex hull of the vertices given
+    struct Vertices {
+        std::vector<Vec2<>> points;
+        std::vector<float> x, y;
+    };
+
+    std::shared_ptr<const Vertices> local;
+    Point position;
+    float angle = 0;
+    float cosAngle = 1, sinAngle = 0;
+    // bounds of the turned vertices, around position
+    Box extent;
+    Box box;
+
+    Vec2<> turn(const Vec2<> &point) const {
+        return {point.x * cosAngle - point.y * sinAngle,
+                point.x * sinAngle + point.y * cosAngle};
+    }
+
+    void transform();
+
+public:
+    Polygon() = default;
+
+    /**
+     * @param vertices around the origin of the polygon, in any order, their
+     * convex hull is used
+     */
+    explicit Polygon(const std::vector<Vec2<>> &vertices,
+                     const Vec2<> &position = {},
+                     float angle = 0);
+
+    const Point &getPosition() const { return position; }
+
+    float getAngle() const { return angle; }
+
+    /**
+     * @return the vertices around the origin, counterclockwise
+     */
+    const std::vector<Vec2<>> &getLocalVertices() const;
+
+    void setPosition(const Vec2<> &newPosition);
+
+    /**
+     * @param newAngle in radian, counterclockwise
+     */
+    void setAngle(float newAngle);
+
+    size_t size() const { return local ? local->points.size() : 0; }
+
+    Vec2<> vertex(size_t index) const {
+        return position + turn(local->points[index]);
+    }
+
+    // index of the vertex after index, counterclockwise
+    size_t next(size_t index) const {
+        return index + 1 == size() ? 0 : index + 1;
+    }
+
+    /**
+     * @return the index of the vertex the furthest along direction. Large
+     * polygons climb from hint to the best vertex instead of testing all of
+     * them, pass the previous result when the direction changes little.
+     */
+    size_t support(const Vec2<> &direction, size_t hint = 0) const;
+
+    bool overlap(const Rectangle &rectangle) const;
+
+    bool overlap(const Circle &circle) const;
+
+    bool overlap(const Line &line) const;
+
+    bool overlap(const Point &point) const;
+
+    bool overlap(const Polygon &polygon) const;
+
+    constexpr static bool overlap(const RasterArea &rasterArea) { return true; }
+
+    /**
+     * @return how deep a form enters the polygon, nothing if they do not
+     * overlap. Computed with EPA from the GJK simplex for the polygonal forms.
+     */
+    std::optional<Penetration> penetration(const Polygon &polygon) const;
+
+    std::optional<Penetration> penetration(const Rectangle &rectangle) const;
+
+    std::optional<Penetration> penetration(const Circle &circle) const;
+
+    /**
+     * @param direction normalized
+     * @return where the ray from origin enters the form, if it does before
+     * maxDistance
+     */
+    std::optional<RayHit> raycast(const Vec2<> &origin,
+                                  const Vec2<> &direction,
+                                  float maxDistance) const;
+
+    const Box &bounds() const { return box; }
+
+    float distance(const Vec2<> &point) const;
+
+    CellRange rasterize() const;
+
+    bool operator==(const Polygon &other) const {
+        return local == other.local &&
+               position == other.position && angle == other.angle;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const Polygon &p) {
+        return os << "Polygon: {position: " << (Vec2<>) p.position
+                  << ", angle: " << p.angle << ", vertices: " << p.size()
+                  << "}";
+    }
+};
+
 class RasterArea {
 public:
     std::unordered_set<Vec2<int32_t>> area;
@@ -215,13 +1109,75 @@ public:
 
     constexpr static bool overlap(const Point &point) { return true; }
 
+    constexpr static bool overlap(const Polygon &polygon) { return true; }
+
     constexpr static bool overlap(const RasterArea &rasterArea) { return true; }
 
-    std::unordered_set<Vec2<int32_t>> rasterize() const { return area; };
+    /**
+     * @param direction normalized
+     * @return where the ray from origin enters the first cell of the area, if
+     * it does before maxDistance
+     */
+    std::optional<RayHit> raycast(const Vec2<> &origin,
+                                  const Vec2<> &direction,
+                                  float maxDistance) const {
+        const GridTraversal cells{origin, origin + direction * maxDistance};
+        for (auto it = cells.begin(); it != cells.end(); ++it) {
+            if (!area.contains(*it))
+                continue;
+            if (it.entryTime() == 0)
+                return RayHit{0, -direction};
+            return RayHit{it.entryTime() * maxDistance, it.crossedNormal()};
+        }
+        return std::nullopt;
+    }
+
+    Box bounds() const {
+        if (area.empty())
+            return {};
+        Vec2<int32_t> min = *area.begin(), max = min;
+        for (const auto &cell : area) {
+            min = {std::min(min.x, cell.x), std::min(min.y, cell.y)};
+            max = {std::max(max.x, cell.x), std::max(max.y, cell.y)};
+        }
+        return {min.cast<float>(), (max + 1).cast<float>()};
+    }
+
+    float distance(const Vec2<> &point) const {
+        const Vec2<int32_t> cell{(int32_t) std::floor(point.x),
+                                 (int32_t) std::floor(point.y)};
+        if (area.contains(cell))
+            return 0;
+        float nearest = std::numeric_limits<float>::infinity();
+        for (const auto &c : area)
+            nearest = std::min(nearest,
+                               Box{c.cast<float>(), (c + 1).cast<float>()}
+                                   .distance(point));
+        return nearest;
+    }
+
+    const std::unordered_set<Vec2<int32_t>> &rasterize() const { return area; };
+
+    bool operator==(const RasterArea &) const = default;
 
     friend std::ostream &operator<<(std::ostream &os, const RasterArea &p) {
         return os << "RasterArea: ";
     }
 };
 
+/**
+ * What T::rasterize() returns, stored by value
+ */
+template<class T>
+using Rasterization =
+    std::remove_cvref_t<decltype(std::declval<const T &>().rasterize())>;
+
+/**
+ * A form of type T can be swept against a form of type U, see Circle::sweep
+ */
+template<class T, class U>
+concept CanSweep = requires(const T &form, const U &target) {
+    form.sweep(Vec2<>{}, 0.f, target);
+};
+
 } // namespace Blob
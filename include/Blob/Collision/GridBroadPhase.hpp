@@ -0,0 +1,306 @@
+#pragma once
+
+#include <Blob/Collision/CollisionFilter.hpp>
+#include <Blob/Collision/CollisionStatistics.hpp>
+#include <Blob/Collision/Forms.hpp>
+#include <Blob/Collision/PackedForms.hpp>
+#include <Blob/Collision/SpacialGrid.hpp>
+#include <Blob/Core/Exception.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+namespace Blob {
+
+struct GridBroadPhaseStatistics {
+    // non empty cells
+    size_t cells = 0;
+    // collider references in the cells
+    size_t entries = 0;
+    // references added to and removed from the cells since the creation
+    uint64_t inserts = 0;
+    uint64_t erases = 0;
+
+    float occupancy() const {
+        return cells == 0 ? 0.f : (float) entries / (float) cells;
+    }
+};
+
+/**
+ * Broad phase storing the colliders in the cells of their rasterization. Fast
+ * for many small colliders of similar size, a large form fills many cells.
+ *
+ * The cells hold proxies with the collision filter of their collider, so
+ * overlap() rejects the filtered pairs without reading the colliders. The
+ * forms with PackedForms are also stored as arrays, and overlap() runs the
+ * batch kernels on the proxies of each cell.
+ * @tparam Collider the type of collider stored
+ * @tparam Form the form of the colliders
+ */
+template<class Collider, class Form>
+class GridBroadPhase {
+private:
+    struct Proxy {
+        Collider *collider = nullptr;
+        Rasterization<Form> cells;
+        CollisionFilter filter;
+    };
+
+    struct Entry {
+        uint32_t proxy;
+        CollisionFilter filter;
+
+        bool operator==(const Entry &) const = default;
+    };
+
+    struct NoPackedForms {};
+
+    SpacialGrid<Entry> grid;
+    std::vector<Proxy> proxies;
+    std::vector<uint32_t> freeProxies;
+    std::conditional_t<HasPackedForms<Form>, PackedForms<Form>, NoPackedForms>
+        packedForms;
+
+    uint64_t inserts = 0;
+    uint64_t erases = 0;
+
+public:
+    /**
+     * Add a collider with its current form
+     * @return the proxy identifying the collider in this broad phase
+     */
+    uint32_t insert(Collider *collider, const Form &form) {
+        uint32_t proxy;
+        if (freeProxies.empty()) {
+            proxy = (uint32_t) proxies.size();
+            proxies.emplace_back();
+        } else {
+            proxy = freeProxies.back();
+            freeProxies.pop_back();
+        }
+        proxies[proxy].collider = collider;
+        proxies[proxy].cells = form.rasterize();
+        proxies[proxy].filter = collider->collisionFilter;
+        if constexpr (HasPackedForms<Form>)
+            packedForms.set(proxy, form);
+
+        for (const auto &position : proxies[proxy].cells) {
+            if (!grid.insert(position, {proxy, proxies[proxy].filter}))
+                throw Exception(
+                    "Insertion in Spacial Hash but element already exist");
+            inserts++;
+        }
+        return proxy;
+    }
+
+    void erase(uint32_t proxy) {
+        Proxy &p = proxies[proxy];
+        for (const auto &position : p.cells) {
+            if (!grid.erase(position, {proxy, p.filter}))
+                throw Exception("Remove in Spacial Hash but no element");
+            erases++;
+        }
+        p = Proxy{};
+        freeProxies.push_back(proxy);
+    }
+
+    /**
+     * Update a collider after its form changed. Only the cells entered or left
+     * are updated, a collider that stays in the same cells does not touch the
+     * grid.
+     */
+    void move(uint32_t proxy, const Form &form) {
+        if constexpr (HasPackedForms<Form>)
+            packedForms.set(proxy, form);
+
+        Proxy &p = proxies[proxy];
+        const auto &cells = form.rasterize();
+        if (cells == p.cells)
+            return;
+
+        const Entry entry{proxy, p.filter};
+
+        for (const auto &position : p.cells) {
+            if (cells.contains(position))
+                continue;
+            if (!grid.erase(position, entry))
+                throw Exception(
+                    std::string("erase ") + typeid(*p.collider).name() +
+                    " in dynamic Spacial Hash but element does not exist");
+            erases++;
+        }
+
+        for (const auto &position : cells) {
+            if (p.cells.contains(position))
+                continue;
+            if (!grid.insert(position, entry))
+                throw Exception(
+                    std::string("insert ") + typeid(*p.collider).name() +
+                    " in dynamic Spacial Hash but element already exist");
+            inserts++;
+        }
+
+        p.cells = cells;
+    }
+
+    /**
+     * Call f(collider) for every collider sharing a cell with form. A collider
+     * is reported once per shared cell.
+     */
+    template<class U, class F>
+    void query(const U &form, F &&f) const {
+        for (const Vec2<int32_t> &position : form.rasterize())
+            for (const Entry &entry : grid[position])
+                f(proxies[entry.proxy].collider);
+    }
+
+    /**
+     * Call f(collider) for every collider accepted by filter and overlapping
+     * form, once per shared cell. The batch kernels are used when they exist
+     * for U and Form, otherwise narrow(collider) tells if the collider
+     * overlaps form.
+     * @return the cells read and the candidates tested
+     */
+    template<class U, class Narrow, class F>
+    QueryCounters overlap(const U &form,
+                          const CollisionFilter &filter,
+                          Narrow &&narrow,
+                          F &&f) const {
+        QueryCounters counters;
+        if constexpr (requires(std::span<const uint32_t> c, uint32_t *h) {
+                          overlapBatch(form, packedForms, c, h);
+                      }) {
+            // the candidates of several cells are tested together, so the
+            // kernels see full vectors even when the cells are almost empty
+            constexpr size_t chunkSize = 64;
+            uint32_t candidates[chunkSize];
+            uint32_t hits[chunkSize];
+            size_t size = 0;
+            auto flush = [&]() {
+                size_t count = overlapBatch(
+                    form, packedForms, std::span(candidates, size), hits);
+                for (size_t i = 0; i < count; i++)
+                    f(proxies[hits[i]].collider);
+                counters.tests += size;
+                size = 0;
+            };
+            for (const Vec2<int32_t> &position : form.rasterize()) {
+                counters.cells++;
+                for (const Entry &entry : grid[position]) {
+                    if (!filter.accepts(entry.filter))
+                        continue;
+                    candidates[size++] = entry.proxy;
+                    if (size == chunkSize)
+                        flush();
+                }
+            }
+            if (size)
+                flush();
+        } else
+            for (const Vec2<int32_t> &position : form.rasterize()) {
+                counters.cells++;
+                for (const Entry &entry : grid[position]) {
+                    if (!filter.accepts(entry.filter))
+                        continue;
+                    counters.tests++;
+                    if (narrow(proxies[entry.proxy].collider))
+                        f(proxies[entry.proxy].collider);
+                }
+            }
+        return counters;
+    }
+
+    /**
+     * Call f(collider) for every collider accepted by filter in the cells
+     * crossed by the ray, cell after cell from origin. f returns the distance
+     * up to which colliders are still wanted, the traversal stops at the first
+     * cell beyond it.
+     * @param direction normalized
+     */
+    template<class F>
+    void raycast(const Vec2<> &origin,
+                 const Vec2<> &direction,
+                 float maxDistance,
+                 const CollisionFilter &filter,
+                 F &&f) const {
+        const float length = maxDistance;
+        const GridTraversal cells{origin, origin + direction * length};
+        for (auto it = cells.begin(); it != cells.end(); ++it) {
+            for (const Entry &entry : grid[*it])
+                if (filter.accepts(entry.filter))
+                    maxDistance = f(proxies[entry.proxy].collider);
+            if (it.exitTime() * length >= maxDistance)
+                return;
+        }
+    }
+
+    /**
+     * Call f(collider) for every collider accepted by filter in the cells
+     * around origin, ring after ring, see CellRings. f returns the distance up
+     * to which colliders are still wanted, the walk stops at the first ring
+     * beyond it. A collider is reported once per cell.
+     */
+    template<class F>
+    void nearest(const Vec2<> &origin,
+                 float maxDistance,
+                 const CollisionFilter &filter,
+                 F &&f) const {
+        auto visit = [&](std::span<const Entry> entries) {
+            for (const Entry &entry : entries)
+                if (filter.accepts(entry.filter))
+                    maxDistance = f(proxies[entry.proxy].collider);
+        };
+
+        const CellRings rings{origin};
+        size_t visited = 0;
+        int32_t ring = 0;
+        for (; rings.distance(ring) <= maxDistance; ring++) {
+            // rings larger than the grid look up more cells than it has
+            visited += CellRings::size(ring);
+            if (visited > grid.cellCount())
+                break;
+            rings.forEach(
+                ring, [&](const Vec2<int32_t> &cell) { visit(grid[cell]); });
+        }
+        if (rings.distance(ring) > maxDistance)
+            return;
+        grid.forEach([&](const Vec2<int32_t> &cell,
+                         std::span<const Entry> entries) {
+            if (rings.ringOf(cell) >= ring &&
+                rings.distance(cell) <= maxDistance)
+                visit(entries);
+        });
+    }
+
+    /**
+     * Call f(collider) once for every collider
+     */
+    template<class F>
+    void forEach(F &&f) const {
+        for (const Proxy &p : proxies)
+            if (p.collider)
+                f(p.collider);
+    }
+
+    /**
+     * Call f(position, colliders) for every non empty cell
+     */
+    template<class F>
+    void forEachCell(F &&f) const {
+        grid.forEach(f);
+    }
+
+    GridBroadPhaseStatistics statistics() const {
+        return {grid.occupiedCount(),
+                (size_t) (inserts - erases),
+                inserts,
+                erases};
+    }
+};
+
+} // namespace Blob
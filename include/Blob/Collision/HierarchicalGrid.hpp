@@ -0,0 +1,284 @@
+#pragma once
+
+#include <Blob/Collision/Forms.hpp>
+#include <Blob/Collision/SpacialGrid.hpp>
+#include <Blob/Core/Exception.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Blob {
+
+/**
+ * Cell sizes of a HierarchicalGrid: level i has cells of
+ * finestCellSize * levelRatio^i world units.
+ */
+struct HierarchicalGridConfig {
+    float finestCellSize = 0.5f;
+    float levelRatio = 4.f;
+    unsigned levelCount = 4;
+};
+
+struct HierarchicalGridStatistics {
+    struct Level {
+        float cellSize = 0;
+        // colliders stored in the level
+        size_t colliders = 0;
+        // non empty cells
+        size_t cells = 0;
+        // collider references in the cells, colliders * cells per collider
+        size_t entries = 0;
+
+        float occupancy() const {
+            return cells == 0 ? 0.f : (float) entries / (float) cells;
+        }
+    };
+    std::vector<Level> levels;
+    uint64_t queries = 0;
+    // colliders reported by the queries, before the narrow phase
+    uint64_t candidates = 0;
+
+    float averageCandidates() const {
+        return queries == 0 ? 0.f : (float) candidates / (float) queries;
+    }
+};
+
+/**
+ * Broad phase made of several grids of increasing cell size. A collider is
+ * stored in the finest level whose cells are at least as large as its bounds,
+ * so it covers at most 2x2 cells whatever its size. A query walks the non
+ * empty levels from coarse to fine.
+ * @tparam Collider the type of collider stored
+ * @tparam Form the form of the colliders
+ */
+template<class Collider, class Form>
+class HierarchicalGrid {
+private:
+    struct Level {
+        float cellSize;
+        SpacialGrid<Collider *> grid;
+        size_t colliders = 0;
+    };
+
+    struct Proxy {
+        Collider *collider = nullptr;
+        Box box;
+        uint32_t level = 0;
+        CellRange cells;
+    };
+
+    HierarchicalGridConfig config;
+    std::vector<Level> levels;
+    std::vector<Proxy> proxies;
+    std::vector<uint32_t> freeProxies;
+
+    mutable std::atomic<uint64_t> queries = 0;
+    mutable std::atomic<uint64_t> candidates = 0;
+
+    void buildLevels() {
+        if (config.finestCellSize <= 0 || config.levelRatio <= 1 ||
+            config.levelCount == 0)
+            throw Exception("Invalid HierarchicalGrid configuration");
+        levels.clear();
+        float cellSize = config.finestCellSize;
+        for (unsigned i = 0; i < config.levelCount; i++) {
+            levels.emplace_back().cellSize = cellSize;
+            cellSize *= config.levelRatio;
+        }
+    }
+
+    uint32_t levelOf(const Box &box) const {
+        float extent = std::max(box.max.x - box.min.x, box.max.y - box.min.y);
+        uint32_t level = 0;
+        while (level + 1 < levels.size() && levels[level].cellSize < extent)
+            level++;
+        return level;
+    }
+
+    CellRange cellsOf(const Box &box, uint32_t level) const {
+        const float cellSize = levels[level].cellSize;
+        return {{(int32_t) std::floor(box.min.x / cellSize),
+                 (int32_t) std::floor(box.min.y / cellSize)},
+                {(int32_t) std::floor(box.max.x / cellSize),
+                 (int32_t) std::floor(box.max.y / cellSize)}};
+    }
+
+    void insertCells(const Proxy &p) {
+        for (const auto &position : p.cells)
+            if (!levels[p.level].grid.insert(position, p.collider))
+                throw Exception(
+                    "Insertion in Spacial Hash but element already exist");
+        levels[p.level].colliders++;
+    }
+
+    void eraseCells(const Proxy &p) {
+        for (const auto &position : p.cells)
+            if (!levels[p.level].grid.erase(position, p.collider))
+                throw Exception("Remove in Spacial Hash but no element");
+        levels[p.level].colliders--;
+    }
+
+public:
+    HierarchicalGrid() { buildLevels(); }
+
+    /**
+     * Change the levels, every collider is inserted again
+     */
+    void configure(const HierarchicalGridConfig &newConfig) {
+        config = newConfig;
+        buildLevels();
+        for (Proxy &p : proxies) {
+            if (!p.collider)
+                continue;
+            p.level = levelOf(p.box);
+            p.cells = cellsOf(p.box, p.level);
+            insertCells(p);
+        }
+    }
+
+    const HierarchicalGridConfig &getConfig() const { return config; }
+
+    /**
+     * Add a collider with its current form
+     * @return the proxy identifying the collider in this broad phase
+     */
+    uint32_t insert(Collider *collider, const Form &form) {
+        uint32_t proxy;
+        if (freeProxies.empty()) {
+            proxy = (uint32_t) proxies.size();
+            proxies.emplace_back();
+        } else {
+            proxy = freeProxies.back();
+            freeProxies.pop_back();
+        }
+        Proxy &p = proxies[proxy];
+        p.collider = collider;
+        p.box = form.bounds();
+        p.level = levelOf(p.box);
+        p.cells = cellsOf(p.box, p.level);
+        insertCells(p);
+        return proxy;
+    }
+
+    void erase(uint32_t proxy) {
+        eraseCells(proxies[proxy]);
+        proxies[proxy] = Proxy{};
+        freeProxies.push_back(proxy);
+    }
+
+    /**
+     * Update a collider after its form changed. Only the cells entered or left
+     * are updated when the collider stays in the same level.
+     */
+    void move(uint32_t proxy, const Form &form) {
+        Proxy &p = proxies[proxy];
+        p.box = form.bounds();
+        const uint32_t level = levelOf(p.box);
+        const CellRange cells = cellsOf(p.box, level);
+        if (level == p.level && cells == p.cells)
+            return;
+
+        if (level != p.level) {
+            eraseCells(p);
+            p.level = level;
+            p.cells = cells;
+            insertCells(p);
+            return;
+        }
+
+        auto &grid = levels[level].grid;
+        for (const auto &position : p.cells)
+            if (!cells.contains(position) && !grid.erase(position, p.collider))
+                throw Exception("Remove in Spacial Hash but no element");
+        for (const auto &position : cells)
+            if (!p.cells.contains(position) &&
+                !grid.insert(position, p.collider))
+                throw Exception(
+                    "Insertion in Spacial Hash but element already exist");
+        p.cells = cells;
+    }
+
+    /**
+     * Call f(collider) for every collider sharing a cell with the bounds of
+     * form. A collider is reported once per shared cell.
+     */
+    template<class U, class F>
+    void query(const U &form, F &&f) const {
+        const Box box = form.bounds();
+        uint64_t found = 0;
+        for (uint32_t level = (uint32_t) levels.size(); level-- > 0;) {
+            if (levels[level].colliders == 0)
+                continue;
+            const auto &grid = levels[level].grid;
+            const CellRange cells = cellsOf(box, level);
+            // a box larger than the level looks up more cells than it has
+            if (cells.size() > grid.cellCount()) {
+                grid.forEach([&](const Vec2<int32_t> &position,
+                                 std::span<Collider *const> colliders) {
+                    if (!cells.contains(position))
+                        return;
+                    found += colliders.size();
+                    for (Collider *collider : colliders)
+                        f(collider);
+                });
+                continue;
+            }
+            for (const auto &position : cells) {
+                for (Collider *collider : grid[position]) {
+                    found++;
+                    f(collider);
+                }
+            }
+        }
+        queries.fetch_add(1, std::memory_order_relaxed);
+        candidates.fetch_add(found, std::memory_order_relaxed);
+    }
+
+    /**
+     * Call f(collider) once for every collider
+     */
+    template<class F>
+    void forEach(F &&f) const {
+        for (const Proxy &p : proxies)
+            if (p.collider)
+                f(p.collider);
+    }
+
+    /**
+     * Call f(box) for every non empty cell of every level
+     */
+    template<class F>
+    void forEachBox(F &&f) const {
+        for (const Level &level : levels)
+            level.grid.forEach([&](const Vec2<int32_t> &position, auto) {
+                const Vec2<> min = position.cast<float>() * level.cellSize;
+                f(Box{min, min + level.cellSize});
+            });
+    }
+
+    HierarchicalGridStatistics statistics() const {
+        HierarchicalGridStatistics statistics;
+        for (const Level &level : levels) {
+            auto &s = statistics.levels.emplace_back();
+            s.cellSize = level.cellSize;
+            s.colliders = level.colliders;
+            level.grid.forEach([&](const Vec2<int32_t> &, auto colliders) {
+                s.cells++;
+                s.entries += colliders.size();
+            });
+        }
+        statistics.queries = queries.load(std::memory_order_relaxed);
+        statistics.candidates = candidates.load(std::memory_order_relaxed);
+        return statistics;
+    }
+
+    void resetStatistics() {
+        queries = 0;
+        candidates = 0;
+    }
+};
+
+} // namespace Blob
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <Blob/Collision/Forms.hpp>
+#include <Blob/Collision/ThreadPool.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Blob {
+
+/**
+ * Walkable cells of an area and the HPA* abstraction over them, to find
+ * paths without searching every cell. The cells are grouped in square
+ * clusters. The nodes of the abstract graph are the cells where a path can
+ * cross from a cluster to the next, with the distances between the nodes of
+ * each cluster computed when the cluster is built. A search runs A* on the
+ * nodes, then on the cells of each cluster crossed by the path. Cells in
+ * touching clusters are joined by A* on the cells of both clusters.
+ *
+ * The agents move to the 8 neighbour cells, diagonally only when both cells
+ * beside the move are walkable. The paths found are usually a few percent
+ * longer than the shortest ones, since they cross the borders of the clusters
+ * at the nodes.
+ */
+class NavigationGrid {
+    friend class FlowField;
+
+public:
+    /**
+     * @return true if an agent cannot stand in the cell, given by its square
+     */
+    typedef std::function<bool(const Rectangle &)> BlockedTest;
+
+    /**
+     * Memory of the path searches, reused from one search to the next. Keep
+     * one per thread.
+     */
+    class Search {
+        friend class NavigationGrid;
+
+    private:
+        struct Visit {
+            float cost;
+            uint32_t parent;
+            bool closed;
+        };
+
+        // searches in a cluster, indexed by cell of the cluster
+        std::vector<float> distances;
+        std::vector<uint32_t> parents;
+        std::vector<std::pair<float, uint32_t>> heap;
+        // A* on the abstract graph, by cell
+        std::unordered_map<uint32_t, Visit> visits;
+        std::vector<float> startCosts, goalCosts;
+        // nodes then cells of the path found
+        std::vector<uint32_t> nodes, cells;
+    };
+
+private:
+    struct Cluster {
+        // cells where paths enter and leave the cluster
+        std::vector<uint32_t> nodes;
+        // node index and cell across the border of the cluster
+        std::vector<std::pair<uint32_t, uint32_t>> links;
+        // distance between each pair of nodes inside the cluster, infinity
+        // if none
+        std::vector<float> distances;
+    };
+
+    // cells covering a cluster, inclusive
+    struct CellRect {
+        int32_t x0, y0, x1, y1;
+    };
+
+    Vec2<> origin;
+    float cellSize;
+    int32_t width, height;
+    int32_t clusterSize;
+    int32_t clustersX, clustersY;
+
+    std::vector<uint8_t> blocked;
+    // cells joined by a path have the same component, 0 for blocked cells,
+    // to answer at once when there is no path
+    std::vector<uint32_t> components;
+    std::vector<Cluster> clusters;
+
+    uint32_t index(int32_t x, int32_t y) const {
+        return (uint32_t) (y * width + x);
+    }
+
+    bool walkable(int32_t x, int32_t y) const {
+        return x >= 0 && y >= 0 && x < width && y < height &&
+               !blocked[index(x, y)];
+    }
+
+    uint32_t clusterOf(uint32_t cell) const {
+        const int32_t x = (int32_t) cell % width, y = (int32_t) cell / width;
+        return (uint32_t) ((y / clusterSize) * clustersX + x / clusterSize);
+    }
+
+    CellRect cellsOf(uint32_t cluster) const;
+
+    Rectangle square(int32_t x, int32_t y) const;
+
+    // @return true if a cell changed
+    bool rasterize(const CellRect &cells, const BlockedTest &test);
+
+    // transitions of the border between two clusters side by side, as pairs
+    // of cells, the first in cluster a
+    void findTransitions(
+        uint32_t a,
+        uint32_t b,
+        std::vector<std::pair<uint32_t, uint32_t>> &transitions) const;
+
+    void buildCluster(uint32_t cluster, Search &search);
+
+    void findComponents();
+
+    // distances from cell to the cells of a cluster, in search.distances
+    void dijkstra(const CellRect &cells, uint32_t cell, Search &search) const;
+
+    // append the cells of a shortest path from a to b inside a cluster,
+    // without a
+    void refine(const CellRect &cells,
+                uint32_t a,
+                uint32_t b,
+                std::vector<uint32_t> &path,
+                Search &search) const;
+
+    float heuristic(uint32_t a, uint32_t b) const;
+
+public:
+    /**
+     * @param area covered by the cells, the first one at area.min
+     * @param cellSize side of the square cells
+     * @param clusterSize side of a cluster in cells
+     */
+    NavigationGrid(const Box &area, float cellSize, uint32_t clusterSize = 16);
+
+    /**
+     * Test every cell and build every cluster, on the threads of threadPool
+     * if any
+     */
+    void build(const BlockedTest &test, ThreadPool *threadPool = nullptr);
+
+    /**
+     * Test again the cells overlapping areas, then rebuild the clusters where
+     * a cell changed and their neighbours
+     * @param areas where the test may have changed, grown by the margin the
+     * test adds around the cells
+     */
+    void repair(std::span<const Box> areas, const BlockedTest &test);
+
+    /**
+     * Find a path between two points, for instance from several threads with
+     * a Search each, as long as the grid does not change meanwhile
+     * @param path replaced by the centers of the cells from the cell of from
+     * to the cell of to
+     * @return false if a point is on a blocked cell or out of the area, or if
+     * no path joins them
+     */
+    bool findPath(const Vec2<> &from,
+                  const Vec2<> &to,
+                  std::vector<Vec2<>> &path,
+                  Search &search) const;
+
+    /**
+     * @return the cell containing point, possibly out of the grid
+     */
+    Vec2<int32_t> cellAt(const Vec2<> &point) const;
+
+    Vec2<> centerOf(const Vec2<int32_t> &cell) const;
+
+    bool isWalkable(const Vec2<int32_t> &cell) const {
+        return walkable(cell.x, cell.y);
+    }
+
+    Vec2<int32_t> size() const { return {width, height}; }
+
+    /**
+     * @return the number of nodes of the abstract graph
+     */
+    size_t nodeCount() const;
+};
+
+} // namespace Blob
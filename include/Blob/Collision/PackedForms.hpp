@@ -0,0 +1,196 @@
+#pragma once
+
+#include <Blob/Collision/Forms.hpp>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Blob {
+
+/**
+ * Forms stored as structure of arrays, indexed by broad phase proxy, so the
+ * narrow phase of a cell reads a few dense float arrays instead of following
+ * a pointer per collider. Only defined for the forms with batch kernels.
+ */
+template<class Form>
+struct PackedForms;
+
+template<class Form>
+concept HasPackedForms = requires { sizeof(PackedForms<Form>); };
+
+template<>
+struct PackedForms<Circle> {
+    std::vector<float> x, y, rayon;
+
+    void set(uint32_t index, const Circle &circle) {
+        if (index >= x.size()) {
+            x.resize(index + 1);
+            y.resize(index + 1);
+            rayon.resize(index + 1);
+        }
+        x[index] = circle.position.x;
+        y[index] = circle.position.y;
+        rayon[index] = circle.rayon;
+    }
+
+    Circle operator[](uint32_t index) const {
+        return {Point{x[index], y[index]}, rayon[index]};
+    }
+};
+
+template<>
+struct PackedForms<Rectangle> {
+    std::vector<float> x, y, width, height;
+
+    void set(uint32_t index, const Rectangle &rectangle) {
+        if (index >= x.size()) {
+            x.resize(index + 1);
+            y.resize(index + 1);
+            width.resize(index + 1);
+            height.resize(index + 1);
+        }
+        x[index] = rectangle.position.x;
+        y[index] = rectangle.position.y;
+        width[index] = rectangle.size.x;
+        height[index] = rectangle.size.y;
+    }
+
+    Rectangle operator[](uint32_t index) const {
+        return {Vec2<>{x[index], y[index]},
+                Vec2<>{width[index], height[index]}};
+    }
+};
+
+template<>
+struct PackedForms<Point> {
+    std::vector<float> x, y;
+
+    void set(uint32_t index, const Point &point) {
+        if (index >= x.size()) {
+            x.resize(index + 1);
+            y.resize(index + 1);
+        }
+        x[index] = point.x;
+        y[index] = point.y;
+    }
+
+    Point operator[](uint32_t index) const {
+        return Vec2<>{x[index], y[index]};
+    }
+};
+
+template<>
+struct PackedForms<Line> {
+    std::vector<float> ax, ay, bx, by;
+
+    void set(uint32_t index, const Line &line) {
+        if (index >= ax.size()) {
+            ax.resize(index + 1);
+            ay.resize(index + 1);
+            bx.resize(index + 1);
+            by.resize(index + 1);
+        }
+        ax[index] = line.positionA.x;
+        ay[index] = line.positionA.y;
+        bx[index] = line.positionB.x;
+        by[index] = line.positionB.y;
+    }
+
+    Line operator[](uint32_t index) const {
+        Vec2<> a{ax[index], ay[index]}, b{bx[index], by[index]};
+        return {a, b};
+    }
+};
+
+/**
+ * Batch narrow phase: test form against the packed forms of candidates, with
+ * the same result as form.overlap(forms[candidate]).
+ *
+ * SSE2 is used on x86, AVX2 when the library is built with it (option
+ * BLOB_COLLISION_AVX2), scalar code otherwise.
+ * @param candidates indices in forms
+ * @param hits receives the candidates overlapping form, must have room for
+ * candidates.size() values
+ * @return the number of hits
+ * @{
+ */
+size_t overlapBatch(const Circle &form,
+                    const PackedForms<Circle> &forms,
+                    std::span<const uint32_t> candidates,
+                    uint32_t *hits);
+
+size_t overlapBatch(const Circle &form,
+                    const PackedForms<Rectangle> &forms,
+                    std::span<const uint32_t> candidates,
+                    uint32_t *hits);
+
+size_t overlapBatch(const Circle &form,
+                    const PackedForms<Point> &forms,
+                    std::span<const uint32_t> candidates,
+                    uint32_t *hits);
+
+size_t overlapBatch(const Rectangle &form,
+                    const PackedForms<Circle> &forms,
+                    std::span<const uint32_t> candidates,
+                    uint32_t *hits);
+
+size_t overlapBatch(const Rectangle &form,
+                    const PackedForms<Rectangle> &forms,
+                    std::span<const uint32_t> candidates,
+                    uint32_t *hits);
+
+size_t overlapBatch(const Rectangle &form,
+                    const PackedForms<Point> &forms,
+                    std::span<const uint32_t> candidates,
+                    uint32_t *hits);
+
+size_t overlapBatch(const Point &form,
+                    const PackedForms<Circle> &forms,
+                    std::span<const uint32_t> candidates,
+                    uint32_t *hits);
+
+size_t overlapBatch(const Point &form,
+                    const PackedForms<Rectangle> &forms,
+                    std::span<const uint32_t> candidates,
+                    uint32_t *hits);
+/** @} */
+
+/**
+ * Batch collision resolution, for instance of the contacts of every collider
+ * in one pass after the update: results[i] is
+ * movers[moverIndices[i]].resolve(targets[targetIndices[i]],
+ * destinations[moverIndices[i]]).
+ *
+ * The kernels run the operations of the scalar resolve in the same order on
+ * 4 or 8 pairs at a time, see overlapBatch, so they give the same results
+ * unless the compiler fuses the scalar multiplications and additions.
+ * @param destinations where each mover goes, indexed like movers
+ * @param moverIndices indices in movers, one per pair
+ * @param targetIndices indices in targets, as many as moverIndices
+ * @param results must have room for one resolution per pair
+ * @{
+ */
+void resolveBatch(const PackedForms<Circle> &movers,
+                  const PackedForms<Point> &destinations,
+                  const PackedForms<Circle> &targets,
+                  std::span<const uint32_t> moverIndices,
+                  std::span<const uint32_t> targetIndices,
+                  CollisionResolution *results);
+
+void resolveBatch(const PackedForms<Circle> &movers,
+                  const PackedForms<Point> &destinations,
+                  const PackedForms<Line> &targets,
+                  std::span<const uint32_t> moverIndices,
+                  std::span<const uint32_t> targetIndices,
+                  CollisionResolution *results);
+
+void resolveBatch(const PackedForms<Rectangle> &movers,
+                  const PackedForms<Point> &destinations,
+                  const PackedForms<Rectangle> &targets,
+                  std::span<const uint32_t> moverIndices,
+                  std::span<const uint32_t> targetIndices,
+                  CollisionResolution *results);
+/** @} */
+
+} // namespace Blob
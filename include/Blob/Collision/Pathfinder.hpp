@@ -0,0 +1,308 @@
+#pragma once
+
+#include <Blob/Collision/CollisionDetector.hpp>
+#include <Blob/Collision/FlowField.hpp>
+#include <Blob/Collision/NavigationGrid.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Blob {
+
+/**
+ * Path found by BasicPathfinder for a request
+ */
+struct PathResult {
+    // returned by BasicPathfinder::request
+    uint64_t request = 0;
+    bool found = false;
+    // centers of the cells from the start to the goal, see
+    // NavigationGrid::findPath
+    std::vector<Vec2<>> points;
+};
+
+/**
+ * Pathfinding service over the static colliders of a collision detector.
+ * The walkable cells of a NavigationGrid are the cells where the static
+ * colliders leave room for an agent, and they are tested again when the
+ * static colliders change. The paths are searched by worker threads, in
+ * batches taken from a queue, so any thread can request many paths per
+ * frame and collect them later. Crowds heading to the same goal share a
+ * FlowField instead, kept up to date with the grid.
+ *
+ * The detector must outlive the pathfinder.
+ */
+template<class Policy, class... Types>
+class BasicPathfinder : public StaticListener {
+private:
+    struct Request {
+        uint64_t id;
+        Vec2<> from, to;
+    };
+
+    // requests taken by a worker at once
+    static constexpr size_t batchSize = 64;
+
+    BasicCollisionDetector<Policy, Types...> &collisionDetector;
+    const float clearance;
+    const CollisionFilter filter;
+    NavigationGrid grid;
+    // bounds of the static colliders changed since the last update()
+    std::vector<Box> changes;
+    // builds the grid and the flow fields, if more than one thread
+    std::unique_ptr<ThreadPool> threadPool;
+    // rebuilt in place by update(), dropped by it once only held here
+    std::vector<std::shared_ptr<FlowField>> flowFields;
+
+    // the workers read the grid, update() repairs it
+    mutable std::shared_mutex gridMutex;
+
+    // shared with the workers
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workDone;
+    std::deque<Request> requests;
+    std::vector<PathResult> results;
+    uint64_t nextRequest = 1;
+    unsigned busyWorkers = 0;
+    std::exception_ptr exception;
+    bool stop = false;
+
+    std::vector<std::thread> workers;
+
+    bool blocked(const Rectangle &cell) const {
+        // slightly smaller than the cell, a collider only touching its sides
+        // leaves it walkable
+        const Rectangle agent{cell.position,
+                              cell.size * 0.999f + clearance * 2};
+        return collisionDetector.testStaticCollision(agent, filter);
+    }
+
+    void work() {
+        NavigationGrid::Search search;
+        std::vector<Request> batch;
+        std::vector<PathResult> found;
+        std::unique_lock lock(mutex);
+        while (true) {
+            workAvailable.wait(lock, [&] { return stop || !requests.empty(); });
+            if (stop)
+                return;
+
+            const size_t count = std::min(requests.size(), batchSize);
+            batch.assign(requests.begin(), requests.begin() + count);
+            requests.erase(requests.begin(), requests.begin() + count);
+            busyWorkers++;
+            lock.unlock();
+
+            std::exception_ptr error;
+            found.resize(count);
+            try {
+                std::shared_lock gridLock(gridMutex);
+                for (size_t i = 0; i < count; i++) {
+                    found[i].request = batch[i].id;
+                    found[i].found = grid.findPath(
+                        batch[i].from, batch[i].to, found[i].points, search);
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            lock.lock();
+            busyWorkers--;
+            if (error) {
+                if (!exception)
+                    exception = error;
+            } else
+                for (PathResult &result : found)
+                    results.push_back(std::move(result));
+            workDone.notify_all();
+        }
+    }
+
+public:
+    /**
+     * Build the navigation grid from the static colliders already enabled
+     * @param area covered by the grid
+     * @param cellSize side of the cells, about the size of the agents
+     * @param clearance distance the agents keep from the static colliders,
+     * their rayon for instance
+     * @param threadCount number of worker threads, at least 1. The grid and
+     * the flow fields are built on as many threads.
+     * @param filter layers of the static colliders that block the agents
+     */
+    BasicPathfinder(BasicCollisionDetector<Policy, Types...> &detector,
+                    const Box &area,
+                    float cellSize,
+                    float clearance,
+                    unsigned threadCount,
+                    const CollisionFilter &filter = CollisionFilter::all()) :
+        collisionDetector(detector),
+        clearance(clearance),
+        filter(filter),
+        grid(area, cellSize) {
+        threadCount = std::max(threadCount, 1u);
+        auto test = [&](const Rectangle &cell) { return blocked(cell); };
+        if (threadCount > 1)
+            threadPool = std::make_unique<ThreadPool>(threadCount);
+        grid.build(test, threadPool.get());
+        collisionDetector.addStaticListener(*this);
+        for (unsigned i = 0; i < threadCount; i++)
+            workers.emplace_back(&BasicPathfinder::work, this);
+    }
+
+    BasicPathfinder(const BasicPathfinder &) = delete;
+
+    BasicPathfinder(BasicPathfinder &&) = delete;
+
+    ~BasicPathfinder() override {
+        {
+            std::lock_guard lock(mutex);
+            stop = true;
+        }
+        workAvailable.notify_all();
+        for (std::thread &worker : workers)
+            worker.join();
+        collisionDetector.removeStaticListener(*this);
+    }
+
+    void staticChanged(const Box &bounds) override {
+        changes.push_back(bounds.expand(clearance));
+    }
+
+    /**
+     * Queue a path search, from any thread
+     * @return the id of the request, found in PathResult::request
+     */
+    uint64_t request(const Vec2<> &from, const Vec2<> &to) {
+        uint64_t id;
+        {
+            std::lock_guard lock(mutex);
+            id = nextRequest++;
+            requests.push_back({id, from, to});
+        }
+        workAvailable.notify_one();
+        return id;
+    }
+
+    /**
+     * Repair the grid where the static colliders changed since the last
+     * call, once the paths being searched are found, and rebuild the flow
+     * fields over the changes. The flow fields only held by the pathfinder
+     * are dropped first. Call it between two detector updates, for
+     * instance every frame. The requests queued before may be answered with
+     * the old grid. An exception thrown by a worker is rethrown here.
+     */
+    void update() {
+        std::erase_if(flowFields, [](const std::shared_ptr<FlowField> &field) {
+            return field.use_count() == 1;
+        });
+        if (!changes.empty()) {
+            {
+                std::unique_lock gridLock(gridMutex);
+                grid.repair(changes, [&](const Rectangle &cell) {
+                    return blocked(cell);
+                });
+            }
+            for (const std::shared_ptr<FlowField> &field : flowFields) {
+                const Box region = field->getRegion();
+                if (std::any_of(changes.begin(),
+                                changes.end(),
+                                [&](const Box &box) {
+                                    return box.overlap(region);
+                                }))
+                    field->build(grid, threadPool.get());
+            }
+            changes.clear();
+        }
+
+        std::exception_ptr error;
+        {
+            std::lock_guard lock(mutex);
+            std::swap(error, exception);
+        }
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    /**
+     * Move the paths found since the last call to paths, in no particular
+     * order
+     * @return the number of paths added
+     */
+    size_t takePaths(std::vector<PathResult> &paths) {
+        std::lock_guard lock(mutex);
+        const size_t count = results.size();
+        for (PathResult &result : results)
+            paths.push_back(std::move(result));
+        results.clear();
+        return count;
+    }
+
+    /**
+     * Search a path on the calling thread, see NavigationGrid::findPath
+     */
+    bool findPath(const Vec2<> &from,
+                  const Vec2<> &to,
+                  std::vector<Vec2<>> &path) const {
+        NavigationGrid::Search search;
+        std::shared_lock gridLock(gridMutex);
+        return grid.findPath(from, to, path, search);
+    }
+
+    /**
+     * Get the flow field toward goal, built on the first call for this goal
+     * cell and region, and shared by the callers asking for the same one.
+     * update() rebuilds it in place, so the agents can keep it and sample it
+     * every frame, for instance in preCollisionUpdate. update() drops it once
+     * nobody else holds it. Call it from the thread calling update().
+     * @param region where the agents follow the field, see FlowField
+     */
+    std::shared_ptr<const FlowField> flowField(const Vec2<> &goal,
+                                               const Box &region) {
+        auto field = std::make_shared<FlowField>(grid, goal, region);
+        const Box bounds = field->getRegion();
+        for (const std::shared_ptr<FlowField> &cached : flowFields)
+            if (cached->getGoal() == field->getGoal() &&
+                cached->getRegion().min == bounds.min &&
+                cached->getRegion().max == bounds.max)
+                return cached;
+        field->build(grid, threadPool.get());
+        flowFields.push_back(field);
+        return field;
+    }
+
+    /**
+     * Wait for the queued requests to be answered. For loading screens and
+     * tests.
+     */
+    void waitIdle() {
+        std::unique_lock lock(mutex);
+        workDone.wait(lock,
+                      [&] { return requests.empty() && busyWorkers == 0; });
+    }
+
+    /**
+     * @return the grid, to read while no update() runs
+     */
+    const NavigationGrid &getGrid() const { return grid; }
+};
+
+typedef BasicPathfinder<GridPolicy,
+                        Circle,
+                        Rectangle,
+                        Point,
+                        Line,
+                        Polygon,
+                        RasterArea>
+    Pathfinder;
+
+} // namespace Blob
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <Blob/Maths.inl>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace Blob {
+
+/**
+ * Spacial hash storing values per integer cell.
+ *
+ * The cell positions live in a flat open-addressing table (linear probing), so
+ * a lookup only walks a contiguous array of Vec2<int32_t>. Each cell owns a
+ * contiguous slot array. A cell that becomes empty keeps its slot array and
+ * its place in the table, so an object moving back and forth between cells
+ * does not allocate. Empty cells are dropped when the table is rebuilt.
+ * @tparam V the value stored in the cells, must be cheap to copy and compare
+ */
+template<class V>
+class SpacialGrid {
+private:
+    static constexpr Vec2<int32_t> emptyKey{
+        std::numeric_limits<int32_t>::min(),
+        std::numeric_limits<int32_t>::min()};
+
+    std::vector<Vec2<int32_t>> keys;
+    std::vector<std::vector<V>> slots;
+    size_t usedCells = 0;
+    // cells holding at least a value
+    size_t occupiedCells = 0;
+    size_t shift = 64;
+
+    size_t indexOf(const Vec2<int32_t> &position) const {
+        uint64_t key = (uint64_t) (uint32_t) position.x << 32u |
+                       (uint32_t) position.y;
+        // Fibonacci hashing, the high bits are the best mixed
+        return (size_t) ((key * 0x9E3779B97F4A7C15ull) >> shift);
+    }
+
+    void rebuild(size_t capacity) {
+        std::vector<Vec2<int32_t>> oldKeys(capacity, emptyKey);
+        std::vector<std::vector<V>> oldSlots(capacity);
+        std::swap(oldKeys, keys);
+        std::swap(oldSlots, slots);
+
+        shift = 64 - std::countr_zero(capacity);
+        usedCells = 0;
+
+        const size_t mask = keys.size() - 1;
+        for (size_t i = 0; i < oldKeys.size(); i++) {
+            if (oldKeys[i] == emptyKey || oldSlots[i].empty())
+                continue;
+            size_t index = indexOf(oldKeys[i]);
+            while (keys[index] != emptyKey)
+                index = (index + 1) & mask;
+            keys[index] = oldKeys[i];
+            slots[index] = std::move(oldSlots[i]);
+            usedCells++;
+        }
+    }
+
+    std::vector<V> &cell(const Vec2<int32_t> &position) {
+        if (keys.empty())
+            rebuild(64);
+
+        size_t mask = keys.size() - 1;
+        size_t index = indexOf(position);
+        while (keys[index] != emptyKey) {
+            if (keys[index] == position)
+                return slots[index];
+            index = (index + 1) & mask;
+        }
+
+        // Keep the load factor under 1/2. The rebuild drops the empty cells,
+        // so the table only grows if most of them are really occupied.
+        if ((usedCells + 1) * 2 > keys.size()) {
+            size_t capacity = keys.size();
+            while ((occupiedCells + 1) * 4 > capacity)
+                capacity *= 2;
+            rebuild(capacity);
+            mask = keys.size() - 1;
+            index = indexOf(position);
+            while (keys[index] != emptyKey)
+                index = (index + 1) & mask;
+        }
+
+        keys[index] = position;
+        usedCells++;
+        return slots[index];
+    }
+
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    size_t find(const Vec2<int32_t> &position) const {
+        if (keys.empty())
+            return npos;
+
+        const size_t mask = keys.size() - 1;
+        size_t index = indexOf(position);
+        while (keys[index] != emptyKey) {
+            if (keys[index] == position)
+                return index;
+            index = (index + 1) & mask;
+        }
+        return npos;
+    }
+
+public:
+    /**
+     * Add a value in a cell
+     * @return false if the value is already in the cell
+     */
+    bool insert(const Vec2<int32_t> &position, const V &value) {
+        auto &values = cell(position);
+        if (std::find(values.begin(), values.end(), value) != values.end())
+            return false;
+        occupiedCells += values.empty();
+        values.push_back(value);
+        return true;
+    }
+
+    /**
+     * Remove a value from a cell, the order of the cell is not preserved
+     * @return false if the value is not in the cell
+     */
+    bool erase(const Vec2<int32_t> &position, const V &value) {
+        size_t index = find(position);
+        if (index == npos)
+            return false;
+        auto &v = slots[index];
+        auto it = std::find(v.begin(), v.end(), value);
+        if (it == v.end())
+            return false;
+        *it = v.back();
+        v.pop_back();
+        occupiedCells -= v.empty();
+        return true;
+    }
+
+    /**
+     * @return the values stored in a cell, empty if the cell does not exist
+     */
+    std::span<const V> operator[](const Vec2<int32_t> &position) const {
+        size_t index = find(position);
+        if (index == npos)
+            return {};
+        return slots[index];
+    }
+
+    /**
+     * Call f(position, values) for every non empty cell
+     */
+    template<class F>
+    void forEach(F &&f) const {
+        for (size_t i = 0; i < keys.size(); i++)
+            if (keys[i] != emptyKey && !slots[i].empty())
+                f(keys[i], std::span<const V>(slots[i]));
+    }
+
+    /**
+     * @return the number of cells in the table, including the empty ones kept
+     * for reuse
+     */
+    size_t cellCount() const { return usedCells; }
+
+    /**
+     * @return the number of non empty cells
+     */
+    size_t occupiedCount() const { return occupiedCells; }
+
+    void clear() {
+        keys.clear();
+        slots.clear();
+        usedCells = 0;
+        occupiedCells = 0;
+        shift = 64;
+    }
+};
+
+} // namespace Blob
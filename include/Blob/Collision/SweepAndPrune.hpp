@@ -0,0 +1,250 @@
+#pragma once
+
+#include <Blob/Collision/Forms.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Blob {
+
+/**
+ * Broad phase keeping the bounds of the colliders sorted on the x axis. The
+ * order is kept across frames: a moved collider is shifted to its new place by
+ * insertion sort, which costs a few swaps when the colliders move slowly.
+ *
+ * New colliders wait in a small unsorted tail merged into the sorted array
+ * once it is full, and removed colliders leave a hole compacted later, so
+ * enabling or disabling many colliders does not cost O(n) each.
+ *
+ * A query scans the boxes starting less than the largest width before it.
+ * That width is kept exact: the boxes are measured again once the last of
+ * the widest ones shrinks or leaves.
+ *
+ * Besides the queries of the other broad phases, forEachPair sweeps the array
+ * once for all the overlapping pairs: the detector runs it after the moves of
+ * an update, see BasicCollisionDetector::forEachDynamicPair.
+ * @tparam Collider the type of collider stored
+ * @tparam Form the form of the colliders
+ */
+template<class Collider, class Form>
+class SweepAndPrune {
+private:
+    // unsorted entries, and holes, allowed before a rebuild
+    static constexpr uint32_t maxPending = 32;
+    static constexpr uint32_t freeProxy = std::numeric_limits<uint32_t>::max();
+
+    struct Entry {
+        Box box;
+        // nullptr for a hole left by a removed collider
+        Collider *collider;
+        // freeProxy for a hole, the proxy may already be reused
+        uint32_t proxy;
+    };
+
+    // entries[0, sortedCount) are sorted by box.min.x, the others are not
+    std::vector<Entry> entries;
+    size_t sortedCount = 0;
+    size_t holes = 0;
+    // position of each proxy in entries
+    std::vector<uint32_t> positions;
+    std::vector<uint32_t> freeProxies;
+    // largest width of the boxes, and the number of boxes that wide
+    float maxWidth = 0;
+    size_t widest = 0;
+
+    static float width(const Box &box) { return box.max.x - box.min.x; }
+
+    // Find the widest boxes again, after the last one shrank or left
+    void measureWidths() {
+        maxWidth = 0;
+        widest = 0;
+        for (const Entry &entry : entries)
+            if (entry.collider)
+                grow(entry.box);
+    }
+
+    void grow(const Box &box) {
+        if (width(box) > maxWidth) {
+            maxWidth = width(box);
+            widest = 1;
+        } else if (width(box) == maxWidth)
+            widest++;
+    }
+
+    void shrink(const Box &box) {
+        if (width(box) == maxWidth && --widest == 0)
+            measureWidths();
+    }
+
+    static bool lessMinX(const Entry &a, const Entry &b) {
+        return a.box.min.x < b.box.min.x;
+    }
+
+    void swapEntries(size_t a, size_t b) {
+        std::swap(entries[a], entries[b]);
+        if (entries[a].collider)
+            positions[entries[a].proxy] = (uint32_t) a;
+        if (entries[b].collider)
+            positions[entries[b].proxy] = (uint32_t) b;
+    }
+
+    // Merge the tail and drop the holes
+    void rebuild() {
+        auto isHole = [](const Entry &e) { return !e.collider; };
+        const size_t sortedHoles = std::count_if(
+            entries.begin(), entries.begin() + sortedCount, isHole);
+        auto end = std::remove_if(entries.begin(), entries.end(), isHole);
+        // remove_if is stable, the sorted part stays in front
+        auto sortedEnd = entries.begin() + (sortedCount - sortedHoles);
+        std::sort(sortedEnd, end, lessMinX);
+        std::inplace_merge(entries.begin(), sortedEnd, end, lessMinX);
+        entries.erase(end, entries.end());
+
+        sortedCount = entries.size();
+        holes = 0;
+        for (size_t i = 0; i < entries.size(); i++)
+            positions[entries[i].proxy] = (uint32_t) i;
+    }
+
+public:
+    /**
+     * Add a collider with its current form
+     * @return the proxy identifying the collider in this broad phase
+     */
+    uint32_t insert(Collider *collider, const Form &form) {
+        uint32_t proxy;
+        if (freeProxies.empty()) {
+            proxy = (uint32_t) positions.size();
+            positions.push_back(freeProxy);
+        } else {
+            proxy = freeProxies.back();
+            freeProxies.pop_back();
+        }
+
+        const Box box = form.bounds();
+        grow(box);
+        positions[proxy] = (uint32_t) entries.size();
+        entries.push_back({box, collider, proxy});
+
+        if (entries.size() - sortedCount > maxPending)
+            rebuild();
+        return proxy;
+    }
+
+    void erase(uint32_t proxy) {
+        entries[positions[proxy]].collider = nullptr;
+        entries[positions[proxy]].proxy = freeProxy;
+        shrink(entries[positions[proxy]].box);
+        positions[proxy] = freeProxy;
+        freeProxies.push_back(proxy);
+
+        if (++holes > maxPending)
+            rebuild();
+    }
+
+    /**
+     * Update a collider after its form changed, it is shifted to its new place
+     * in the sorted order
+     */
+    void move(uint32_t proxy, const Form &form) {
+        size_t index = positions[proxy];
+        const Box box = form.bounds();
+        const Box previous = entries[index].box;
+        entries[index].box = box;
+        // grow first, the box may stay the widest
+        grow(box);
+        shrink(previous);
+
+        if (index >= sortedCount)
+            return;
+        while (index > 0 && box.min.x < entries[index - 1].box.min.x) {
+            swapEntries(index, index - 1);
+            index--;
+        }
+        while (index + 1 < sortedCount &&
+               entries[index + 1].box.min.x < box.min.x) {
+            swapEntries(index, index + 1);
+            index++;
+        }
+    }
+
+    /**
+     * Call f(collider) once for every collider whose box overlaps the bounds
+     * of form
+     */
+    template<class U, class F>
+    void query(const U &form, F &&f) const {
+        const Box box = form.bounds();
+
+        // every box starting after box.min.x - maxWidth may reach box
+        auto it = std::lower_bound(
+            entries.begin(),
+            entries.begin() + sortedCount,
+            box.min.x - maxWidth,
+            [](const Entry &e, float x) { return e.box.min.x < x; });
+        for (; it != entries.begin() + sortedCount; ++it) {
+            if (it->box.min.x > box.max.x)
+                break;
+            if (it->collider && it->box.overlap(box))
+                f(it->collider);
+        }
+
+        for (size_t i = sortedCount; i < entries.size(); i++)
+            if (entries[i].collider && entries[i].box.overlap(box))
+                f(entries[i].collider);
+    }
+
+    /**
+     * Call f(a, b) once for every pair of colliders whose boxes overlap, by
+     * sweeping the sorted array
+     */
+    template<class F>
+    void forEachPair(F &&f) const {
+        for (size_t i = 0; i < sortedCount; i++) {
+            const Entry &a = entries[i];
+            if (!a.collider)
+                continue;
+            for (size_t j = i + 1; j < sortedCount; j++) {
+                const Entry &b = entries[j];
+                if (b.box.min.x > a.box.max.x)
+                    break;
+                if (b.collider && a.box.overlap(b.box))
+                    f(a.collider, b.collider);
+            }
+        }
+        for (size_t i = sortedCount; i < entries.size(); i++) {
+            const Entry &a = entries[i];
+            if (!a.collider)
+                continue;
+            for (size_t j = 0; j < i; j++) {
+                const Entry &b = entries[j];
+                if (b.collider && a.box.overlap(b.box))
+                    f(a.collider, b.collider);
+            }
+        }
+    }
+
+    /**
+     * Call f(collider) once for every collider
+     */
+    template<class F>
+    void forEach(F &&f) const {
+        for (const Entry &entry : entries)
+            if (entry.collider)
+                f(entry.collider);
+    }
+
+    /**
+     * Call f(box) for every collider
+     */
+    template<class F>
+    void forEachBox(F &&f) const {
+        for (const Entry &entry : entries)
+            if (entry.collider)
+                f(entry.box);
+    }
+};
+
+} // namespace Blob
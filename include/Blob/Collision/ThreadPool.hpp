@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Blob {
+
+/**
+ * Fixed set of worker threads running parallel loops. The thread calling
+ * parallelFor works with the pool and is counted in its size.
+ */
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workDone;
+
+    const std::function<void(size_t, size_t)> *job = nullptr;
+    size_t jobSize = 0;
+    size_t chunkSize = 1;
+    uint64_t generation = 0;
+    std::atomic<size_t> nextIndex = 0;
+    // workers done with the current generation
+    unsigned finishedWorkers = 0;
+    std::exception_ptr exception;
+    bool stop = false;
+
+    void work();
+
+    void runChunks();
+
+public:
+    /**
+     * @param threadCount total number of threads, including the caller of
+     * parallelFor
+     */
+    explicit ThreadPool(unsigned threadCount);
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool(ThreadPool &&) = delete;
+
+    ~ThreadPool();
+
+    unsigned size() const { return (unsigned) workers.size() + 1; }
+
+    /**
+     * Call f(begin, end) on consecutive chunks covering [0, count) and return
+     * once all of them are done. The first exception thrown by f is rethrown
+     * here.
+     */
+    void parallelFor(size_t count, const std::function<void(size_t, size_t)> &f);
+};
+
+} // namespace Blob
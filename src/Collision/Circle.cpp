@@ -1,7 +1,55 @@
 #include <Blob/Collision/Forms.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 namespace Blob {
 
+namespace {
+
+// Where a circle of rayon moving from origin along direction first touches a
+// convex polygon, its vertices given counterclockwise by vertex(i), or a
+// segment by its two ends. The circle must not overlap the polygon yet: the
+// sides pushed out by rayon and the circles on the vertices are the border
+// of the polygon the center of the circle cannot enter.
+template<class Vertex>
+std::optional<RayHit> sweepConvex(const Vec2<> &origin,
+                                  const Vec2<> &direction,
+                                  float maxDistance,
+                                  float rayon,
+                                  size_t count,
+                                  Vertex &&vertex) {
+    std::optional<RayHit> first;
+    for (size_t i = 0; i < count; i++) {
+        const Vec2<> a = vertex(i);
+        const Circle corner{a, rayon};
+        if (auto hit = corner.raycast(origin, direction, maxDistance)) {
+            maxDistance = hit->distance;
+            first = hit;
+        }
+
+        const Vec2<> edge{a, vertex(i + 1 == count ? 0 : i + 1)};
+        if (edge.isNull())
+            continue;
+        const Vec2<> normal = edge.rotate().normalize();
+        const float speed = normal.dot(direction);
+        if (speed >= 0)
+            continue;
+        const Vec2<> start = a + normal * rayon;
+        const float distance = normal.dot(start - origin) / speed;
+        if (distance < 0 || distance > maxDistance)
+            continue;
+        const float along = edge.dot(origin + direction * distance - start);
+        if (along < 0 || along > edge.length2())
+            continue;
+        maxDistance = distance;
+        first = RayHit{distance, normal};
+    }
+    return first;
+}
+
+} // namespace
+
 bool Circle::overlap(const Rectangle &rectangle) const {
     auto rx = rectangle.position.x - rectangle.size.x / 2.f;
     auto ry = rectangle.position.y - rectangle.size.y / 2.f;
@@ -47,18 +95,31 @@ bool Circle::overlap(const Point &point) const {
     return (position - point).length2() <= rayon * rayon;
 }
 
-std::unordered_set<Vec2<int32_t>> Circle::rasterize() const {
-    std::unordered_set<Vec2<int32_t>> points;
-    auto startx = (int32_t) (position.x - rayon);
-    auto endx = (int32_t) (position.x + rayon);
-    auto starty = (int32_t) (position.y - rayon);
-    auto endy = (int32_t) (position.y + rayon);
-
-    for (int i = startx; i <= endx; i++)
-        for (int j = starty; j <= endy; j++)
-            points.emplace(Vec2{i, j});
-
-    return points;
+std::optional<RayHit> Circle::raycast(const Vec2<> &origin,
+                                      const Vec2<> &direction,
+                                      float maxDistance) const {
+    const Vec2<> m = origin - position;
+    const float c = m.length2() - rayon * rayon;
+    if (c <= 0)
+        return RayHit{0, -direction};
+
+    const float b = m.dot(direction);
+    if (b > 0)
+        return std::nullopt;
+    // b * b - c loses the precision of the large squares when the circle is
+    // far and small, the vector from the center to the line keeps it
+    const Vec2<> perpendicular = m - direction * b;
+    const float delta = rayon * rayon - perpendicular.length2();
+    if (delta < 0)
+        return std::nullopt;
+
+    // -b - sqrt(delta), without subtracting the two
+    const float distance = c / (std::sqrt(delta) - b);
+    if (distance > maxDistance)
+        return std::nullopt;
+    if (rayon == 0)
+        return RayHit{distance, -direction};
+    return RayHit{distance, (m + direction * distance).normalize()};
 }
 
 bool getIntersection(const Circle &circle,
@@ -226,4 +287,82 @@ CollisionResolution Circle::resolve(const Rectangle &rectangle,
 
     return res;
 }
+
+std::optional<RayHit> Circle::sweep(const Vec2<> &direction,
+                                    float maxDistance,
+                                    const Circle &form) const {
+    return Circle(form.position, form.rayon + rayon)
+        .raycast(position, direction, maxDistance);
+}
+
+std::optional<RayHit> Circle::sweep(const Vec2<> &direction,
+                                    float maxDistance,
+                                    const Rectangle &form) const {
+    if (overlap(form))
+        return RayHit{0, -direction};
+    const auto points = form.getPoints();
+    return sweepConvex(position,
+                       direction,
+                       maxDistance,
+                       rayon,
+                       points.size(),
+                       [&](size_t i) { return points[i]; });
+}
+
+std::optional<RayHit> Circle::sweep(const Vec2<> &direction,
+                                    float maxDistance,
+                                    const Point &form) const {
+    return Circle(form, rayon).raycast(position, direction, maxDistance);
+}
+
+std::optional<RayHit> Circle::sweep(const Vec2<> &direction,
+                                    float maxDistance,
+                                    const Line &form) const {
+    const Vec2<> ab{form.positionA, form.positionB};
+    const float length2 = ab.length2();
+    const float t =
+        length2 == 0
+            ? 0
+            : std::clamp(ab.dot(position - form.positionA) / length2, 0.f, 1.f);
+    if (Vec2<>(form.positionA + ab * t, position).length2() <= rayon * rayon)
+        return RayHit{0, -direction};
+    const Vec2<> ends[2] = {form.positionA, form.positionB};
+    return sweepConvex(position,
+                       direction,
+                       maxDistance,
+                       rayon,
+                       2,
+                       [&](size_t i) { return ends[i]; });
+}
+
+std::optional<RayHit> Circle::sweep(const Vec2<> &direction,
+                                    float maxDistance,
+                                    const Polygon &form) const {
+    if (form.overlap(*this))
+        return RayHit{0, -direction};
+    return sweepConvex(position,
+                       direction,
+                       maxDistance,
+                       rayon,
+                       form.size(),
+                       [&](size_t i) { return form.vertex(i); });
+}
+
+std::optional<RayHit> Circle::sweep(const Vec2<> &direction,
+                                    float maxDistance,
+                                    const RasterArea &form) const {
+    std::optional<RayHit> first;
+    for (const Vec2<int32_t> &cell :
+         SweptBox{bounds(), direction * maxDistance}.rasterize()) {
+        if (!form.area.contains(cell))
+            continue;
+        const Rectangle square{cell.cast<float>() + 0.5f, {1, 1}};
+        if (auto hit = sweep(direction, maxDistance, square)) {
+            maxDistance = hit->distance;
+            first = hit;
+        }
+    }
+    return first;
+}
+
 } // namespace Blob
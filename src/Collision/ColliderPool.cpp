@@ -0,0 +1,34 @@
+#include <Blob/Collision/ColliderPool.hpp>
+
+#include <Blob/Core/Exception.hpp>
+
+namespace Blob {
+
+ColliderHandle ColliderPool::add(PhysicalObject *object) {
+    uint32_t index;
+    if (freeSlots.empty()) {
+        if (slots.size() > ColliderHandle::maxIndex)
+            throw Exception("Too many colliders for the collider handles");
+        index = (uint32_t) slots.size();
+        slots.emplace_back();
+    } else {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    slots[index].object = object;
+    return {index, slots[index].generation};
+}
+
+void ColliderPool::remove(ColliderHandle handle) {
+    Slot &slot = slots[handle.index()];
+    slot.object = nullptr;
+    // the handles of the first generation would match the slot again
+    if (slot.generation == maxGeneration) {
+        retiredSlots++;
+        return;
+    }
+    slot.generation++;
+    freeSlots.push_back(handle.index());
+}
+
+} // namespace Blob
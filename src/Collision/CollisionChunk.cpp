@@ -0,0 +1,123 @@
+#include <Blob/Collision/CollisionChunk.hpp>
+
+#include <bit>
+
+namespace Blob::ChunkFormat {
+
+namespace {
+
+void writeFloat(std::ostream &out, float value) {
+    writeU32(out, std::bit_cast<uint32_t>(value));
+}
+
+float readFloat(std::istream &in) {
+    return std::bit_cast<float>(readU32(in));
+}
+
+void writeVec2(std::ostream &out, const Vec2<> &value) {
+    writeFloat(out, value.x);
+    writeFloat(out, value.y);
+}
+
+Vec2<> readVec2(std::istream &in) {
+    const float x = readFloat(in);
+    return {x, readFloat(in)};
+}
+
+} // namespace
+
+void writeU32(std::ostream &out, uint32_t value) {
+    const char bytes[4] = {(char) value,
+                           (char) (value >> 8u),
+                           (char) (value >> 16u),
+                           (char) (value >> 24u)};
+    out.write(bytes, 4);
+}
+
+uint32_t readU32(std::istream &in) {
+    unsigned char bytes[4];
+    if (!in.read((char *) bytes, 4))
+        throw Exception("Truncated collision chunk");
+    return bytes[0] | bytes[1] << 8u | bytes[2] << 16u |
+           (uint32_t) bytes[3] << 24u;
+}
+
+void writeForm(std::ostream &out, const Circle &form) {
+    writeVec2(out, form.position);
+    writeFloat(out, form.rayon);
+}
+
+void writeForm(std::ostream &out, const Rectangle &form) {
+    writeVec2(out, form.position);
+    writeVec2(out, form.size);
+}
+
+void writeForm(std::ostream &out, const Point &form) { writeVec2(out, form); }
+
+void writeForm(std::ostream &out, const Line &form) {
+    writeVec2(out, form.positionA);
+    writeVec2(out, form.positionB);
+}
+
+void writeForm(std::ostream &out, const Polygon &form) {
+    writeU32(out, (uint32_t) form.getLocalVertices().size());
+    for (const Vec2<> &vertex : form.getLocalVertices())
+        writeVec2(out, vertex);
+    writeVec2(out, form.getPosition());
+    writeFloat(out, form.getAngle());
+}
+
+void writeForm(std::ostream &out, const RasterArea &form) {
+    writeU32(out, (uint32_t) form.area.size());
+    for (const Vec2<int32_t> &cell : form.area) {
+        writeU32(out, (uint32_t) cell.x);
+        writeU32(out, (uint32_t) cell.y);
+    }
+}
+
+template<>
+Circle readForm<Circle>(std::istream &in) {
+    const Vec2<> position = readVec2(in);
+    return {position, readFloat(in)};
+}
+
+template<>
+Rectangle readForm<Rectangle>(std::istream &in) {
+    const Vec2<> position = readVec2(in);
+    return {position, readVec2(in)};
+}
+
+template<>
+Point readForm<Point>(std::istream &in) {
+    return readVec2(in);
+}
+
+template<>
+Line readForm<Line>(std::istream &in) {
+    Vec2<> a = readVec2(in);
+    Vec2<> b = readVec2(in);
+    return {a, b};
+}
+
+template<>
+Polygon readForm<Polygon>(std::istream &in) {
+    const uint32_t count = readU32(in);
+    std::vector<Vec2<>> vertices;
+    for (uint32_t i = 0; i < count; i++)
+        vertices.push_back(readVec2(in));
+    const Vec2<> position = readVec2(in);
+    return Polygon(vertices, position, readFloat(in));
+}
+
+template<>
+RasterArea readForm<RasterArea>(std::istream &in) {
+    const uint32_t count = readU32(in);
+    std::unordered_set<Vec2<int32_t>> area;
+    for (uint32_t i = 0; i < count; i++) {
+        const int32_t x = (int32_t) readU32(in);
+        area.emplace(x, (int32_t) readU32(in));
+    }
+    return RasterArea(std::move(area));
+}
+
+} // namespace Blob::ChunkFormat
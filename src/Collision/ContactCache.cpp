@@ -0,0 +1,163 @@
+#include <Blob/Collision/ContactCache.hpp>
+
+#include <algorithm>
+
+namespace Blob {
+
+std::span<PhysicalObject *const> ContactRun::targets() const {
+    if (!cache)
+        return parked;
+    // the offset of an empty run may be past the end of a smaller table
+    if (!count)
+        return {};
+    const auto &table = cache->isNext(*this) ? cache->nextTargets
+                                             : cache->targets;
+    return std::span(table).subspan(offset, count);
+}
+
+ContactRun::~ContactRun() {
+    if (parkedIn)
+        parkedIn->unpark(*this);
+}
+
+ContactCache::~ContactCache() {
+    for (ContactRun *run : parkedRuns)
+        run->parkedIn = nullptr;
+}
+
+void ContactCache::unpark(ContactRun &run) {
+    ContactRun *last = parkedRuns.back();
+    parkedRuns[run.parkedIndex] = last;
+    last->parkedIndex = run.parkedIndex;
+    parkedRuns.pop_back();
+    run.parkedIn = nullptr;
+}
+
+void ContactCache::beginFrame() {
+    frame++;
+    updating = true;
+    nextTargets.clear();
+    nextRuns.clear();
+}
+
+void ContactCache::endFrame() {
+    for (size_t i = 0; i < targets.size();) {
+        ContactRun *run = runs[i];
+        // contact of a detached run, or of a run already written this frame
+        if (!run || run->frame == frame) {
+            i++;
+            continue;
+        }
+        const size_t begin = i;
+        i += run->count;
+        run->offset = (uint32_t) nextTargets.size();
+        run->frame = frame;
+        nextTargets.insert(nextTargets.end(),
+                           targets.begin() + begin,
+                           targets.begin() + i);
+        nextRuns.insert(nextRuns.end(), run->count, run);
+    }
+    std::swap(targets, nextTargets);
+    std::swap(runs, nextRuns);
+    updating = false;
+}
+
+void ContactCache::snapshot(Snapshot &snapshot) const {
+    snapshot.targets.assign(targets.begin(), targets.end());
+    snapshot.runs.assign(runs.begin(), runs.end());
+}
+
+void ContactCache::restore(const Snapshot &snapshot) {
+    for (ContactRun *run : runs)
+        if (run)
+            run->count = 0;
+    targets.assign(snapshot.targets.begin(), snapshot.targets.end());
+    runs.assign(snapshot.runs.begin(), snapshot.runs.end());
+    // the targets of a run are contiguous in the table
+    for (size_t i = 0; i < runs.size();) {
+        ContactRun *run = runs[i];
+        size_t end = i + 1;
+        while (end < runs.size() && runs[end] == run)
+            end++;
+        if (run) {
+            run->offset = (uint32_t) i;
+            run->count = (uint32_t) (end - i);
+            run->frame = frame;
+        }
+        i = end;
+    }
+}
+
+void ContactCache::attach(ContactRun &run) {
+    if (run.parkedIn)
+        run.parkedIn->unpark(run);
+    // during an update the run goes with the runs written this frame, which
+    // endFrame does not carry over
+    auto &table = updating ? nextTargets : targets;
+    auto &tableRuns = updating ? nextRuns : runs;
+    run.cache = this;
+    run.offset = (uint32_t) table.size();
+    run.count = (uint32_t) run.parked.size();
+    run.frame = frame;
+    table.insert(table.end(), run.parked.begin(), run.parked.end());
+    tableRuns.insert(tableRuns.end(), run.parked.size(), &run);
+    run.parked.clear();
+}
+
+void ContactCache::detach(ContactRun &run) {
+    std::span<PhysicalObject *const> contacts = run.targets();
+    run.parked.assign(contacts.begin(), contacts.end());
+    auto &table = isNext(run) ? nextRuns : runs;
+    for (uint32_t i = 0; i < run.count; i++)
+        table[run.offset + i] = nullptr;
+    run.cache = nullptr;
+    run.count = 0;
+    if (!run.parked.empty()) {
+        run.parkedIn = this;
+        run.parkedIndex = parkedRuns.size();
+        parkedRuns.push_back(&run);
+    }
+}
+
+void ContactCache::removeTargetsFrom(std::vector<PhysicalObject *> &table,
+                                     std::vector<ContactRun *> &tableRuns,
+                                     bool next,
+                                     std::span<PhysicalObject *const> removed,
+                                     std::vector<Contact> &ended) {
+    for (size_t i = 0; i < tableRuns.size(); i++) {
+        ContactRun *run = tableRuns[i];
+        // first contact of a run, the stale contacts of the runs written
+        // since in the other table are skipped
+        if (!run || run->offset != i || isNext(*run) != next)
+            continue;
+        uint32_t kept = 0;
+        for (uint32_t j = 0; j < run->count; j++) {
+            PhysicalObject *target = table[i + j];
+            if (std::binary_search(removed.begin(), removed.end(), target))
+                ended.emplace_back(run->owner, target);
+            else
+                table[i + kept++] = target;
+        }
+        // the end of the run is left empty, like a detached run
+        for (uint32_t j = kept; j < run->count; j++)
+            tableRuns[i + j] = nullptr;
+        i += run->count - 1;
+        run->count = kept;
+    }
+}
+
+void ContactCache::removeTargets(std::span<PhysicalObject *const> removed,
+                                 std::vector<Contact> &ended) {
+    removeTargetsFrom(targets, runs, false, removed, ended);
+    if (updating)
+        removeTargetsFrom(nextTargets, nextRuns, true, removed, ended);
+    for (ContactRun *run : parkedRuns)
+        std::erase_if(run->parked, [&](PhysicalObject *target) {
+            if (!std::binary_search(removed.begin(), removed.end(), target))
+                return false;
+            ended.emplace_back(run->owner, target);
+            return true;
+        });
+}
+
+} // namespace Blob
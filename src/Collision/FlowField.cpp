@@ -0,0 +1,233 @@
+#include <Blob/Collision/FlowField.hpp>
+
+#include <Blob/Core/Exception.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace Blob {
+
+namespace {
+
+constexpr float infinity = std::numeric_limits<float>::infinity();
+constexpr float diagonal = 1.41421356f;
+constexpr float halfDiagonal = 0.70710678f;
+
+// distances from the front integrated in the same pass, in cells
+constexpr float frontWidth = FlowField::tileSize;
+
+// same order as the moves of NavigationGrid
+constexpr int32_t moves[8][2] = {
+    {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+constexpr uint8_t opposites[8] = {1, 0, 3, 2, 7, 6, 5, 4};
+
+bool cheaper(const std::pair<float, uint32_t> &a,
+             const std::pair<float, uint32_t> &b) {
+    return a.first > b.first;
+}
+
+} // namespace
+
+const Vec2<> FlowField::moveDirections[none + 1] = {
+    {1, 0},
+    {-1, 0},
+    {0, 1},
+    {0, -1},
+    {halfDiagonal, halfDiagonal},
+    {halfDiagonal, -halfDiagonal},
+    {-halfDiagonal, halfDiagonal},
+    {-halfDiagonal, -halfDiagonal},
+    {0, 0}};
+
+FlowField::FlowField(const NavigationGrid &grid,
+                     const Vec2<> &goal,
+                     const Box &region) :
+    cellSize(grid.cellSize), goal(grid.cellAt(goal)) {
+    const Vec2<int32_t> last = grid.cellAt(region.max);
+    first = grid.cellAt(region.min);
+    first = {std::max(first.x, 0), std::max(first.y, 0)};
+    width = std::min(last.x, grid.width - 1) - first.x + 1;
+    height = std::min(last.y, grid.height - 1) - first.y + 1;
+    if (width <= 0 || height <= 0)
+        throw Exception("Flow field region out of the navigation grid");
+    if (this->goal.x < first.x || this->goal.y < first.y ||
+        this->goal.x >= first.x + width || this->goal.y >= first.y + height)
+        throw Exception("Flow field goal out of its region");
+    origin = grid.origin +
+             Vec2<>{(float) first.x, (float) first.y} * grid.cellSize;
+}
+
+FlowField::Tile FlowField::tileOf(int32_t tile) const {
+    const int32_t tilesX = (width + tileSize - 1) / tileSize;
+    return {tile % tilesX * tileSize,
+            tile / tilesX * tileSize,
+            std::min((tile % tilesX + 1) * tileSize, width) - 1,
+            std::min((tile / tilesX + 1) * tileSize, height) - 1};
+}
+
+FlowField::Spread
+FlowField::integrate(const NavigationGrid &grid,
+                     const Tile &cells,
+                     const std::vector<float> &previous,
+                     std::vector<std::pair<float, uint32_t>> &heap) {
+    auto inTile = [&](int32_t x, int32_t y) {
+        return x >= cells.x0 && y >= cells.y0 && x <= cells.x1 &&
+               y <= cells.y1;
+    };
+    // the moves checked stay in the region, and so in the grid
+    auto canMove = [&](int32_t x, int32_t y, const int32_t *move) {
+        auto open = [&](int32_t x, int32_t y) {
+            return !grid.blocked[grid.index(first.x + x, first.y + y)];
+        };
+        const int32_t nx = x + move[0], ny = y + move[1];
+        return open(nx, ny) &&
+               (move[0] == 0 || move[1] == 0 || (open(nx, y) && open(x, ny)));
+    };
+    // the cell at x + move points back along move
+    auto relax = [&](int32_t x, int32_t y, uint8_t move, float distance) {
+        const int32_t cell = (y + moves[move][1]) * width + x + moves[move][0];
+        if (distance >= distances[cell])
+            return;
+        distances[cell] = distance;
+        directions[cell] = opposites[move];
+        heap.emplace_back(distance, (uint32_t) cell);
+        std::push_heap(heap.begin(), heap.end(), cheaper);
+    };
+    auto step = [](uint8_t move) {
+        return moves[move][0] && moves[move][1] ? diagonal : 1.f;
+    };
+
+    heap.clear();
+    const int32_t gx = goal.x - first.x, gy = goal.y - first.y;
+    if (inTile(gx, gy) && distances[gy * width + gx] != 0) {
+        distances[gy * width + gx] = 0;
+        heap.emplace_back(0.f, (uint32_t) (gy * width + gx));
+    }
+    // the cells around the tile, as integrated by their own tiles
+    for (int32_t y = std::max(cells.y0 - 1, 0);
+         y <= std::min(cells.y1 + 1, height - 1);
+         y++)
+        for (int32_t x = std::max(cells.x0 - 1, 0);
+             x <= std::min(cells.x1 + 1, width - 1);
+             x++) {
+            if (inTile(x, y)) {
+                // only the first and last columns are around the tile
+                if (x != cells.x1)
+                    x = cells.x1;
+                continue;
+            }
+            const float distance = previous[y * width + x];
+            if (distance == infinity)
+                continue;
+            for (uint8_t m = 0; m < 8; m++)
+                if (inTile(x + moves[m][0], y + moves[m][1]) &&
+                    canMove(x, y, moves[m]))
+                    relax(x, y, m, distance + step(m));
+        }
+
+    Spread spread;
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), cheaper);
+        const auto [distance, current] = heap.back();
+        heap.pop_back();
+        if (distance > distances[current])
+            continue;
+        const int32_t x = (int32_t) current % width;
+        const int32_t y = (int32_t) current / width;
+        for (uint8_t m = 0; m < 8; m++) {
+            const int32_t nx = x + moves[m][0], ny = y + moves[m][1];
+            if (inTile(nx, ny)) {
+                if (canMove(x, y, moves[m]))
+                    relax(x, y, m, distance + step(m));
+            } else if (nx >= 0 && ny >= 0 && nx < width && ny < height &&
+                       canMove(x, y, moves[m])) {
+                const int32_t dx = nx < cells.x0 ? -1 : nx > cells.x1;
+                const int32_t dy = ny < cells.y0 ? -1 : ny > cells.y1;
+                spread.tiles |= (uint16_t) (1 << ((dy + 1) * 3 + dx + 1));
+                spread.distance = std::min(spread.distance, distance);
+            }
+        }
+    }
+    return spread;
+}
+
+void FlowField::integrateTiles(const NavigationGrid &grid,
+                               ThreadPool &threadPool) {
+    const int32_t tilesX = (width + tileSize - 1) / tileSize;
+    const int32_t tilesY = (height + tileSize - 1) / tileSize;
+    // copy of the sides of the tiles, updated between two passes so that the
+    // tiles read their neighbours while they are integrated
+    std::vector<float> previous(distances);
+    // shortest distance brought to each tile since it was integrated,
+    // infinity if none
+    std::vector<float> pending((size_t) tilesX * tilesY, infinity);
+    pending[(goal.y - first.y) / tileSize * tilesX +
+            (goal.x - first.x) / tileSize] = 0;
+    std::vector<int32_t> tiles;
+    std::vector<Spread> spreads;
+    while (true) {
+        // a tile integrated before the distances around it are final is
+        // integrated again, follow the front of the distances
+        const float front = *std::min_element(pending.begin(), pending.end());
+        if (front == infinity)
+            return;
+        tiles.clear();
+        for (int32_t tile = 0; tile < tilesX * tilesY; tile++)
+            if (pending[tile] <= front + frontWidth) {
+                tiles.push_back(tile);
+                pending[tile] = infinity;
+            }
+
+        spreads.assign(tiles.size(), {});
+        threadPool.parallelFor(tiles.size(), [&](size_t begin, size_t end) {
+            std::vector<std::pair<float, uint32_t>> heap;
+            for (size_t i = begin; i < end; i++)
+                spreads[i] = integrate(grid, tileOf(tiles[i]), previous, heap);
+        });
+
+        for (size_t i = 0; i < tiles.size(); i++) {
+            const Tile cells = tileOf(tiles[i]);
+            for (int32_t y = cells.y0; y <= cells.y1; y++)
+                for (int32_t x : {cells.x0, cells.x1})
+                    previous[y * width + x] = distances[y * width + x];
+            for (int32_t y : {cells.y0, cells.y1})
+                std::copy(distances.begin() + y * width + cells.x0,
+                          distances.begin() + y * width + cells.x1 + 1,
+                          previous.begin() + y * width + cells.x0);
+
+            const int32_t tx = tiles[i] % tilesX, ty = tiles[i] / tilesX;
+            for (int32_t dy = -1; dy <= 1; dy++)
+                for (int32_t dx = -1; dx <= 1; dx++)
+                    if (spreads[i].tiles & 1 << ((dy + 1) * 3 + dx + 1)) {
+                        float &tile = pending[(ty + dy) * tilesX + tx + dx];
+                        tile = std::min(tile, spreads[i].distance);
+                    }
+        }
+    }
+}
+
+void FlowField::build(const NavigationGrid &grid, ThreadPool *threadPool) {
+    distances.assign((size_t) width * height, infinity);
+    directions.assign((size_t) width * height, none);
+    if (!grid.isWalkable(goal))
+        return;
+
+    if (!threadPool) {
+        // a single search, the tiles would integrate some cells again
+        std::vector<std::pair<float, uint32_t>> heap;
+        integrate(grid, {0, 0, width - 1, height - 1}, distances, heap);
+    } else
+        integrateTiles(grid, *threadPool);
+}
+
+float FlowField::distance(const Vec2<> &point) const {
+    const int32_t cell = localIndex(point);
+    return cell < 0 ? infinity : distances[cell];
+}
+
+Box FlowField::getRegion() const {
+    return {origin,
+            origin + Vec2<>{(float) width, (float) height} * cellSize};
+}
+
+} // namespace Blob
@@ -1,5 +1,6 @@
 #include <Blob/Collision/Forms.hpp>
 
+#include <algorithm>
 #include <cmath>
 
 namespace Blob {
@@ -75,33 +76,43 @@ bool Line::overlap(const Line &line) const {
     return false;
 }
 
+float Line::distance(const Vec2<> &point) const {
+    const Vec2<> ab{positionA, positionB};
+    const float length2 = ab.length2();
+    const float t =
+        length2 == 0
+            ? 0
+            : std::clamp(ab.dot(point - positionA) / length2, 0.f, 1.f);
+    return Vec2<>(positionA + ab * t, point).length();
+}
+
 bool Line::overlap(const Point &point) const {
     return false;
 }
 
-std::unordered_set<Vec2<int32_t>> Line::rasterize() const {
-    std::unordered_set<Vec2<int32_t>> points;
-    int64_t startx, endx, starty, endy;
-    if (positionA.x < positionB.x) {
-        startx = (int64_t) (positionA.x);
-        endx = (int64_t) (positionB.x);
-    } else {
-        startx = (int64_t) (positionB.x);
-        endx = (int64_t) (positionA.x);
-    }
-    if (positionA.y < positionB.y) {
-        starty = (int64_t) (positionA.y);
-        endy = (int64_t) (positionB.y);
-    } else {
-        starty = (int64_t) (positionB.y);
-        endy = (int64_t) (positionA.y);
-    }
-
-    for (int i = startx; i <= endx; i++)
-        for (int j = starty; j <= endy; j++)
-            points.emplace(Vec2{i, j});
-
-    return points;
+std::optional<RayHit> Line::raycast(const Vec2<> &origin,
+                                    const Vec2<> &direction,
+                                    float maxDistance) const {
+    const Vec2<> AB = positionB - positionA;
+    const float denominator = direction.cross(AB);
+    // parallel, a ray along the line does not hit it, like Line::overlap
+    if (denominator == 0)
+        return std::nullopt;
+
+    const Vec2<> toA = positionA - origin;
+    const float distance = toA.cross(AB) / denominator;
+    const float u = toA.cross(direction) / denominator;
+    if (distance < 0 || distance > maxDistance || u < 0 || u > 1)
+        return std::nullopt;
+
+    Vec2<> normal = AB.rotate().normalize();
+    if (normal.dot(direction) > 0)
+        normal = -normal;
+    return RayHit{distance, normal};
+}
+
+GridTraversal Line::rasterize() const {
+    return {positionA, positionB};
 }
 
 } // namespace Blob
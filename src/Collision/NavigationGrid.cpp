@@ -0,0 +1,503 @@
+#include <Blob/Collision/NavigationGrid.hpp>
+
+#include <Blob/Core/Exception.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Blob {
+
+namespace {
+
+constexpr float infinity = std::numeric_limits<float>::infinity();
+constexpr float diagonal = 1.41421356f;
+
+// a run of walkable cells along a border at least this long gets a
+// transition at each end instead of one in its middle
+constexpr int32_t longEntrance = 6;
+
+constexpr int32_t moves[8][2] = {
+    {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+bool cheaper(const std::pair<float, uint32_t> &a,
+             const std::pair<float, uint32_t> &b) {
+    return a.first > b.first;
+}
+
+} // namespace
+
+NavigationGrid::NavigationGrid(const Box &area,
+                               float cellSize,
+                               uint32_t clusterSize) :
+    origin(area.min), cellSize(cellSize), clusterSize((int32_t) clusterSize) {
+    if (cellSize <= 0 || clusterSize == 0)
+        throw Exception("Invalid navigation grid cell or cluster size");
+    width = std::max(
+        1, (int32_t) std::ceil((area.max.x - area.min.x) / cellSize));
+    height = std::max(
+        1, (int32_t) std::ceil((area.max.y - area.min.y) / cellSize));
+    clustersX = (width + this->clusterSize - 1) / this->clusterSize;
+    clustersY = (height + this->clusterSize - 1) / this->clusterSize;
+    blocked.assign((size_t) width * height, 0);
+    clusters.resize((size_t) clustersX * clustersY);
+}
+
+NavigationGrid::CellRect NavigationGrid::cellsOf(uint32_t cluster) const {
+    const int32_t x0 = (int32_t) cluster % clustersX * clusterSize;
+    const int32_t y0 = (int32_t) cluster / clustersX * clusterSize;
+    return {x0,
+            y0,
+            std::min(x0 + clusterSize, width) - 1,
+            std::min(y0 + clusterSize, height) - 1};
+}
+
+Rectangle NavigationGrid::square(int32_t x, int32_t y) const {
+    return {origin + Vec2<>{(float) x + 0.5f, (float) y + 0.5f} * cellSize,
+            Vec2<>{cellSize, cellSize}};
+}
+
+Vec2<int32_t> NavigationGrid::cellAt(const Vec2<> &point) const {
+    return {(int32_t) std::floor((point.x - origin.x) / cellSize),
+            (int32_t) std::floor((point.y - origin.y) / cellSize)};
+}
+
+Vec2<> NavigationGrid::centerOf(const Vec2<int32_t> &cell) const {
+    return origin +
+           Vec2<>{(float) cell.x + 0.5f, (float) cell.y + 0.5f} * cellSize;
+}
+
+bool NavigationGrid::rasterize(const CellRect &cells, const BlockedTest &test) {
+    bool changed = false;
+    for (int32_t y = cells.y0; y <= cells.y1; y++)
+        for (int32_t x = cells.x0; x <= cells.x1; x++) {
+            const uint8_t cell = test(square(x, y));
+            changed |= blocked[index(x, y)] != cell;
+            blocked[index(x, y)] = cell;
+        }
+    return changed;
+}
+
+void NavigationGrid::findTransitions(
+    uint32_t a,
+    uint32_t b,
+    std::vector<std::pair<uint32_t, uint32_t>> &transitions) const {
+    const CellRect cells = cellsOf(a);
+    // b is on the right of a or below it
+    const bool vertical = b == a + 1;
+    const int32_t first = vertical ? cells.y0 : cells.x0;
+    const int32_t last = vertical ? cells.y1 : cells.x1;
+    auto pair = [&](int32_t i) {
+        return vertical ? std::pair{index(cells.x1, i), index(cells.x1 + 1, i)}
+                        : std::pair{index(i, cells.y1), index(i, cells.y1 + 1)};
+    };
+    auto open = [&](int32_t i) {
+        const auto [inA, inB] = pair(i);
+        return !blocked[inA] && !blocked[inB];
+    };
+
+    for (int32_t i = first; i <= last;) {
+        if (!open(i)) {
+            i++;
+            continue;
+        }
+        const int32_t start = i;
+        while (i <= last && open(i))
+            i++;
+        const int32_t end = i - 1;
+        if (end - start + 1 >= longEntrance) {
+            transitions.push_back(pair(start));
+            transitions.push_back(pair(end));
+        } else
+            transitions.push_back(pair((start + end) / 2));
+    }
+}
+
+void NavigationGrid::buildCluster(uint32_t cluster, Search &search) {
+    Cluster &c = clusters[cluster];
+    c.nodes.clear();
+    c.links.clear();
+
+    const int32_t cx = (int32_t) cluster % clustersX;
+    const int32_t cy = (int32_t) cluster / clustersX;
+    std::vector<std::pair<uint32_t, uint32_t>> transitions;
+    auto addBorder = [&](uint32_t a, uint32_t b) {
+        transitions.clear();
+        findTransitions(a, b, transitions);
+        for (auto [inA, inB] : transitions) {
+            const uint32_t mine = a == cluster ? inA : inB;
+            const uint32_t other = a == cluster ? inB : inA;
+            auto it = std::find(c.nodes.begin(), c.nodes.end(), mine);
+            if (it == c.nodes.end())
+                it = c.nodes.insert(it, mine);
+            c.links.emplace_back((uint32_t) (it - c.nodes.begin()), other);
+        }
+    };
+    if (cx > 0)
+        addBorder(cluster - 1, cluster);
+    if (cx + 1 < clustersX)
+        addBorder(cluster, cluster + 1);
+    if (cy > 0)
+        addBorder(cluster - clustersX, cluster);
+    if (cy + 1 < clustersY)
+        addBorder(cluster, cluster + clustersX);
+
+    const CellRect cells = cellsOf(cluster);
+    const size_t n = c.nodes.size();
+    c.distances.assign(n * n, infinity);
+    for (size_t i = 0; i < n; i++) {
+        dijkstra(cells, c.nodes[i], search);
+        for (size_t j = 0; j < n; j++) {
+            const int32_t x = (int32_t) c.nodes[j] % width;
+            const int32_t y = (int32_t) c.nodes[j] / width;
+            c.distances[i * n + j] =
+                search.distances[(y - cells.y0) * (cells.x1 - cells.x0 + 1) +
+                                 x - cells.x0];
+        }
+    }
+}
+
+void NavigationGrid::dijkstra(const CellRect &cells,
+                              uint32_t cell,
+                              Search &search) const {
+    const int32_t w = cells.x1 - cells.x0 + 1;
+    const int32_t h = cells.y1 - cells.y0 + 1;
+    auto local = [&](int32_t x, int32_t y) {
+        return (uint32_t) ((y - cells.y0) * w + x - cells.x0);
+    };
+    search.distances.assign((size_t) w * h, infinity);
+    search.heap.clear();
+
+    const int32_t sx = (int32_t) cell % width, sy = (int32_t) cell / width;
+    search.distances[local(sx, sy)] = 0;
+    search.heap.emplace_back(0.f, local(sx, sy));
+    while (!search.heap.empty()) {
+        std::pop_heap(search.heap.begin(), search.heap.end(), cheaper);
+        const auto [distance, current] = search.heap.back();
+        search.heap.pop_back();
+        if (distance > search.distances[current])
+            continue;
+        const int32_t x = (int32_t) current % w + cells.x0;
+        const int32_t y = (int32_t) current / w + cells.y0;
+        for (const auto &move : moves) {
+            const int32_t nx = x + move[0], ny = y + move[1];
+            if (nx < cells.x0 || ny < cells.y0 || nx > cells.x1 ||
+                ny > cells.y1 || blocked[index(nx, ny)])
+                continue;
+            const bool diagonalMove = move[0] != 0 && move[1] != 0;
+            if (diagonalMove &&
+                (blocked[index(nx, y)] || blocked[index(x, ny)]))
+                continue;
+            const float next = distance + (diagonalMove ? diagonal : 1.f);
+            float &known = search.distances[local(nx, ny)];
+            if (next >= known)
+                continue;
+            known = next;
+            search.heap.emplace_back(next, local(nx, ny));
+            std::push_heap(search.heap.begin(), search.heap.end(), cheaper);
+        }
+    }
+}
+
+void NavigationGrid::refine(const CellRect &cells,
+                            uint32_t a,
+                            uint32_t b,
+                            std::vector<uint32_t> &path,
+                            Search &search) const {
+    const int32_t w = cells.x1 - cells.x0 + 1;
+    const int32_t h = cells.y1 - cells.y0 + 1;
+    auto local = [&](int32_t x, int32_t y) {
+        return (uint32_t) ((y - cells.y0) * w + x - cells.x0);
+    };
+    auto global = [&](uint32_t cell) {
+        return index((int32_t) cell % w + cells.x0,
+                     (int32_t) cell / w + cells.y0);
+    };
+    search.distances.assign((size_t) w * h, infinity);
+    search.parents.resize((size_t) w * h);
+    search.heap.clear();
+
+    const uint32_t from = local((int32_t) a % width, (int32_t) a / width);
+    const uint32_t to = local((int32_t) b % width, (int32_t) b / width);
+    search.distances[from] = 0;
+    search.heap.emplace_back(heuristic(a, b), from);
+    while (!search.heap.empty()) {
+        std::pop_heap(search.heap.begin(), search.heap.end(), cheaper);
+        const auto [estimate, current] = search.heap.back();
+        search.heap.pop_back();
+        if (current == to)
+            break;
+        const float distance = search.distances[current];
+        if (estimate > distance + heuristic(global(current), b))
+            continue;
+        const int32_t x = (int32_t) current % w + cells.x0;
+        const int32_t y = (int32_t) current / w + cells.y0;
+        for (const auto &move : moves) {
+            const int32_t nx = x + move[0], ny = y + move[1];
+            if (nx < cells.x0 || ny < cells.y0 || nx > cells.x1 ||
+                ny > cells.y1 || blocked[index(nx, ny)])
+                continue;
+            const bool diagonalMove = move[0] != 0 && move[1] != 0;
+            if (diagonalMove &&
+                (blocked[index(nx, y)] || blocked[index(x, ny)]))
+                continue;
+            const float next = distance + (diagonalMove ? diagonal : 1.f);
+            float &known = search.distances[local(nx, ny)];
+            if (next >= known)
+                continue;
+            known = next;
+            search.parents[local(nx, ny)] = current;
+            search.heap.emplace_back(next + heuristic(index(nx, ny), b),
+                                     local(nx, ny));
+            std::push_heap(search.heap.begin(), search.heap.end(), cheaper);
+        }
+    }
+    if (search.distances[to] == infinity)
+        return;
+
+    const size_t first = path.size();
+    for (uint32_t cell = to; cell != from; cell = search.parents[cell])
+        path.push_back(global(cell));
+    std::reverse(path.begin() + (ptrdiff_t) first, path.end());
+}
+
+void NavigationGrid::findComponents() {
+    components.assign(blocked.size(), 0);
+    std::vector<uint32_t> stack;
+    uint32_t component = 0;
+    for (uint32_t cell = 0; cell < blocked.size(); cell++) {
+        if (blocked[cell] || components[cell])
+            continue;
+        component++;
+        components[cell] = component;
+        stack.push_back(cell);
+        while (!stack.empty()) {
+            const int32_t x = (int32_t) stack.back() % width;
+            const int32_t y = (int32_t) stack.back() / width;
+            stack.pop_back();
+            for (const auto &move : moves) {
+                const int32_t nx = x + move[0], ny = y + move[1];
+                if (!walkable(nx, ny) || components[index(nx, ny)])
+                    continue;
+                if (move[0] != 0 && move[1] != 0 &&
+                    (!walkable(nx, y) || !walkable(x, ny)))
+                    continue;
+                components[index(nx, ny)] = component;
+                stack.push_back(index(nx, ny));
+            }
+        }
+    }
+}
+
+float NavigationGrid::heuristic(uint32_t a, uint32_t b) const {
+    const int32_t dx = std::abs((int32_t) (a % width) - (int32_t) (b % width));
+    const int32_t dy = std::abs((int32_t) (a / width) - (int32_t) (b / width));
+    const auto [low, high] = std::minmax(dx, dy);
+    return (float) (high - low) + diagonal * (float) low;
+}
+
+void NavigationGrid::build(const BlockedTest &test, ThreadPool *threadPool) {
+    if (!threadPool) {
+        rasterize({0, 0, width - 1, height - 1}, test);
+        Search search;
+        for (uint32_t cluster = 0; cluster < clusters.size(); cluster++)
+            buildCluster(cluster, search);
+    } else {
+        threadPool->parallelFor(height, [&](size_t begin, size_t end) {
+            rasterize({0, (int32_t) begin, width - 1, (int32_t) end - 1},
+                      test);
+        });
+        threadPool->parallelFor(
+            clusters.size(), [&](size_t begin, size_t end) {
+                Search search;
+                for (size_t cluster = begin; cluster < end; cluster++)
+                    buildCluster((uint32_t) cluster, search);
+            });
+    }
+    findComponents();
+}
+
+void NavigationGrid::repair(std::span<const Box> areas,
+                            const BlockedTest &test) {
+    std::vector<uint8_t> dirty(clusters.size(), 0);
+    bool changed = false;
+    for (const Box &area : areas) {
+        const Vec2<int32_t> first = cellAt(area.min), last = cellAt(area.max);
+        const CellRect cells{std::max(first.x, 0),
+                             std::max(first.y, 0),
+                             std::min(last.x, width - 1),
+                             std::min(last.y, height - 1)};
+        if (cells.x0 > cells.x1 || cells.y0 > cells.y1 ||
+            !rasterize(cells, test))
+            continue;
+        changed = true;
+        // the transitions on the borders of a cluster are also nodes of its
+        // neighbours
+        const int32_t cx0 = std::max(cells.x0 / clusterSize - 1, 0);
+        const int32_t cy0 = std::max(cells.y0 / clusterSize - 1, 0);
+        const int32_t cx1 = std::min(cells.x1 / clusterSize + 1, clustersX - 1);
+        const int32_t cy1 = std::min(cells.y1 / clusterSize + 1, clustersY - 1);
+        for (int32_t cy = cy0; cy <= cy1; cy++)
+            for (int32_t cx = cx0; cx <= cx1; cx++)
+                dirty[cy * clustersX + cx] = 1;
+    }
+    if (!changed)
+        return;
+    Search search;
+    for (uint32_t cluster = 0; cluster < clusters.size(); cluster++)
+        if (dirty[cluster])
+            buildCluster(cluster, search);
+    findComponents();
+}
+
+bool NavigationGrid::findPath(const Vec2<> &from,
+                              const Vec2<> &to,
+                              std::vector<Vec2<>> &path,
+                              Search &search) const {
+    path.clear();
+    const Vec2<int32_t> fromCell = cellAt(from), toCell = cellAt(to);
+    if (!isWalkable(fromCell) || !isWalkable(toCell))
+        return false;
+    const uint32_t start = index(fromCell.x, fromCell.y);
+    const uint32_t goal = index(toCell.x, toCell.y);
+    if (components[start] != components[goal])
+        return false;
+    if (start == goal) {
+        path.push_back(centerOf(fromCell));
+        return true;
+    }
+
+    const uint32_t startCluster = clusterOf(start);
+    const uint32_t goalCluster = clusterOf(goal);
+    const CellRect startCells = cellsOf(startCluster);
+    const CellRect goalCells = cellsOf(goalCluster);
+    // the nodes on the borders make long detours between nearby cells, they
+    // are joined by A* on the cells of their clusters when these touch
+    if (std::abs((int32_t) (startCluster % clustersX) -
+                 (int32_t) (goalCluster % clustersX)) <= 1 &&
+        std::abs((int32_t) (startCluster / clustersX) -
+                 (int32_t) (goalCluster / clustersX)) <= 1) {
+        search.cells.assign(1, start);
+        refine({std::min(startCells.x0, goalCells.x0),
+                std::min(startCells.y0, goalCells.y0),
+                std::max(startCells.x1, goalCells.x1),
+                std::max(startCells.y1, goalCells.y1)},
+               start,
+               goal,
+               search.cells,
+               search);
+        if (search.cells.size() > 1) {
+            for (uint32_t cell : search.cells)
+                path.push_back(centerOf(
+                    {(int32_t) cell % width, (int32_t) cell / width}));
+            return true;
+        }
+    }
+
+    // costs from the start and to the goal to the nodes of their clusters
+    auto costs = [&](const CellRect &cells,
+                     uint32_t cluster,
+                     std::vector<float> &out) {
+        const int32_t w = cells.x1 - cells.x0 + 1;
+        out.clear();
+        for (uint32_t node : clusters[cluster].nodes)
+            out.push_back(
+                search.distances[((int32_t) node / width - cells.y0) * w +
+                                 (int32_t) node % width - cells.x0]);
+    };
+    dijkstra(startCells, start, search);
+    costs(startCells, startCluster, search.startCosts);
+    float direct = infinity;
+    if (startCluster == goalCluster)
+        direct = search.distances[(toCell.y - startCells.y0) *
+                                      (startCells.x1 - startCells.x0 + 1) +
+                                  toCell.x - startCells.x0];
+    dijkstra(goalCells, goal, search);
+    costs(goalCells, goalCluster, search.goalCosts);
+
+    // A* on the nodes, with the start and the goal linked to the nodes of
+    // their clusters
+    search.visits.clear();
+    search.heap.clear();
+    auto relax = [&](uint32_t cell, float cost, uint32_t parent) {
+        auto [it, inserted] =
+            search.visits.try_emplace(cell, Search::Visit{infinity, 0, false});
+        if (it->second.closed || cost >= it->second.cost)
+            return;
+        it->second.cost = cost;
+        it->second.parent = parent;
+        search.heap.emplace_back(cost + heuristic(cell, goal), cell);
+        std::push_heap(search.heap.begin(), search.heap.end(), cheaper);
+    };
+    relax(start, 0, start);
+    bool found = false;
+    while (!search.heap.empty()) {
+        std::pop_heap(search.heap.begin(), search.heap.end(), cheaper);
+        const uint32_t current = search.heap.back().second;
+        search.heap.pop_back();
+        Search::Visit &visit = search.visits[current];
+        if (visit.closed)
+            continue;
+        visit.closed = true;
+        const float cost = visit.cost;
+        if (current == goal) {
+            found = true;
+            break;
+        }
+
+        if (current == start) {
+            const Cluster &c = clusters[startCluster];
+            for (size_t i = 0; i < c.nodes.size(); i++)
+                if (search.startCosts[i] != infinity)
+                    relax(c.nodes[i], search.startCosts[i], start);
+            if (direct != infinity)
+                relax(goal, direct, start);
+        }
+        const uint32_t cluster = clusterOf(current);
+        const Cluster &c = clusters[cluster];
+        const auto it = std::find(c.nodes.begin(), c.nodes.end(), current);
+        if (it == c.nodes.end())
+            continue;
+        const size_t i = it - c.nodes.begin(), n = c.nodes.size();
+        for (size_t j = 0; j < n; j++)
+            if (c.distances[i * n + j] != infinity)
+                relax(c.nodes[j], cost + c.distances[i * n + j], current);
+        for (const auto &[node, across] : c.links)
+            if (node == i)
+                relax(across, cost + 1, current);
+        if (cluster == goalCluster && search.goalCosts[i] != infinity)
+            relax(goal, cost + search.goalCosts[i], current);
+    }
+    if (!found)
+        return false;
+
+    search.nodes.clear();
+    for (uint32_t node = goal; node != start;
+         node = search.visits[node].parent)
+        search.nodes.push_back(node);
+    search.nodes.push_back(start);
+    std::reverse(search.nodes.begin(), search.nodes.end());
+
+    search.cells.assign(1, start);
+    for (size_t k = 0; k + 1 < search.nodes.size(); k++) {
+        const uint32_t a = search.nodes[k], b = search.nodes[k + 1];
+        const uint32_t cluster = clusterOf(a);
+        if (cluster == clusterOf(b))
+            refine(cellsOf(cluster), a, b, search.cells, search);
+        else
+            search.cells.push_back(b);
+    }
+    for (uint32_t cell : search.cells)
+        path.push_back(
+            centerOf({(int32_t) cell % width, (int32_t) cell / width}));
+    return true;
+}
+
+size_t NavigationGrid::nodeCount() const {
+    size_t count = 0;
+    for (const Cluster &cluster : clusters)
+        count += cluster.nodes.size();
+    return count;
+}
+
+} // namespace Blob
@@ -0,0 +1,755 @@
+#include <Blob/Collision/PackedForms.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace Blob {
+
+namespace {
+
+#if defined(__AVX2__)
+struct Simd {
+    typedef __m256 Floats;
+    typedef __m256 Mask;
+    static constexpr size_t width = 8;
+
+    static Floats gather(const std::vector<float> &a, const uint32_t *i) {
+        return _mm256_i32gather_ps(
+            a.data(), _mm256_loadu_si256((const __m256i *) i), 4);
+    }
+    static Floats set(float a) { return _mm256_set1_ps(a); }
+    static Floats add(Floats a, Floats b) { return _mm256_add_ps(a, b); }
+    static Floats sub(Floats a, Floats b) { return _mm256_sub_ps(a, b); }
+    static Floats mul(Floats a, Floats b) { return _mm256_mul_ps(a, b); }
+    static Floats div(Floats a, Floats b) { return _mm256_div_ps(a, b); }
+    static Floats sqrt(Floats a) { return _mm256_sqrt_ps(a); }
+    static Floats abs(Floats a) {
+        return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a);
+    }
+    static void store(float *out, Floats a) { _mm256_storeu_ps(out, a); }
+    static Mask less(Floats a, Floats b) {
+        return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+    }
+    static Mask lessEqual(Floats a, Floats b) {
+        return _mm256_cmp_ps(a, b, _CMP_LE_OQ);
+    }
+    static Mask notGreater(Floats a, Floats b) {
+        return _mm256_cmp_ps(a, b, _CMP_NGT_UQ);
+    }
+    static Mask greater(Floats a, Floats b) {
+        return _mm256_cmp_ps(a, b, _CMP_GT_OQ);
+    }
+    static Mask equal(Floats a, Floats b) {
+        return _mm256_cmp_ps(a, b, _CMP_EQ_OQ);
+    }
+    static Mask both(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+    static Mask either(Mask a, Mask b) { return _mm256_or_ps(a, b); }
+    static Mask inverse(Mask a) {
+        return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+    }
+    static Floats select(Mask m, Floats a, Floats b) {
+        return _mm256_blendv_ps(b, a, m);
+    }
+    static unsigned bits(Mask m) { return (unsigned) _mm256_movemask_ps(m); }
+};
+#elif defined(__SSE2__) || defined(_M_X64)
+struct Simd {
+    typedef __m128 Floats;
+    typedef __m128 Mask;
+    static constexpr size_t width = 4;
+
+    static Floats gather(const std::vector<float> &a, const uint32_t *i) {
+        return _mm_set_ps(a[i[3]], a[i[2]], a[i[1]], a[i[0]]);
+    }
+    static Floats set(float a) { return _mm_set1_ps(a); }
+    static Floats add(Floats a, Floats b) { return _mm_add_ps(a, b); }
+    static Floats sub(Floats a, Floats b) { return _mm_sub_ps(a, b); }
+    static Floats mul(Floats a, Floats b) { return _mm_mul_ps(a, b); }
+    static Floats div(Floats a, Floats b) { return _mm_div_ps(a, b); }
+    static Floats sqrt(Floats a) { return _mm_sqrt_ps(a); }
+    static Floats abs(Floats a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+    static void store(float *out, Floats a) { _mm_storeu_ps(out, a); }
+    static Mask less(Floats a, Floats b) { return _mm_cmplt_ps(a, b); }
+    static Mask lessEqual(Floats a, Floats b) { return _mm_cmple_ps(a, b); }
+    static Mask notGreater(Floats a, Floats b) { return _mm_cmpngt_ps(a, b); }
+    static Mask greater(Floats a, Floats b) { return _mm_cmpgt_ps(a, b); }
+    static Mask equal(Floats a, Floats b) { return _mm_cmpeq_ps(a, b); }
+    static Mask both(Mask a, Mask b) { return _mm_and_ps(a, b); }
+    static Mask either(Mask a, Mask b) { return _mm_or_ps(a, b); }
+    static Mask inverse(Mask a) {
+        return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1)));
+    }
+    static Floats select(Mask m, Floats a, Floats b) {
+        return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+    }
+    static unsigned bits(Mask m) { return (unsigned) _mm_movemask_ps(m); }
+};
+#else
+struct Simd {
+    typedef float Floats;
+    typedef bool Mask;
+    static constexpr size_t width = 1;
+
+    static Floats gather(const std::vector<float> &a, const uint32_t *i) {
+        return a[*i];
+    }
+    static Floats set(float a) { return a; }
+    static Floats add(Floats a, Floats b) { return a + b; }
+    static Floats sub(Floats a, Floats b) { return a - b; }
+    static Floats mul(Floats a, Floats b) { return a * b; }
+    static Floats div(Floats a, Floats b) { return a / b; }
+    static Floats sqrt(Floats a) { return std::sqrt(a); }
+    static Floats abs(Floats a) { return std::abs(a); }
+    static void store(float *out, Floats a) { *out = a; }
+    static Mask less(Floats a, Floats b) { return a < b; }
+    static Mask lessEqual(Floats a, Floats b) { return a <= b; }
+    static Mask notGreater(Floats a, Floats b) { return !(a > b); }
+    static Mask greater(Floats a, Floats b) { return a > b; }
+    static Mask equal(Floats a, Floats b) { return a == b; }
+    static Mask both(Mask a, Mask b) { return a && b; }
+    static Mask either(Mask a, Mask b) { return a || b; }
+    static Mask inverse(Mask a) { return !a; }
+    static Floats select(Mask m, Floats a, Floats b) { return m ? a : b; }
+    static unsigned bits(Mask m) { return m; }
+};
+#endif
+
+/**
+ * Run test on Simd::width candidates at a time, write the candidates that
+ * passed to hits. The last lanes repeat the last candidate and are masked out.
+ */
+template<class Test>
+size_t batch(std::span<const uint32_t> candidates,
+             uint32_t *hits,
+             Test &&test) {
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + Simd::width <= candidates.size(); i += Simd::width) {
+        const unsigned bits = Simd::bits(test(candidates.data() + i));
+        for (size_t lane = 0; lane < Simd::width; lane++) {
+            hits[count] = candidates[i + lane];
+            count += (bits >> lane) & 1u;
+        }
+    }
+    if (i == candidates.size())
+        return count;
+
+    const size_t rest = candidates.size() - i;
+    uint32_t tail[Simd::width];
+    for (size_t lane = 0; lane < Simd::width; lane++)
+        tail[lane] = candidates[std::min(i + lane, candidates.size() - 1)];
+    const unsigned bits = Simd::bits(test(tail));
+    for (size_t lane = 0; lane < rest; lane++) {
+        hits[count] = tail[lane];
+        count += (bits >> lane) & 1u;
+    }
+    return count;
+}
+
+// Circle::overlap(const Rectangle &) with the rectangle given by its center
+// and size
+Simd::Mask circleRectangle(Simd::Floats px,
+                           Simd::Floats py,
+                           Simd::Floats rayon,
+                           Simd::Floats x,
+                           Simd::Floats y,
+                           Simd::Floats width,
+                           Simd::Floats height) {
+    typedef Simd S;
+    const S::Floats two = S::set(2.f);
+    const S::Floats rx = S::sub(x, S::div(width, two));
+    const S::Floats ry = S::sub(y, S::div(height, two));
+    const S::Floats rw = S::add(x, S::div(width, two));
+    const S::Floats rh = S::add(y, S::div(height, two));
+
+    const S::Floats testX = S::select(
+        S::less(px, rx), rx, S::select(S::less(rw, px), rw, px));
+    const S::Floats testY = S::select(
+        S::less(py, ry), ry, S::select(S::less(rh, py), rh, py));
+
+    const S::Floats dx = S::sub(px, testX);
+    const S::Floats dy = S::sub(py, testY);
+    return S::lessEqual(S::add(S::mul(dx, dx), S::mul(dy, dy)),
+                        S::mul(rayon, rayon));
+}
+
+// Point::overlap(const Rectangle &)
+Simd::Mask pointRectangle(Simd::Floats px,
+                          Simd::Floats py,
+                          Simd::Floats x,
+                          Simd::Floats y,
+                          Simd::Floats width,
+                          Simd::Floats height) {
+    typedef Simd S;
+    const S::Floats two = S::set(2.f);
+    const S::Floats dx = S::div(width, two);
+    const S::Floats dy = S::div(height, two);
+    return S::both(S::both(S::lessEqual(S::sub(x, dx), px),
+                           S::lessEqual(px, S::add(x, dx))),
+                   S::both(S::lessEqual(S::sub(y, dy), py),
+                           S::lessEqual(py, S::add(y, dy))));
+}
+
+// (a - b).length2() <= r * r
+Simd::Mask within(Simd::Floats ax,
+                  Simd::Floats ay,
+                  Simd::Floats bx,
+                  Simd::Floats by,
+                  Simd::Floats r) {
+    typedef Simd S;
+    const S::Floats dx = S::sub(ax, bx);
+    const S::Floats dy = S::sub(ay, by);
+    return S::lessEqual(S::add(S::mul(dx, dx), S::mul(dy, dy)), S::mul(r, r));
+}
+
+// One CollisionResolution per lane
+struct Resolutions {
+    Simd::Mask collision;
+    Simd::Floats pointX, pointY, normalX, normalY;
+    Simd::Floats bounceX, bounceY, shiftX, shiftY;
+};
+
+// m ? a : b, lane by lane
+Simd::Mask choose(Simd::Mask m, Simd::Mask a, Simd::Mask b) {
+    return Simd::either(Simd::both(m, a), Simd::both(Simd::inverse(m), b));
+}
+
+Resolutions choose(Simd::Mask m, const Resolutions &a, const Resolutions &b) {
+    typedef Simd S;
+    return {choose(m, a.collision, b.collision),
+            S::select(m, a.pointX, b.pointX),
+            S::select(m, a.pointY, b.pointY),
+            S::select(m, a.normalX, b.normalX),
+            S::select(m, a.normalY, b.normalY),
+            S::select(m, a.bounceX, b.bounceX),
+            S::select(m, a.bounceY, b.bounceY),
+            S::select(m, a.shiftX, b.shiftX),
+            S::select(m, a.shiftY, b.shiftY)};
+}
+
+// the empty CollisionResolution in every lane
+Resolutions none() {
+    const Simd::Floats zero = Simd::set(0.f);
+    return {Simd::less(zero, zero), zero, zero, zero, zero, zero, zero, zero,
+            zero};
+}
+
+// the lanes out of m are the empty CollisionResolution
+Resolutions keep(Simd::Mask m, const Resolutions &a) {
+    return choose(m, a, none());
+}
+
+/**
+ * Run resolve on Simd::width pairs at a time and write the resolutions of
+ * the pairs to results. The last lanes repeat the last pair.
+ */
+template<class Resolve>
+void resolveLanes(std::span<const uint32_t> movers,
+                  std::span<const uint32_t> targets,
+                  CollisionResolution *results,
+                  Resolve &&resolve) {
+    uint32_t m[Simd::width], t[Simd::width];
+    float lanes[8][Simd::width];
+    for (size_t i = 0; i < movers.size(); i += Simd::width) {
+        for (size_t lane = 0; lane < Simd::width; lane++) {
+            const size_t pair = std::min(i + lane, movers.size() - 1);
+            m[lane] = movers[pair];
+            t[lane] = targets[pair];
+        }
+        const Resolutions r = resolve(m, t);
+        Simd::store(lanes[0], r.pointX);
+        Simd::store(lanes[1], r.pointY);
+        Simd::store(lanes[2], r.normalX);
+        Simd::store(lanes[3], r.normalY);
+        Simd::store(lanes[4], r.bounceX);
+        Simd::store(lanes[5], r.bounceY);
+        Simd::store(lanes[6], r.shiftX);
+        Simd::store(lanes[7], r.shiftY);
+        const unsigned bits = Simd::bits(r.collision);
+        const size_t count = std::min(Simd::width, movers.size() - i);
+        for (size_t lane = 0; lane < count; lane++)
+            results[i + lane] = {((bits >> lane) & 1u) != 0,
+                                 {lanes[0][lane], lanes[1][lane]},
+                                 {lanes[2][lane], lanes[3][lane]},
+                                 {lanes[4][lane], lanes[5][lane]},
+                                 {lanes[6][lane], lanes[7][lane]}};
+    }
+}
+
+// bounce and shift of a resolution once its point and normal are known, as
+// in Circle::resolve
+void slide(Resolutions &r, Simd::Floats dx, Simd::Floats dy) {
+    typedef Simd S;
+    const S::Floats fdX = S::sub(dx, r.pointX);
+    const S::Floats fdY = S::sub(dy, r.pointY);
+    const S::Floats two = S::set(2.f);
+    const S::Floats along = S::add(S::mul(r.normalX, fdX),
+                                   S::mul(r.normalY, fdY));
+    r.bounceX = S::add(
+        S::sub(r.pointX, S::mul(along, S::mul(two, r.normalX))), fdX);
+    r.bounceY = S::add(
+        S::sub(r.pointY, S::mul(along, S::mul(two, r.normalY))), fdY);
+    // u = normal.rotate(), -0 - x is -x even for the zeros
+    const S::Floats uX = r.normalY;
+    const S::Floats uY = S::sub(S::set(-0.f), r.normalX);
+    const S::Floats across = S::add(S::mul(uX, fdX), S::mul(uY, fdY));
+    r.shiftX = S::add(r.pointX, S::mul(across, uX));
+    r.shiftY = S::add(r.pointY, S::mul(across, uY));
+}
+
+// Circle::resolve(const Circle &), the mover at a of rayon going to d and
+// the target at b of rayon rayonB
+Resolutions circleCircle(Simd::Floats ax,
+                         Simd::Floats ay,
+                         Simd::Floats rayon,
+                         Simd::Floats dx,
+                         Simd::Floats dy,
+                         Simd::Floats bx,
+                         Simd::Floats by,
+                         Simd::Floats rayonB) {
+    typedef Simd S;
+    const S::Floats zero = S::set(0.f);
+    const S::Floats rayonAB = S::add(rayon, rayonB);
+    const S::Floats abX = S::sub(bx, ax);
+    const S::Floats abY = S::sub(by, ay);
+    const S::Floats abLength =
+        S::sqrt(S::add(S::mul(abX, abX), S::mul(abY, abY)));
+    const S::Floats adX = S::sub(dx, ax);
+    const S::Floats adY = S::sub(dy, ay);
+    const S::Floats dr = S::add(S::mul(adX, adX), S::mul(adY, adY));
+    const S::Mask reaches =
+        S::inverse(S::lessEqual(S::sqrt(dr), S::sub(abLength, rayonAB)));
+    // most pairs of a batch are too far apart to meet
+    if (S::bits(reaches) == 0)
+        return none();
+
+    // getIntersection with the circle of rayon rayonAB around b
+    const S::Floats determinant =
+        S::sub(S::mul(S::sub(ax, bx), S::sub(S::add(ay, adY), by)),
+               S::mul(S::sub(ay, by), S::sub(S::add(ax, adX), bx)));
+    const S::Floats delta =
+        S::sub(S::mul(S::mul(rayonAB, rayonAB), dr),
+               S::mul(determinant, determinant));
+    const S::Mask crosses = S::inverse(S::lessEqual(delta, zero));
+    const S::Floats root = S::sqrt(delta);
+
+    Resolutions r;
+    // (AD.rotate() * determinant - AD * root) / dr + b
+    r.pointX = S::add(
+        S::div(S::sub(S::mul(determinant, adY), S::mul(root, adX)), dr), bx);
+    r.pointY = S::add(
+        S::div(S::sub(S::mul(determinant, S::sub(S::set(-0.f), adX)),
+                      S::mul(root, adY)),
+               dr),
+        by);
+    const S::Floats afX = S::sub(r.pointX, ax);
+    const S::Floats afY = S::sub(r.pointY, ay);
+    r.collision = S::either(
+        S::greater(S::add(S::mul(adX, afX), S::mul(adY, afY)), zero),
+        S::less(abLength, rayonAB));
+
+    const S::Floats nX = S::sub(bx, r.pointX);
+    const S::Floats nY = S::sub(by, r.pointY);
+    const S::Floats nLength = S::sqrt(S::add(S::mul(nX, nX), S::mul(nY, nY)));
+    r.normalX = S::div(nX, nLength);
+    r.normalY = S::div(nY, nLength);
+    slide(r, dx, dy);
+    return keep(S::both(reaches, crosses), r);
+}
+
+// Circle::resolve(const Line &)
+Resolutions circleLine(Simd::Floats ax,
+                       Simd::Floats ay,
+                       Simd::Floats rayon,
+                       Simd::Floats dx,
+                       Simd::Floats dy,
+                       Simd::Floats lax,
+                       Simd::Floats lay,
+                       Simd::Floats lbx,
+                       Simd::Floats lby) {
+    typedef Simd S;
+    const S::Floats zero = S::set(0.f);
+    const S::Floats two = S::set(2.f);
+
+    // c = line.closestPointTo(a)
+    const S::Floats a1 = S::sub(lby, lay);
+    const S::Floats b1 = S::sub(lax, lbx);
+    const S::Floats c1 = S::add(S::mul(a1, lax), S::mul(b1, lay));
+    const S::Floats c2 = S::sub(S::mul(a1, ay), S::mul(b1, ax));
+    const S::Floats det = S::add(S::mul(a1, a1), S::mul(b1, b1));
+    const S::Mask flat = S::equal(det, zero);
+    const S::Floats cx = S::select(
+        flat,
+        ax,
+        S::div(S::sub(S::mul(a1, c1), S::mul(b1, c2)), det));
+    const S::Floats cy = S::select(
+        flat,
+        ay,
+        S::div(S::add(S::mul(a1, c2), S::mul(b1, c1)), det));
+
+    const S::Floats caX = S::sub(ax, cx);
+    const S::Floats caY = S::sub(ay, cy);
+    const S::Floats adX = S::sub(dx, ax);
+    const S::Floats adY = S::sub(dy, ay);
+    const S::Floats caLength =
+        S::sqrt(S::add(S::mul(caX, caX), S::mul(caY, caY)));
+    const S::Floats ad2 = S::add(S::mul(adX, adX), S::mul(adY, adY));
+    const S::Mask approaches = S::both(
+        S::both(S::lessEqual(caLength, S::add(rayon, S::sqrt(ad2))),
+                S::lessEqual(S::div(S::mul(S::set(3.f), rayon), S::set(4.f)),
+                             caLength)),
+        S::less(S::add(S::mul(caX, adX), S::mul(caY, adY)), zero));
+
+    Resolutions r = none();
+    if (S::bits(approaches) != 0) {
+        r.normalX = S::div(caX, caLength);
+        r.normalY = S::div(caY, caLength);
+
+        // i = line.getIntersection(Line(g, g + AD)), g the point of the circle
+        // nearest to the line
+        const S::Floats gx = S::sub(ax, S::mul(rayon, r.normalX));
+        const S::Floats gy = S::sub(ay, S::mul(rayon, r.normalY));
+        const S::Floats g2x = S::add(gx, adX);
+        const S::Floats g2y = S::add(gy, adY);
+        const S::Floats lX = S::sub(lax, lbx);
+        const S::Floats lY = S::sub(lay, lby);
+        const S::Floats gX = S::sub(gx, g2x);
+        const S::Floats gY = S::sub(gy, g2y);
+        const S::Floats crossed = S::sub(S::mul(lX, gY), S::mul(lY, gX));
+        const S::Floats lineCross = S::sub(S::mul(lax, lby), S::mul(lay, lbx));
+        const S::Floats gCross = S::sub(S::mul(gx, g2y), S::mul(gy, g2x));
+        const S::Mask parallel = S::equal(crossed, zero);
+        const S::Floats ix = S::select(
+            parallel,
+            zero,
+            S::div(S::sub(S::mul(lineCross, gX), S::mul(gCross, lX)), crossed));
+        const S::Floats iy = S::select(
+            parallel,
+            zero,
+            S::div(S::sub(S::mul(lineCross, gY), S::mul(gCross, lY)), crossed));
+
+        const S::Floats mx = S::div(S::add(lax, lbx), two);
+        const S::Floats my = S::div(S::add(lay, lby), two);
+        const S::Floats miX = S::sub(ix, mx);
+        const S::Floats miY = S::sub(iy, my);
+        const S::Floats abX = S::sub(lbx, lax);
+        const S::Floats abY = S::sub(lby, lay);
+        const S::Mask onLine = S::lessEqual(
+            S::sqrt(S::add(S::mul(miX, miX), S::mul(miY, miY))),
+            S::div(S::sqrt(S::add(S::mul(abX, abX), S::mul(abY, abY))), two));
+
+        r.pointX = S::add(ix, S::mul(rayon, r.normalX));
+        r.pointY = S::add(iy, S::mul(rayon, r.normalY));
+        const S::Floats afX = S::sub(r.pointX, ax);
+        const S::Floats afY = S::sub(r.pointY, ay);
+        r.collision = S::both(
+            S::both(approaches, onLine),
+            S::less(S::add(S::mul(afX, afX), S::mul(afY, afY)), ad2));
+        slide(r, dx, dy);
+    }
+
+    // otherwise the nearest end of the line hit
+    const Resolutions r1 =
+        circleCircle(ax, ay, rayon, dx, dy, lax, lay, zero);
+    const Resolutions r2 =
+        circleCircle(ax, ay, rayon, dx, dy, lbx, lby, zero);
+    const S::Floats f1X = S::sub(r1.pointX, ax);
+    const S::Floats f1Y = S::sub(r1.pointY, ay);
+    const S::Floats f2X = S::sub(r2.pointX, ax);
+    const S::Floats f2Y = S::sub(r2.pointY, ay);
+    const S::Mask second = choose(
+        r1.collision,
+        S::both(r2.collision,
+                S::greater(S::add(S::mul(f1X, f1X), S::mul(f1Y, f1Y)),
+                           S::add(S::mul(f2X, f2X), S::mul(f2Y, f2Y)))),
+        r2.collision);
+    return choose(r.collision,
+                  r,
+                  choose(second, r2, keep(r1.collision, r1)));
+}
+
+// Rectangle::resolve(const Rectangle &)
+Resolutions rectangleRectangle(Simd::Floats ax,
+                               Simd::Floats ay,
+                               Simd::Floats width,
+                               Simd::Floats height,
+                               Simd::Floats dx,
+                               Simd::Floats dy,
+                               Simd::Floats bx,
+                               Simd::Floats by,
+                               Simd::Floats widthB,
+                               Simd::Floats heightB) {
+    typedef Simd S;
+    const S::Floats zero = S::set(0.f);
+    const S::Floats two = S::set(2.f);
+    const S::Floats abX = S::sub(bx, ax);
+    const S::Floats abY = S::sub(by, ay);
+    const S::Floats halfX = S::div(S::add(width, widthB), two);
+    const S::Floats halfY = S::div(S::add(height, heightB), two);
+    const S::Floats adX = S::sub(dx, ax);
+    const S::Floats adY = S::sub(dy, ay);
+    const S::Mask reaches = S::inverse(
+        S::either(S::greater(S::abs(abX), S::add(S::abs(adX), halfX)),
+                  S::greater(S::abs(abY), S::add(S::abs(adY), halfY))));
+    if (S::bits(reaches) == 0)
+        return none();
+    const S::Mask overlaps =
+        S::inverse(S::either(S::greater(S::abs(abX), S::abs(halfX)),
+                             S::greater(S::abs(abY), S::abs(halfY))));
+    const S::Floats slope = S::div(S::sub(ay, dy), S::sub(ax, dx));
+    const S::Floats intercept = S::sub(ay, S::mul(ax, slope));
+
+    // through the left or right side
+    Resolutions x;
+    x.pointX = S::select(
+        S::greater(adX, zero), S::sub(bx, halfX), S::add(bx, halfX));
+    x.pointY = S::add(S::mul(x.pointX, slope), intercept);
+    x.normalX = x.normalY = zero;
+    x.shiftX = x.pointX;
+    x.bounceY = x.shiftY = dy;
+    x.bounceX = S::sub(x.pointX, S::sub(dx, x.pointX));
+    const S::Mask sideX = S::lessEqual(S::abs(S::sub(x.pointY, by)), halfY);
+    x.collision = S::either(
+        S::greater(S::add(S::mul(adX, S::sub(x.pointX, ax)),
+                          S::mul(adY, S::sub(x.pointY, ay))),
+                   zero),
+        overlaps);
+
+    // through the top or bottom side
+    Resolutions y;
+    y.pointY = S::select(
+        S::greater(adY, zero), S::sub(by, halfY), S::add(by, halfY));
+    y.pointX = S::div(S::sub(y.pointY, intercept), slope);
+    y.normalX = y.normalY = zero;
+    y.shiftY = y.pointY;
+    y.bounceX = y.shiftX = dx;
+    y.bounceY = S::sub(y.pointY, S::sub(dy, y.pointY));
+    const S::Mask sideY = S::lessEqual(S::abs(S::sub(y.pointX, bx)), halfX);
+    y.collision = S::both(
+        sideY,
+        S::either(S::greater(S::add(S::mul(adX, S::sub(y.pointX, ax)),
+                                    S::mul(adY, S::sub(y.pointY, ay))),
+                             zero),
+                  overlaps));
+
+    return keep(reaches, choose(sideX, x, y));
+}
+
+} // namespace
+
+size_t overlapBatch(const Circle &form,
+                    const PackedForms<Circle> &forms,
+                    std::span<const uint32_t> candidates,
+                    uint32_t *hits) {
+    return batch(
+        candidates,
+        hits,
+        [&](const uint32_t *i) {
+            return within(Simd::set(form.position.x),
+                          Simd::set(form.position.y),
+                          Simd::gather(forms.x, i),
+                          Simd::gather(forms.y, i),
+                          Simd::add(Simd::gather(forms.rayon, i),
+                                    Simd::set(form.rayon)));
+        });
+}
+
+size_t overlapBatch(const Circle &form,
+                    const PackedForms<Rectangle> &forms,
+                    std::span<const uint32_t> candidates,
+                    uint32_t *hits) {
+    return batch(
+        candidates,
+        hits,
+        [&](const uint32_t *i) {
+            return circleRectangle(Simd::set(form.position.x),
+                                   Simd::set(form.position.y),
+                                   Simd::set(form.rayon),
+                                   Simd::gather(forms.x, i),
+                                   Simd::gather(forms.y, i),
+                                   Simd::gather(forms.width, i),
+                                   Simd::gather(forms.height, i));
+        });
+}
+
+size_t overlapBatch(const Circle &form,
+                    const PackedForms<Point> &forms,
+                    std::span<const uint32_t> candidates,
+                    uint32_t *hits) {
+    return batch(
+        candidates,
+        hits,
+        [&](const uint32_t *i) {
+            return within(Simd::set(form.position.x),
+                          Simd::set(form.position.y),
+                          Simd::gather(forms.x, i),
+                          Simd::gather(forms.y, i),
+                          Simd::set(form.rayon));
+        });
+}
+
+size_t overlapBatch(const Rectangle &form,
+                    const PackedForms<Circle> &forms,
+                    std::span<const uint32_t> candidates,
+                    uint32_t *hits) {
+    return batch(
+        candidates,
+        hits,
+        [&](const uint32_t *i) {
+            return circleRectangle(Simd::gather(forms.x, i),
+                                   Simd::gather(forms.y, i),
+                                   Simd::gather(forms.rayon, i),
+                                   Simd::set(form.position.x),
+                                   Simd::set(form.position.y),
+                                   Simd::set(form.size.x),
+                                   Simd::set(form.size.y));
+        });
+}
+
+size_t overlapBatch(const Rectangle &form,
+                    const PackedForms<Rectangle> &forms,
+                    std::span<const uint32_t> candidates,
+                    uint32_t *hits) {
+    return batch(
+        candidates,
+        hits,
+        [&](const uint32_t *i) {
+            typedef Simd S;
+            const S::Floats two = S::set(2.f);
+            const S::Floats dx =
+                S::abs(S::sub(S::gather(forms.x, i), S::set(form.position.x)));
+            const S::Floats dy =
+                S::abs(S::sub(S::gather(forms.y, i), S::set(form.position.y)));
+            const S::Floats width = S::abs(S::div(
+                S::add(S::set(form.size.x), S::gather(forms.width, i)), two));
+            const S::Floats height = S::abs(S::div(
+                S::add(S::set(form.size.y), S::gather(forms.height, i)), two));
+            return S::both(S::notGreater(dx, width),
+                           S::notGreater(dy, height));
+        });
+}
+
+size_t overlapBatch(const Rectangle &form,
+                    const PackedForms<Point> &forms,
+                    std::span<const uint32_t> candidates,
+                    uint32_t *hits) {
+    return batch(
+        candidates,
+        hits,
+        [&](const uint32_t *i) {
+            return pointRectangle(Simd::gather(forms.x, i),
+                                  Simd::gather(forms.y, i),
+                                  Simd::set(form.position.x),
+                                  Simd::set(form.position.y),
+                                  Simd::set(form.size.x),
+                                  Simd::set(form.size.y));
+        });
+}
+
+size_t overlapBatch(const Point &form,
+                    const PackedForms<Circle> &forms,
+                    std::span<const uint32_t> candidates,
+                    uint32_t *hits) {
+    return batch(
+        candidates,
+        hits,
+        [&](const uint32_t *i) {
+            return within(Simd::set(form.x),
+                          Simd::set(form.y),
+                          Simd::gather(forms.x, i),
+                          Simd::gather(forms.y, i),
+                          Simd::gather(forms.rayon, i));
+        });
+}
+
+size_t overlapBatch(const Point &form,
+                    const PackedForms<Rectangle> &forms,
+                    std::span<const uint32_t> candidates,
+                    uint32_t *hits) {
+    return batch(
+        candidates,
+        hits,
+        [&](const uint32_t *i) {
+            return pointRectangle(Simd::set(form.x),
+                                  Simd::set(form.y),
+                                  Simd::gather(forms.x, i),
+                                  Simd::gather(forms.y, i),
+                                  Simd::gather(forms.width, i),
+                                  Simd::gather(forms.height, i));
+        });
+}
+
+void resolveBatch(const PackedForms<Circle> &movers,
+                  const PackedForms<Point> &destinations,
+                  const PackedForms<Circle> &targets,
+                  std::span<const uint32_t> moverIndices,
+                  std::span<const uint32_t> targetIndices,
+                  CollisionResolution *results) {
+    resolveLanes(moverIndices,
+                 targetIndices,
+                 results,
+                 [&](const uint32_t *m, const uint32_t *t) {
+                     return circleCircle(Simd::gather(movers.x, m),
+                                         Simd::gather(movers.y, m),
+                                         Simd::gather(movers.rayon, m),
+                                         Simd::gather(destinations.x, m),
+                                         Simd::gather(destinations.y, m),
+                                         Simd::gather(targets.x, t),
+                                         Simd::gather(targets.y, t),
+                                         Simd::gather(targets.rayon, t));
+                 });
+}
+
+void resolveBatch(const PackedForms<Circle> &movers,
+                  const PackedForms<Point> &destinations,
+                  const PackedForms<Line> &targets,
+                  std::span<const uint32_t> moverIndices,
+                  std::span<const uint32_t> targetIndices,
+                  CollisionResolution *results) {
+    resolveLanes(moverIndices,
+                 targetIndices,
+                 results,
+                 [&](const uint32_t *m, const uint32_t *t) {
+                     return circleLine(Simd::gather(movers.x, m),
+                                       Simd::gather(movers.y, m),
+                                       Simd::gather(movers.rayon, m),
+                                       Simd::gather(destinations.x, m),
+                                       Simd::gather(destinations.y, m),
+                                       Simd::gather(targets.ax, t),
+                                       Simd::gather(targets.ay, t),
+                                       Simd::gather(targets.bx, t),
+                                       Simd::gather(targets.by, t));
+                 });
+}
+
+void resolveBatch(const PackedForms<Rectangle> &movers,
+                  const PackedForms<Point> &destinations,
+                  const PackedForms<Rectangle> &targets,
+                  std::span<const uint32_t> moverIndices,
+                  std::span<const uint32_t> targetIndices,
+                  CollisionResolution *results) {
+    resolveLanes(moverIndices,
+                 targetIndices,
+                 results,
+                 [&](const uint32_t *m, const uint32_t *t) {
+                     return rectangleRectangle(
+                         Simd::gather(movers.x, m),
+                         Simd::gather(movers.y, m),
+                         Simd::gather(movers.width, m),
+                         Simd::gather(movers.height, m),
+                         Simd::gather(destinations.x, m),
+                         Simd::gather(destinations.y, m),
+                         Simd::gather(targets.x, t),
+                         Simd::gather(targets.y, t),
+                         Simd::gather(targets.width, t),
+                         Simd::gather(targets.height, t));
+                 });
+}
+
+} // namespace Blob
@@ -1,5 +1,7 @@
 #include <Blob/Collision/Forms.hpp>
 
+#include <cmath>
+
 namespace Blob {
 
 bool Point::overlap(const Rectangle &rectangle) const {
@@ -15,10 +17,9 @@ bool Point::overlap(const Circle &circle) const {
     return operator-(circle.position).length2() <= circle.rayon * circle.rayon;
 }
 
-std::unordered_set<Vec2<int32_t>> Point::rasterize() const {
-    std::unordered_set<Vec2<int32_t>> points;
-    points.emplace(cast<int32_t>());
-    return points;
+CellRange Point::rasterize() const {
+    const Vec2<int32_t> cell{(int32_t) std::floor(x), (int32_t) std::floor(y)};
+    return {cell, cell};
 }
 
 } // namespace Blob
@@ -0,0 +1,502 @@
+#include <Blob/Collision/Forms.hpp>
+#include <Blob/Core/Exception.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace Blob {
+
+namespace {
+
+// from this size the support function climbs instead of testing every vertex
+constexpr size_t climbingSize = 32;
+
+// Andrew's monotone chain, counterclockwise without aligned vertices
+std::vector<Vec2<>> convexHull(std::vector<Vec2<>> points) {
+    std::sort(points.begin(), points.end(), [](const auto &a, const auto &b) {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    });
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    if (points.size() < 3)
+        return points;
+
+    std::vector<Vec2<>> hull(points.size() * 2);
+    size_t k = 0;
+    auto turnsLeft = [&](const Vec2<> &point) {
+        return Vec2<>(hull[k - 2], hull[k - 1])
+                   .cross(Vec2<>(hull[k - 2], point)) > 0;
+    };
+    for (const Vec2<> &point : points) {
+        while (k >= 2 && !turnsLeft(point))
+            k--;
+        hull[k++] = point;
+    }
+    for (size_t i = points.size() - 1, lower = k + 1; i-- > 0;) {
+        while (k >= lower && !turnsLeft(points[i]))
+            k--;
+        hull[k++] = points[i];
+    }
+    hull.resize(k - 1);
+    return hull;
+}
+
+// Triple product expansion is used to calculate perpendicular normal vectors
+// which kinda 'prefer' pointing towards the Origin in Minkowski space
+Vec2<> tripleProduct(const Vec2<> &a, const Vec2<> &b, const Vec2<> &c) {
+    return b * a.dot(c) - a * b.dot(c);
+}
+
+// Support function of a polygon, remembering the last vertex for the climb
+struct PolygonSupport {
+    const Polygon &polygon;
+    size_t hint = 0;
+
+    Vec2<> operator()(const Vec2<> &direction) {
+        hint = polygon.support(direction, hint);
+        return polygon.vertex(hint);
+    }
+};
+
+// Support function of a few vertices
+struct VerticesSupport {
+    const Vec2<> *vertices;
+    size_t count;
+
+    Vec2<> operator()(const Vec2<> &direction) const {
+        size_t best = 0;
+        for (size_t i = 1; i < count; i++)
+            if (direction.dot(vertices[i]) > direction.dot(vertices[best]))
+                best = i;
+        return vertices[best];
+    }
+};
+
+/**
+ * The GJK yes/no test on the Minkowski difference of a and b
+ * @param simplex the triangle of the difference holding the origin, if true
+ */
+template<class A, class B>
+bool gjk(A &a, B &b, Vec2<> d, std::array<Vec2<>, 3> &simplex) {
+    auto support = [&](const Vec2<> &direction) {
+        return a(direction) - b(direction.negate());
+    };
+
+    // if initial direction is zero - set it to any arbitrary axis (we choose X)
+    if (d.isNull())
+        d.x = 1.f;
+
+    // set the first support as initial point of the new simplex. A support
+    // reaching the origin without passing it means the forms touch, which is
+    // an overlap: the tests below keep the origin on the border as inside.
+    size_t index = 0;
+    Vec2<> point = simplex[0] = support(d);
+    if (point.dot(d) < 0)
+        return false;
+
+    // The next search direction is always towards the origin, or backwards
+    // when the first support is the origin
+    d = point.isNull() ? d.negate() : point.negate();
+
+    // the difference of two convex polygons has few vertices, the bound only
+    // stops the rounding errors from cycling
+    for (int iteration = 0; iteration < 64; iteration++) {
+        point = simplex[++index] = support(d);
+        if (point.dot(d) < 0)
+            return false;
+
+        const Vec2<> ao = point.negate();
+
+        // simplex has 2 points (a line segment, not a triangle yet)
+        if (index < 2) {
+            const Vec2<> ab = simplex[0] - point;
+            d = tripleProduct(ab, ao, ab); // normal to AB towards Origin
+            // the origin is on AB, the third point is on the side where the
+            // difference goes beyond it
+            if (d.isNull()) {
+                d = ab.rotate();
+                if (support(d).dot(d) <= 0)
+                    d = d.negate();
+            }
+            continue;
+        }
+
+        const Vec2<> ab = simplex[1] - point;
+        const Vec2<> ac = simplex[0] - point;
+        const Vec2<> acperp = tripleProduct(ab, ac, ac);
+
+        if (acperp.dot(ao) > 0)
+            d = acperp; // new direction is normal to AC towards Origin
+        else {
+            const Vec2<> abperp = tripleProduct(ac, ab, ab);
+            // the origin is in the triangle or on its border
+            if (abperp.dot(ao) <= 0)
+                return true;
+            simplex[0] = simplex[1]; // swap first element (point C)
+            d = abperp; // new direction is normal to AB towards Origin
+        }
+
+        simplex[1] = simplex[2]; // swap element in the middle (point B)
+        --index;
+    }
+    return false;
+}
+
+/**
+ * EPA: expand the GJK simplex towards the border of the Minkowski difference
+ * of a and b nearest to the origin
+ */
+template<class A, class B>
+Penetration epa(A &a, B &b, const std::array<Vec2<>, 3> &simplex) {
+    std::vector<Vec2<>> polytope(simplex.begin(), simplex.end());
+    if (Vec2<>(polytope[0], polytope[1])
+            .cross(Vec2<>(polytope[0], polytope[2])) < 0)
+        std::swap(polytope[1], polytope[2]);
+
+    Penetration nearest{};
+    for (int iteration = 0; iteration < 64; iteration++) {
+        // edge of the polytope nearest to the origin
+        size_t nearestEdge = 0;
+        nearest.depth = std::numeric_limits<float>::infinity();
+        for (size_t i = 0; i < polytope.size(); i++) {
+            const Vec2<> &from = polytope[i];
+            const Vec2<> &to = polytope[(i + 1) % polytope.size()];
+            const Vec2<> edge{from, to};
+            if (edge.isNull())
+                continue;
+            const Vec2<> normal = edge.rotate().normalize();
+            const float distance = normal.dot(from);
+            if (distance < nearest.depth) {
+                nearest = {distance, normal};
+                nearestEdge = i;
+            }
+        }
+
+        const Vec2<> point = a(nearest.normal) - b(nearest.normal.negate());
+        const float distance = nearest.normal.dot(point);
+        if (distance - nearest.depth <= 1e-4f * std::max(1.f, distance))
+            break;
+        polytope.insert(polytope.begin() + nearestEdge + 1, point);
+    }
+    nearest.depth = std::max(nearest.depth, 0.f);
+    return nearest;
+}
+
+// nearest point of the segment [a, b] to point
+Vec2<> closestOnSegment(const Vec2<> &a, const Vec2<> &b, const Vec2<> &point) {
+    const Vec2<> ab{a, b};
+    const float length2 = ab.length2();
+    if (length2 == 0)
+        return a;
+    const float t = std::clamp(ab.dot(Vec2<>(a, point)) / length2, 0.f, 1.f);
+    return a + ab * t;
+}
+
+} // namespace
+
+Polygon::Polygon(const std::vector<Vec2<>> &vertices,
+                 const Vec2<> &position,
+                 float angle) :
+    position(position),
+    angle(angle) {
+    Vertices hull{convexHull(vertices), {}, {}};
+    if (hull.points.size() < 3)
+        throw Exception("A polygon needs 3 vertices not aligned");
+    for (const Vec2<> &point : hull.points) {
+        hull.x.push_back(point.x);
+        hull.y.push_back(point.y);
+    }
+    local = std::make_shared<const Vertices>(std::move(hull));
+    transform();
+}
+
+void Polygon::transform() {
+    cosAngle = std::cos(angle);
+    sinAngle = std::sin(angle);
+    const Vec2<> first = turn(local->points[0]);
+    extent = {first, first};
+    for (const Vec2<> &point : local->points) {
+        const Vec2<> turned = turn(point);
+        extent = extent.merge({turned, turned});
+    }
+    box = {position + extent.min, position + extent.max};
+}
+
+const std::vector<Vec2<>> &Polygon::getLocalVertices() const {
+    static const std::vector<Vec2<>> none;
+    return local ? local->points : none;
+}
+
+void Polygon::setPosition(const Vec2<> &newPosition) {
+    position = newPosition;
+    box = {position + extent.min, position + extent.max};
+}
+
+void Polygon::setAngle(float newAngle) {
+    angle = newAngle;
+    if (local)
+        transform();
+}
+
+size_t Polygon::support(const Vec2<> &worldDirection, size_t hint) const {
+    // the vertices are compared around the origin, before turning them
+    const Vec2<> direction{
+        worldDirection.x * cosAngle + worldDirection.y * sinAngle,
+        worldDirection.y * cosAngle - worldDirection.x * sinAngle};
+    const size_t count = size();
+    if (!count)
+        return 0;
+    const std::vector<float> &x = local->x, &y = local->y;
+    auto dot = [&](size_t i) {
+        return direction.x * x[i] + direction.y * y[i];
+    };
+
+    if (count >= climbingSize) {
+        // the dot product along a convex polygon has a single maximum, climb
+        // towards it from the hint
+        size_t best = hint < count ? hint : 0;
+        float bestDot = dot(best);
+        const size_t next = best + 1 == count ? 0 : best + 1;
+        const size_t step = dot(next) > bestDot ? 1 : count - 1;
+        for (size_t i = 0; i < count; i++) {
+            const size_t candidate = (best + step) % count;
+            const float candidateDot = dot(candidate);
+            if (candidateDot <= bestDot)
+                break;
+            best = candidate;
+            bestDot = candidateDot;
+        }
+        return best;
+    }
+
+    size_t best = 0;
+    size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+    if (count >= 8) {
+        const __m128 dx = _mm_set1_ps(direction.x);
+        const __m128 dy = _mm_set1_ps(direction.y);
+        __m128 bestDots = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+        __m128i bestIndices = _mm_setzero_si128();
+        __m128i indices = _mm_setr_epi32(0, 1, 2, 3);
+        for (; i + 4 <= count; i += 4) {
+            const __m128 dots =
+                _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(x.data() + i), dx),
+                           _mm_mul_ps(_mm_loadu_ps(y.data() + i), dy));
+            const __m128i better =
+                _mm_castps_si128(_mm_cmpgt_ps(dots, bestDots));
+            bestDots = _mm_max_ps(bestDots, dots);
+            bestIndices = _mm_or_si128(_mm_and_si128(better, indices),
+                                       _mm_andnot_si128(better, bestIndices));
+            indices = _mm_add_epi32(indices, _mm_set1_epi32(4));
+        }
+        alignas(16) float laneDots[4];
+        alignas(16) int32_t laneIndices[4];
+        _mm_store_ps(laneDots, bestDots);
+        _mm_store_si128((__m128i *) laneIndices, bestIndices);
+        best = (size_t) laneIndices[0];
+        for (int lane = 1; lane < 4; lane++)
+            if (laneDots[lane] > laneDots[0] ||
+                (laneDots[lane] == laneDots[0] &&
+                 (size_t) laneIndices[lane] < best)) {
+                laneDots[0] = laneDots[lane];
+                best = (size_t) laneIndices[lane];
+            }
+    }
+#endif
+    for (; i < count; i++)
+        if (dot(i) > dot(best))
+            best = i;
+    return best;
+}
+
+bool Polygon::overlap(const Rectangle &rectangle) const {
+    if (!size() || !box.overlap(rectangle.bounds()))
+        return false;
+    const auto points = rectangle.getPoints();
+    PolygonSupport a{*this};
+    VerticesSupport b{points.data(), points.size()};
+    std::array<Vec2<>, 3> simplex;
+    return gjk(a, b, box.center() - rectangle.position, simplex);
+}
+
+bool Polygon::overlap(const Circle &circle) const {
+    if (!size() || !box.overlap(circle.bounds()))
+        return false;
+    if (overlap(circle.position))
+        return true;
+    const float rayon2 = circle.rayon * circle.rayon;
+    for (size_t i = 0; i < size(); i++) {
+        const Vec2<> closest =
+            closestOnSegment(vertex(i), vertex(next(i)), circle.position);
+        if (Vec2<>(closest, circle.position).length2() <= rayon2)
+            return true;
+    }
+    return false;
+}
+
+bool Polygon::overlap(const Line &line) const {
+    if (!size() || !box.overlap(line.bounds()))
+        return false;
+    const Vec2<> points[2] = {line.positionA, line.positionB};
+    PolygonSupport a{*this};
+    VerticesSupport b{points, 2};
+    std::array<Vec2<>, 3> simplex;
+    return gjk(a, b, box.center() - line.bounds().center(), simplex);
+}
+
+bool Polygon::overlap(const Point &point) const {
+    if (!size())
+        return false;
+    for (size_t i = 0; i < size(); i++) {
+        const Vec2<> from = vertex(i);
+        const Vec2<> edge{from, vertex(next(i))};
+        if (edge.cross(Vec2<>(from, point)) < 0)
+            return false;
+    }
+    return true;
+}
+
+bool Polygon::overlap(const Polygon &polygon) const {
+    if (!size() || !polygon.size() || !box.overlap(polygon.box))
+        return false;
+    PolygonSupport a{*this};
+    PolygonSupport b{polygon};
+    std::array<Vec2<>, 3> simplex;
+    return gjk(a, b, box.center() - polygon.box.center(), simplex);
+}
+
+std::optional<Penetration> Polygon::penetration(const Polygon &polygon) const {
+    if (!size() || !polygon.size() || !box.overlap(polygon.box))
+        return std::nullopt;
+    PolygonSupport a{*this};
+    PolygonSupport b{polygon};
+    std::array<Vec2<>, 3> simplex;
+    if (!gjk(a, b, box.center() - polygon.box.center(), simplex))
+        return std::nullopt;
+    return epa(a, b, simplex);
+}
+
+std::optional<Penetration>
+Polygon::penetration(const Rectangle &rectangle) const {
+    if (!size() || !box.overlap(rectangle.bounds()))
+        return std::nullopt;
+    const auto points = rectangle.getPoints();
+    PolygonSupport a{*this};
+    VerticesSupport b{points.data(), points.size()};
+    std::array<Vec2<>, 3> simplex;
+    if (!gjk(a, b, box.center() - rectangle.position, simplex))
+        return std::nullopt;
+    return epa(a, b, simplex);
+}
+
+std::optional<Penetration> Polygon::penetration(const Circle &circle) const {
+    if (!size() || !box.overlap(circle.bounds()))
+        return std::nullopt;
+
+    // outside: push along the nearest point of the border
+    if (!overlap(circle.position)) {
+        Vec2<> nearest = vertex(0);
+        float nearestDistance2 = std::numeric_limits<float>::infinity();
+        for (size_t i = 0; i < size(); i++) {
+            const Vec2<> closest =
+                closestOnSegment(vertex(i), vertex(next(i)), circle.position);
+            const float distance2 =
+                Vec2<>(closest, circle.position).length2();
+            if (distance2 < nearestDistance2) {
+                nearest = closest;
+                nearestDistance2 = distance2;
+            }
+        }
+        const float distance = std::sqrt(nearestDistance2);
+        if (distance > circle.rayon)
+            return std::nullopt;
+        if (distance > 0)
+            return Penetration{circle.rayon - distance,
+                               Vec2<>(nearest, circle.position) / distance};
+    }
+
+    // inside: push through the nearest edge
+    Penetration nearest{std::numeric_limits<float>::infinity(), {}};
+    for (size_t i = 0; i < size(); i++) {
+        const Vec2<> from = vertex(i);
+        const Vec2<> normal =
+            Vec2<>(from, vertex(next(i))).rotate().normalize();
+        const float depth =
+            circle.rayon - normal.dot(Vec2<>(from, circle.position));
+        if (depth < nearest.depth)
+            nearest = {depth, normal};
+    }
+    return nearest;
+}
+
+std::optional<RayHit> Polygon::raycast(const Vec2<> &origin,
+                                       const Vec2<> &direction,
+                                       float maxDistance) const {
+    if (!size() || box.rayEntry(origin, direction, maxDistance) ==
+                       std::numeric_limits<float>::infinity())
+        return std::nullopt;
+
+    // clip the ray by the half plane of every edge
+    float near = 0, far = maxDistance;
+    Vec2<> normal = -direction;
+    for (size_t i = 0; i < size(); i++) {
+        const Vec2<> from = vertex(i);
+        const Vec2<> outward = Vec2<>(from, vertex(next(i))).rotate();
+        const float speed = outward.dot(direction);
+        const float distance = outward.dot(Vec2<>(origin, from));
+        if (speed == 0) {
+            if (distance < 0)
+                return std::nullopt;
+            continue;
+        }
+        const float t = distance / speed;
+        if (speed < 0) {
+            if (t > near) {
+                near = t;
+                normal = outward.normalize();
+            }
+        } else
+            far = std::min(far, t);
+        if (near > far)
+            return std::nullopt;
+    }
+    return RayHit{near, normal};
+}
+
+float Polygon::distance(const Vec2<> &point) const {
+    if (overlap(Point(point)))
+        return 0;
+    float nearest2 = std::numeric_limits<float>::infinity();
+    for (size_t i = 0; i < size(); i++)
+        nearest2 = std::min(
+            nearest2,
+            Vec2<>(closestOnSegment(vertex(i), vertex(next(i)), point), point)
+                .length2());
+    return std::sqrt(nearest2);
+}
+
+CellRange Polygon::rasterize() const {
+    return {{(int32_t) std::floor(box.min.x), (int32_t) std::floor(box.min.y)},
+            {(int32_t) std::floor(box.max.x), (int32_t) std::floor(box.max.y)}};
+}
+
+bool Point::overlap(const Polygon &polygon) const {
+    return polygon.overlap(*this);
+}
+
+bool Circle::overlap(const Polygon &polygon) const {
+    return polygon.overlap(*this);
+}
+
+bool Line::overlap(const Polygon &polygon) const {
+    return polygon.overlap(*this);
+}
+
+bool Rectangle::overlap(const Polygon &polygon) const {
+    return polygon.overlap(*this);
+}
+
+} // namespace Blob
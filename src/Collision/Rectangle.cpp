@@ -1,18 +1,106 @@
 #include <Blob/Collision/Forms.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
 namespace Blob {
-std::unordered_set<Vec2<int32_t>> Rectangle::rasterize() const {
-    std::unordered_set<Vec2<int32_t>> points;
-    auto startx = (int64_t) (position.x - size.x / 2);
-    auto endx = (int64_t) (position.x + size.x / 2);
-    auto starty = (int64_t) (position.y - size.y / 2);
-    auto endy = (int64_t) (position.y + size.y / 2);
 
-    for (int i = startx; i <= endx; i++)
-        for (int j = starty; j <= endy; j++)
-            points.emplace(Vec2{i, j});
+namespace {
+
+// Where a rectangle moving along direction first touches a convex polygon, its
+// vertices given by vertex(i), or a segment by its two ends. On every axis
+// separating them, the axes of the rectangle and the normals of the polygon,
+// the projection of the rectangle overlaps the polygon during an interval of
+// the motion: they touch from the last start to the first end.
+template<class Vertex>
+std::optional<RayHit> sweepAxes(const Rectangle &rectangle,
+                                const Vec2<> &direction,
+                                float maxDistance,
+                                size_t count,
+                                Vertex &&vertex) {
+    float enter = -std::numeric_limits<float>::infinity();
+    float exit = std::numeric_limits<float>::infinity();
+    Vec2<> normal = -direction;
+
+    auto axis = [&](const Vec2<> &n) {
+        float low = std::numeric_limits<float>::infinity();
+        float high = -low;
+        for (size_t i = 0; i < count; i++) {
+            const float projection = n.dot(vertex(i));
+            low = std::min(low, projection);
+            high = std::max(high, projection);
+        }
+        const float center = n.dot(rectangle.position);
+        const float half = (std::abs(n.x) * rectangle.size.x +
+                            std::abs(n.y) * rectangle.size.y) /
+                           2;
+        const float speed = n.dot(direction);
+        if (speed == 0)
+            return center + half >= low && center - half <= high;
+        float t1 = (low - half - center) / speed;
+        float t2 = (high + half - center) / speed;
+        if (t1 > t2)
+            std::swap(t1, t2);
+        if (t1 > enter) {
+            enter = t1;
+            normal = speed > 0 ? -n : n;
+        }
+        exit = std::min(exit, t2);
+        return enter <= exit;
+    };
+
+    if (!axis({1, 0}) || !axis({0, 1}))
+        return std::nullopt;
+    for (size_t i = 0; i < count; i++) {
+        const Vec2<> edge{vertex(i), vertex(i + 1 == count ? 0 : i + 1)};
+        if (!edge.isNull() && !axis(edge.rotate().normalize()))
+            return std::nullopt;
+    }
+    if (exit < 0 || enter > maxDistance)
+        return std::nullopt;
+    if (enter <= 0)
+        return RayHit{0, -direction};
+    return RayHit{enter, normal};
+}
+
+} // namespace
+
+CellRange Rectangle::rasterize() const {
+    return {{(int32_t) std::floor(position.x - size.x / 2),
+             (int32_t) std::floor(position.y - size.y / 2)},
+            {(int32_t) std::floor(position.x + size.x / 2),
+             (int32_t) std::floor(position.y + size.y / 2)}};
+}
 
-    return points;
+std::optional<RayHit> Rectangle::raycast(const Vec2<> &origin,
+                                         const Vec2<> &direction,
+                                         float maxDistance) const {
+    const Box box = bounds();
+    float near = 0, far = maxDistance;
+    Vec2<> normal = -direction;
+
+    auto slab = [&](float o, float d, float low, float high, Vec2<> axis) {
+        if (d == 0)
+            return o >= low && o <= high;
+        float t1 = (low - o) / d, t2 = (high - o) / d;
+        if (t1 > t2) {
+            std::swap(t1, t2);
+            axis = -axis;
+        }
+        // entering through the low side faces -axis
+        if (t1 > near) {
+            near = t1;
+            normal = -axis;
+        }
+        far = std::min(far, t2);
+        return near <= far;
+    };
+
+    if (!slab(origin.x, direction.x, box.min.x, box.max.x, {1, 0}) ||
+        !slab(origin.y, direction.y, box.min.y, box.max.y, {0, 1}))
+        return std::nullopt;
+    return RayHit{near, normal};
 }
 
 std::array<Vec2<>, 4> Rectangle::getPoints() const {
@@ -96,4 +184,62 @@ CollisionResolution Rectangle::resolve(const Point &point, Vec2<> D) const {
     return resolve(Rectangle{point, {}}, D);
 }
 
+std::optional<RayHit> Rectangle::sweep(const Vec2<> &direction,
+                                       float maxDistance,
+                                       const Rectangle &form) const {
+    return Rectangle(form.position, form.size + size)
+        .raycast(position, direction, maxDistance);
+}
+
+std::optional<RayHit> Rectangle::sweep(const Vec2<> &direction,
+                                       float maxDistance,
+                                       const Circle &form) const {
+    // the circle moving the other way touches the rectangle at the same time
+    auto hit = form.sweep(-direction, maxDistance, *this);
+    if (hit)
+        hit->normal = hit->distance == 0 ? -direction : -hit->normal;
+    return hit;
+}
+
+std::optional<RayHit> Rectangle::sweep(const Vec2<> &direction,
+                                       float maxDistance,
+                                       const Point &form) const {
+    return Rectangle(form, size).raycast(position, direction, maxDistance);
+}
+
+std::optional<RayHit> Rectangle::sweep(const Vec2<> &direction,
+                                       float maxDistance,
+                                       const Line &form) const {
+    const Vec2<> ends[2] = {form.positionA, form.positionB};
+    return sweepAxes(
+        *this, direction, maxDistance, 2, [&](size_t i) { return ends[i]; });
+}
+
+std::optional<RayHit> Rectangle::sweep(const Vec2<> &direction,
+                                       float maxDistance,
+                                       const Polygon &form) const {
+    return sweepAxes(*this,
+                     direction,
+                     maxDistance,
+                     form.size(),
+                     [&](size_t i) { return form.vertex(i); });
+}
+
+std::optional<RayHit> Rectangle::sweep(const Vec2<> &direction,
+                                       float maxDistance,
+                                       const RasterArea &form) const {
+    std::optional<RayHit> first;
+    for (const Vec2<int32_t> &cell :
+         SweptBox{bounds(), direction * maxDistance}.rasterize()) {
+        if (!form.area.contains(cell))
+            continue;
+        const Rectangle square{cell.cast<float>() + 0.5f, {1, 1}};
+        if (auto hit = sweep(direction, maxDistance, square)) {
+            maxDistance = hit->distance;
+            first = hit;
+        }
+    }
+    return first;
+}
+
 } // namespace Blob
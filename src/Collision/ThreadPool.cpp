@@ -0,0 +1,97 @@
+#include <Blob/Collision/ThreadPool.hpp>
+
+#include <algorithm>
+
+namespace Blob {
+
+ThreadPool::ThreadPool(unsigned threadCount) {
+    for (unsigned i = 1; i < threadCount; i++)
+        workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex);
+        stop = true;
+    }
+    workAvailable.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::runChunks() {
+    while (true) {
+        size_t begin = nextIndex.fetch_add(chunkSize);
+        if (begin >= jobSize)
+            return;
+        try {
+            (*job)(begin, std::min(begin + chunkSize, jobSize));
+        } catch (...) {
+            std::lock_guard lock(mutex);
+            if (!exception)
+                exception = std::current_exception();
+            nextIndex = jobSize;
+        }
+    }
+}
+
+void ThreadPool::work() {
+    uint64_t lastGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock lock(mutex);
+            workAvailable.wait(lock, [&] {
+                return stop || generation != lastGeneration;
+            });
+            if (stop)
+                return;
+            lastGeneration = generation;
+        }
+
+        runChunks();
+
+        {
+            std::lock_guard lock(mutex);
+            finishedWorkers++;
+        }
+        workDone.notify_one();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count,
+                             const std::function<void(size_t, size_t)> &f) {
+    if (count == 0)
+        return;
+    if (workers.empty() || count == 1) {
+        f(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        job = &f;
+        jobSize = count;
+        // several chunks per thread to balance uneven costs
+        chunkSize = std::max<size_t>(1, count / (size() * 8));
+        nextIndex = 0;
+        exception = nullptr;
+        finishedWorkers = 0;
+        generation++;
+    }
+    workAvailable.notify_all();
+
+    runChunks();
+
+    std::exception_ptr error;
+    {
+        std::unique_lock lock(mutex);
+        workDone.wait(lock,
+                      [&] { return finishedWorkers == workers.size(); });
+        job = nullptr;
+        error = exception;
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+} // namespace Blob
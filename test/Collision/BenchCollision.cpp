@@ -0,0 +1,704 @@
+#include <Blob/Collision/CollisionDetector.hpp>
+#include <Blob/Collision/PackedForms.hpp>
+#include <Blob/Collision/Pathfinder.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <list>
+#include <random>
+#include <unordered_map>
+
+using namespace Blob;
+
+typedef std::chrono::duration<float, std::milli> Milliseconds;
+
+// The spacial hash used by FormDatabase before SpacialGrid
+template<class V>
+class LegacySpacialHash {
+private:
+    std::unordered_map<Vec2<int32_t>, std::unordered_set<V>> cells;
+
+public:
+    bool insert(const Vec2<int32_t> &position, const V &value) {
+        return cells[position].insert(value).second;
+    }
+
+    bool erase(const Vec2<int32_t> &position, const V &value) {
+        return cells[position].erase(value) != 0;
+    }
+
+    template<class F>
+    void forEachIn(const Vec2<int32_t> &position, F &&f) const {
+        auto it = cells.find(position);
+        if (it != cells.end())
+            for (const V &v : it->second)
+                f(v);
+    }
+};
+
+template<class V>
+class FlatSpacialHash : public SpacialGrid<V> {
+public:
+    template<class F>
+    void forEachIn(const Vec2<int32_t> &position, F &&f) const {
+        for (const V &v : SpacialGrid<V>::operator[](position))
+            f(v);
+    }
+};
+
+class Agent : public DynamicCollider<Circle> {
+public:
+    Vec2<> speed;
+
+    Agent(const Point &position, float rayon, const Vec2<> &speed) :
+        DynamicCollider<Circle>(typeid(Agent), Circle(position, rayon)),
+        speed(speed) {}
+
+    Circle preCollisionUpdate(Circle currentForm, float timeFlow) final {
+        currentForm.position += speed * timeFlow;
+        return currentForm;
+    }
+};
+
+class Wall : public StaticCollider<Rectangle> {
+public:
+    explicit Wall(const Rectangle &form) :
+        StaticCollider<Rectangle>(typeid(Wall), Rectangle(form)) {}
+};
+
+class Scenario {
+public:
+    size_t agentCount;
+    float worldSize;
+    std::vector<Circle> start;
+    std::vector<Vec2<>> speeds;
+    // large static rectangles, one per 100 agents
+    std::vector<Rectangle> walls;
+
+    Scenario(size_t agentCount, float density) :
+        agentCount(agentCount), worldSize(std::sqrt(agentCount / density)) {
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<float> position(0, worldSize);
+        std::uniform_real_distribution<float> rayon(0.2f, 0.6f);
+        std::uniform_real_distribution<float> speed(-2.f, 2.f);
+        for (size_t i = 0; i < agentCount; i++) {
+            start.emplace_back(Point{position(generator), position(generator)},
+                               rayon(generator));
+            speeds.emplace_back(speed(generator), speed(generator));
+        }
+        std::uniform_real_distribution<float> wallSize(1.f, worldSize / 4);
+        for (size_t i = 0; i < agentCount / 100; i++)
+            walls.emplace_back(Point{position(generator), position(generator)},
+                               Point{wallSize(generator), wallSize(generator)});
+    }
+};
+
+// Replay a full re-rasterization of every collider on a container: erase the
+// old cells, query the new cells, insert the new cells
+template<class Hash>
+float replay(const Scenario &scenario, size_t frames, float timeFlow) {
+    Hash hash;
+    std::vector<Circle> forms = scenario.start;
+    for (size_t i = 0; i < forms.size(); i++)
+        for (const auto &position : forms[i].rasterize())
+            hash.insert(position, i);
+
+    size_t hits = 0;
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (size_t frame = 0; frame < frames; frame++) {
+        for (size_t i = 0; i < forms.size(); i++) {
+            for (const auto &position : forms[i].rasterize())
+                hash.erase(position, i);
+
+            Circle next = forms[i];
+            next.position += scenario.speeds[i] * timeFlow;
+            for (const auto &position : next.rasterize())
+                hash.forEachIn(position, [&](size_t target) {
+                    hits += next.overlap(forms[target]);
+                });
+
+            forms[i] = next;
+            for (const auto &position : forms[i].rasterize())
+                hash.insert(position, i);
+        }
+    }
+    Milliseconds duration = std::chrono::high_resolution_clock::now() - begin;
+    std::cout << "    (" << hits << " narrow phase hits)" << std::endl;
+    return duration.count() / frames;
+}
+
+template<class Detector = CollisionDetector>
+float detectorUpdate(const Scenario &scenario,
+                     size_t frames,
+                     float timeFlow,
+                     unsigned threadCount = 0) {
+    Detector collisionDetector;
+    collisionDetector.setParallelUpdate(threadCount);
+    std::list<Agent> agents;
+    for (size_t i = 0; i < scenario.agentCount; i++) {
+        Circle c = scenario.start[i];
+        agents.emplace_back(c.position, c.rayon, scenario.speeds[i]);
+        collisionDetector.enableCollision(agents.back());
+    }
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (size_t frame = 0; frame < frames; frame++)
+        collisionDetector.update(timeFlow);
+    Milliseconds duration = std::chrono::high_resolution_clock::now() - begin;
+    return duration.count() / frames;
+}
+
+// One agent in ten moves, the others are parked
+float parkedUnits(const Scenario &scenario,
+                  size_t frames,
+                  float timeFlow,
+                  uint32_t sleepDelay) {
+    CollisionDetector collisionDetector;
+    collisionDetector.setSleepDelay(sleepDelay);
+    std::list<Agent> agents;
+    for (size_t i = 0; i < scenario.agentCount; i++) {
+        Circle c = scenario.start[i];
+        agents.emplace_back(
+            c.position, c.rayon, i % 10 ? Vec2<>{} : scenario.speeds[i]);
+        collisionDetector.enableCollision(agents.back());
+    }
+    // let the parked agents fall asleep
+    for (uint32_t frame = 0; frame <= sleepDelay; frame++)
+        collisionDetector.update(timeFlow);
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (size_t frame = 0; frame < frames; frame++)
+        collisionDetector.update(timeFlow);
+    Milliseconds duration = std::chrono::high_resolution_clock::now() - begin;
+
+    size_t sleeping = 0;
+    for (const Agent &agent : agents)
+        sleeping += agent.isSleeping();
+    std::cout << "    (" << sleeping << " sleeping agents)" << std::endl;
+    return duration.count() / frames;
+}
+
+// Load a level of square tiles one by one or baked, then query it
+template<bool bake>
+void levelLoad(size_t side, size_t queries) {
+    CollisionDetector collisionDetector;
+    std::list<Wall> tiles;
+    for (size_t y = 0; y < side; y++)
+        for (size_t x = 0; x < side; x++)
+            tiles.emplace_back(Rectangle(Point{x + 0.5f, y + 0.5f}, {1, 1}));
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    if constexpr (bake)
+        collisionDetector.bakeStatic(tiles);
+    else
+        for (Wall &tile : tiles)
+            collisionDetector.enableCollision(tile);
+    Milliseconds load = std::chrono::high_resolution_clock::now() - begin;
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> position(0, (float) side);
+    size_t hits = 0;
+    begin = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < queries; i++)
+        hits += collisionDetector
+                    .testCollision(Circle(
+                        Point{position(generator), position(generator)}, 0.5f))
+                    .size();
+    Milliseconds query = std::chrono::high_resolution_clock::now() - begin;
+    std::cout << "    load " << load.count() << " ms, testCollision "
+              << query.count() * 1000 / queries << " us (" << hits << " hits)"
+              << std::endl;
+
+    for (Wall &tile : tiles)
+        collisionDetector.disableCollision(tile);
+}
+
+// Enable the walls, update the agents among them, disable the walls
+template<class Detector>
+void levelGeometry(const Scenario &scenario, size_t frames, float timeFlow) {
+    Detector collisionDetector;
+    std::list<Agent> agents;
+    for (size_t i = 0; i < scenario.agentCount; i++) {
+        Circle c = scenario.start[i];
+        agents.emplace_back(c.position, c.rayon, scenario.speeds[i]);
+        collisionDetector.enableCollision(agents.back());
+    }
+    std::list<Wall> walls(scenario.walls.begin(), scenario.walls.end());
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (Wall &wall : walls)
+        collisionDetector.enableCollision(wall);
+    Milliseconds enable = std::chrono::high_resolution_clock::now() - begin;
+
+    begin = std::chrono::high_resolution_clock::now();
+    for (size_t frame = 0; frame < frames; frame++)
+        collisionDetector.update(timeFlow);
+    Milliseconds update = std::chrono::high_resolution_clock::now() - begin;
+
+    begin = std::chrono::high_resolution_clock::now();
+    for (Wall &wall : walls)
+        collisionDetector.disableCollision(wall);
+    Milliseconds disable = std::chrono::high_resolution_clock::now() - begin;
+
+    std::cout << "    enable " << enable.count() << " ms, update "
+              << update.count() / frames << " ms/frame, disable "
+              << disable.count() << " ms" << std::endl;
+
+    const CollisionStatistics &frame = collisionDetector.statistics();
+    std::cout << "    last frame: " << frame.cells << " cells, "
+              << frame.averageCandidates() << " tests per query, peak "
+              << frame.peakCandidates << ", " << frame.forms[0].inserts
+              << " circle inserts" << std::endl;
+
+    auto &broadPhase =
+        collisionDetector.template getDynamicBroadPhase<Circle>();
+    if constexpr (requires { broadPhase.statistics().levels; }) {
+        const auto statistics = broadPhase.statistics();
+        std::cout << "    " << statistics.averageCandidates()
+                  << " dynamic circle candidates per query" << std::endl;
+        for (const auto &level : statistics.levels)
+            std::cout << "      cell " << level.cellSize << ": "
+                      << level.colliders << " colliders, " << level.cells
+                      << " cells, " << level.occupancy() << " per cell"
+                      << std::endl;
+    }
+}
+
+// Line of sight on random segments through the crowd
+template<class Detector>
+void lineOfSight(const Scenario &scenario, size_t queries) {
+    Detector collisionDetector;
+    std::list<Agent> agents;
+    for (size_t i = 0; i < scenario.agentCount; i++) {
+        Circle c = scenario.start[i];
+        agents.emplace_back(c.position, c.rayon, scenario.speeds[i]);
+        collisionDetector.enableCollision(agents.back());
+    }
+
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> position(0, scenario.worldSize);
+    std::uniform_real_distribution<float> angle(0, 6.2831853f);
+    std::uniform_real_distribution<float> distance(0.5f, 4.f);
+    std::vector<std::pair<Vec2<>, Vec2<>>> segments;
+    for (size_t i = 0; i < queries; i++) {
+        Vec2<> from{position(generator), position(generator)};
+        const float a = angle(generator), d = distance(generator);
+        segments.emplace_back(from,
+                              from + Vec2<>{std::cos(a), std::sin(a)} * d);
+    }
+
+    size_t blocked = 0;
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (auto &[from, to] : segments)
+        blocked += !collisionDetector.testCollision(Line(from, to)).empty();
+    Milliseconds overlap = std::chrono::high_resolution_clock::now() - begin;
+
+    size_t hit = 0;
+    begin = std::chrono::high_resolution_clock::now();
+    for (auto &[from, to] : segments)
+        hit += collisionDetector.segmentCast(from, to).has_value();
+    Milliseconds cast = std::chrono::high_resolution_clock::now() - begin;
+
+    std::cout << "    testCollision(Line) " << overlap.count() * 1000 / queries
+              << " us, segmentCast " << cast.count() * 1000 / queries
+              << " us (" << blocked << " / " << hit << " blocked)"
+              << std::endl;
+}
+
+// Resolve every agent against its next neighbours in strips of the world and
+// against a wall, with resolveBatch and with the scalar resolve of the forms
+void batchResolve(const Scenario &scenario, size_t neighbours) {
+    PackedForms<Circle> circles;
+    PackedForms<Point> destinations;
+    PackedForms<Rectangle> boxes, walls;
+    for (uint32_t i = 0; i < scenario.agentCount; i++) {
+        const Circle &c = scenario.start[i];
+        circles.set(i, c);
+        destinations.set(i, c.position + scenario.speeds[i]);
+        boxes.set(i, Rectangle(c.position, Point{c.rayon * 2, c.rayon * 2}));
+    }
+    PackedForms<Line> diagonals;
+    for (uint32_t i = 0; i < scenario.walls.size(); i++) {
+        walls.set(i, scenario.walls[i]);
+        auto points = scenario.walls[i].getPoints();
+        diagonals.set(i, Line(points[0], points[2]));
+    }
+
+    std::vector<uint32_t> order(scenario.agentCount);
+    for (uint32_t i = 0; i < scenario.agentCount; i++)
+        order[i] = i;
+    auto strip = [&](uint32_t i) {
+        return std::pair{std::floor(scenario.start[i].position.x / 2),
+                         scenario.start[i].position.y};
+    };
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return strip(a) < strip(b);
+    });
+
+    std::vector<uint32_t> movers, targets, wallMovers, wallTargets;
+    for (uint32_t i = 0; i < scenario.agentCount; i++) {
+        for (uint32_t j = 1; j <= neighbours; j++) {
+            movers.push_back(order[i]);
+            targets.push_back(order[(i + j) % scenario.agentCount]);
+        }
+        wallMovers.push_back(i);
+        wallTargets.push_back(i % scenario.walls.size());
+    }
+
+    auto same = [](const CollisionResolution &a, const CollisionResolution &b) {
+        auto bits = [](const Vec2<> &v) {
+            return std::pair{std::bit_cast<uint32_t>(v.x),
+                             std::bit_cast<uint32_t>(v.y)};
+        };
+        return a.collision == b.collision &&
+               bits(a.collisionPoint) == bits(b.collisionPoint) &&
+               bits(a.normal) == bits(b.normal) &&
+               bits(a.bounce) == bits(b.bounce) &&
+               bits(a.shift) == bits(b.shift);
+    };
+
+    auto compare = [&](const char *name,
+                       const std::vector<uint32_t> &m,
+                       const std::vector<uint32_t> &t,
+                       auto &&batch,
+                       auto &&scalar) {
+        std::vector<CollisionResolution> results(m.size());
+        auto begin = std::chrono::high_resolution_clock::now();
+        batch(results.data());
+        Milliseconds batchTime =
+            std::chrono::high_resolution_clock::now() - begin;
+
+        std::vector<CollisionResolution> expected(m.size());
+        begin = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < m.size(); i++)
+            expected[i] = scalar(m[i], t[i]);
+        Milliseconds scalarTime =
+            std::chrono::high_resolution_clock::now() - begin;
+
+        size_t collisions = 0, different = 0;
+        for (size_t i = 0; i < m.size(); i++) {
+            collisions += expected[i].collision;
+            different += !same(results[i], expected[i]);
+        }
+        std::cout << "  " << name << ": resolveBatch " << batchTime.count()
+                  << " ms, resolve " << scalarTime.count() << " ms (x"
+                  << scalarTime.count() / batchTime.count() << ", "
+                  << collisions << " collisions, " << different
+                  << " different)" << std::endl;
+    };
+
+    compare(
+        "Circle/Circle",
+        movers,
+        targets,
+        [&](CollisionResolution *results) {
+            resolveBatch(
+                circles, destinations, circles, movers, targets, results);
+        },
+        [&](uint32_t m, uint32_t t) {
+            return circles[m].resolve(circles[t], destinations[m]);
+        });
+    compare(
+        "Circle/wall diagonal",
+        wallMovers,
+        wallTargets,
+        [&](CollisionResolution *results) {
+            resolveBatch(circles,
+                         destinations,
+                         diagonals,
+                         wallMovers,
+                         wallTargets,
+                         results);
+        },
+        [&](uint32_t m, uint32_t t) {
+            return circles[m].resolve(diagonals[t], destinations[m]);
+        });
+    compare(
+        "Rectangle/Rectangle",
+        movers,
+        targets,
+        [&](CollisionResolution *results) {
+            resolveBatch(boxes, destinations, boxes, movers, targets, results);
+        },
+        [&](uint32_t m, uint32_t t) {
+            return boxes[m].resolve(boxes[t], destinations[m]);
+        });
+    compare(
+        "Rectangle/wall",
+        wallMovers,
+        wallTargets,
+        [&](CollisionResolution *results) {
+            resolveBatch(
+                boxes, destinations, walls, wallMovers, wallTargets, results);
+        },
+        [&](uint32_t m, uint32_t t) {
+            return boxes[m].resolve(walls[t], destinations[m]);
+        });
+}
+
+// 1000 thin walls on a side x side level
+void thinWalls(std::list<Wall> &walls,
+               CollisionDetector &collisionDetector,
+               float side,
+               std::mt19937 &generator) {
+    std::uniform_real_distribution<float> position(0, side);
+    std::uniform_real_distribution<float> length(2, 40);
+    for (size_t i = 0; i < 1000; i++) {
+        const Point size = i % 2 ? Point{length(generator), 1}
+                                 : Point{1, length(generator)};
+        walls.emplace_back(
+            Rectangle({position(generator), position(generator)}, size));
+        collisionDetector.enableCollision(walls.back());
+    }
+}
+
+// Paths between random points of a level of thin walls, then the repair of
+// the grid after some walls are removed
+void pathfinding(size_t requests, unsigned threadCount) {
+    const float side = 500;
+    std::mt19937 generator(5);
+    std::uniform_real_distribution<float> position(0, side);
+    std::list<Wall> walls;
+    CollisionDetector collisionDetector;
+    thinWalls(walls, collisionDetector, side, generator);
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    Pathfinder pathfinder(
+        collisionDetector, Box{{0, 0}, {side, side}}, 1, 0.4f, threadCount);
+    Milliseconds build = std::chrono::high_resolution_clock::now() - begin;
+
+    begin = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < requests; i++)
+        pathfinder.request({position(generator), position(generator)},
+                           {position(generator), position(generator)});
+    pathfinder.waitIdle();
+    Milliseconds search = std::chrono::high_resolution_clock::now() - begin;
+    std::vector<PathResult> paths;
+    pathfinder.takePaths(paths);
+    const size_t found = std::count_if(
+        paths.begin(), paths.end(), [](const PathResult &path) {
+            return path.found;
+        });
+
+    auto wall = walls.begin();
+    for (size_t i = 0; i < 20; i++, wall++)
+        collisionDetector.disableCollision(*wall);
+    begin = std::chrono::high_resolution_clock::now();
+    pathfinder.update();
+    Milliseconds repair = std::chrono::high_resolution_clock::now() - begin;
+
+    std::cout << "    build " << build.count() << " ms ("
+              << pathfinder.getGrid().nodeCount() << " nodes), "
+              << search.count() * 1000 / requests << " us/path (" << found
+              << " / " << requests << " found), repair of 20 walls "
+              << repair.count() << " ms" << std::endl;
+}
+
+class Follower : public DynamicCollider<Circle> {
+public:
+    const std::shared_ptr<const FlowField> flowField;
+
+    Follower(const Point &position,
+             std::shared_ptr<const FlowField> flowField) :
+        DynamicCollider<Circle>(typeid(Follower), Circle(position, 0.4f)),
+        flowField(std::move(flowField)) {}
+
+    Circle preCollisionUpdate(Circle currentForm, float timeFlow) final {
+        currentForm.position +=
+            flowField->direction(currentForm.position) * (5 * timeFlow);
+        return currentForm;
+    }
+};
+
+// A crowd following the flow field to a point of the level of thin walls,
+// then the rebuild of the field after some walls are removed
+void crowdFlow(size_t agentCount,
+               size_t frames,
+               float timeFlow,
+               unsigned threadCount) {
+    const float side = 500;
+    std::mt19937 generator(5);
+    std::uniform_real_distribution<float> position(0, side);
+    std::list<Wall> walls;
+    CollisionDetector collisionDetector;
+    thinWalls(walls, collisionDetector, side, generator);
+    Pathfinder pathfinder(
+        collisionDetector, Box{{0, 0}, {side, side}}, 1, 0.4f, threadCount);
+
+    const NavigationGrid &grid = pathfinder.getGrid();
+    Point goal{side / 2, side / 2};
+    while (!grid.isWalkable(grid.cellAt(goal)))
+        goal = Point{position(generator), position(generator)};
+    auto begin = std::chrono::high_resolution_clock::now();
+    const std::shared_ptr<const FlowField> flowField =
+        pathfinder.flowField(goal, Box{{0, 0}, {side, side}});
+    Milliseconds build = std::chrono::high_resolution_clock::now() - begin;
+
+    std::list<Follower> followers;
+    for (size_t i = 0; i < agentCount; i++) {
+        const Point start{position(generator), position(generator)};
+        if (flowField->distance(start) ==
+            std::numeric_limits<float>::infinity())
+            continue;
+        followers.emplace_back(start, flowField);
+        collisionDetector.enableCollision(followers.back());
+    }
+    begin = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < frames; i++)
+        collisionDetector.update(timeFlow);
+    Milliseconds update = std::chrono::high_resolution_clock::now() - begin;
+
+    auto wall = walls.begin();
+    for (size_t i = 0; i < 20; i++, wall++)
+        collisionDetector.disableCollision(*wall);
+    begin = std::chrono::high_resolution_clock::now();
+    pathfinder.update();
+    Milliseconds rebuild = std::chrono::high_resolution_clock::now() - begin;
+
+    std::cout << "    field " << build.count() << " ms, "
+              << followers.size() << " followers " << update.count() / frames
+              << " ms/frame, repair of 20 walls and rebuild "
+              << rebuild.count() << " ms" << std::endl;
+}
+
+int main(int argc, char *args[]) {
+    size_t agentCount = 50000;
+    size_t frames = 20;
+    if (argc > 1)
+        agentCount = std::stoul(args[1]);
+    if (argc > 2)
+        frames = std::stoul(args[2]);
+
+    const float timeFlow = 1.f / 60.f;
+    Scenario scenario(agentCount, 0.5f);
+
+    std::cout << agentCount << " dynamic circles, " << frames << " frames"
+              << std::endl;
+
+    float legacy =
+        replay<LegacySpacialHash<size_t>>(scenario, frames, timeFlow);
+    std::cout << "unordered_map/unordered_set: " << legacy << " ms/frame"
+              << std::endl;
+
+    float flat = replay<FlatSpacialHash<size_t>>(scenario, frames, timeFlow);
+    std::cout << "SpacialGrid: " << flat << " ms/frame (x" << legacy / flat
+              << ")" << std::endl;
+
+    float serial = detectorUpdate(scenario, frames, timeFlow);
+    std::cout << "CollisionDetector::update: " << serial << " ms/frame"
+              << std::endl;
+
+    unsigned threadCount = std::max(2u, std::thread::hardware_concurrency());
+    float parallel = detectorUpdate(scenario, frames, timeFlow, threadCount);
+    std::cout << "CollisionDetector::update, " << threadCount
+              << " threads: " << parallel << " ms/frame (x"
+              << serial / parallel << ")" << std::endl;
+
+    std::cout << "Crowd, one broad phase for all the forms:" << std::endl;
+    float tree = detectorUpdate<BasicCollisionDetector<AABBTreePolicy,
+                                                       Circle,
+                                                       Rectangle,
+                                                       Point,
+                                                       Line,
+                                                       RasterArea>>(
+        scenario, frames, timeFlow);
+    std::cout << "  AABBTreePolicy: " << tree << " ms/frame (x" << serial / tree
+              << ")" << std::endl;
+    float hierarchical =
+        detectorUpdate<BasicCollisionDetector<HierarchicalGridPolicy,
+                                              Circle,
+                                              Rectangle,
+                                              Point,
+                                              Line,
+                                              RasterArea>>(
+            scenario, frames, timeFlow);
+    std::cout << "  HierarchicalGridPolicy: " << hierarchical
+              << " ms/frame (x" << serial / hierarchical << ")" << std::endl;
+    float sweep = detectorUpdate<BasicCollisionDetector<SweepAndPrunePolicy,
+                                                        Circle,
+                                                        Rectangle,
+                                                        Point,
+                                                        Line,
+                                                        RasterArea>>(
+        scenario, frames, timeFlow);
+    std::cout << "  SweepAndPrunePolicy: " << sweep << " ms/frame (x"
+              << serial / sweep << ")" << std::endl;
+
+    std::cout << "Parked units, one agent in ten moves:" << std::endl;
+    float awake = parkedUnits(scenario, frames, timeFlow, 0);
+    std::cout << "  no sleep: " << awake << " ms/frame" << std::endl;
+    float asleep = parkedUnits(scenario, frames, timeFlow, 10);
+    std::cout << "  setSleepDelay(10): " << asleep << " ms/frame (x"
+              << awake / asleep << ")" << std::endl;
+
+    std::cout << scenario.walls.size() << " large static rectangles"
+              << std::endl;
+    std::cout << "  GridPolicy:" << std::endl;
+    levelGeometry<CollisionDetector>(scenario, frames, timeFlow);
+    std::cout << "  AABBTreePolicy:" << std::endl;
+    levelGeometry<BasicCollisionDetector<AABBTreePolicy,
+                                         Circle,
+                                         Rectangle,
+                                         Point,
+                                         Line,
+                                         RasterArea>>(scenario,
+                                                      frames,
+                                                      timeFlow);
+    std::cout << "  HierarchicalGridPolicy:" << std::endl;
+    levelGeometry<BasicCollisionDetector<HierarchicalGridPolicy,
+                                         Circle,
+                                         Rectangle,
+                                         Point,
+                                         Line,
+                                         RasterArea>>(scenario,
+                                                      frames,
+                                                      timeFlow);
+    std::cout << "  AABBTree for the rectangles only:" << std::endl;
+    levelGeometry<
+        BasicCollisionDetector<BroadPhaseFor<GridPolicy, AABBTree, Rectangle>,
+                               Circle,
+                               Rectangle,
+                               Point,
+                               Line,
+                               RasterArea>>(scenario, frames, timeFlow);
+
+    std::cout << "Level of 202500 tiles:" << std::endl;
+    std::cout << "  enableCollision:" << std::endl;
+    levelLoad<false>(450, 100000);
+    std::cout << "  bakeStatic:" << std::endl;
+    levelLoad<true>(450, 100000);
+
+    std::cout << "Line of sight, 10000 segments:" << std::endl;
+    std::cout << "  GridPolicy:" << std::endl;
+    lineOfSight<CollisionDetector>(scenario, 10000);
+    std::cout << "  AABBTreePolicy:" << std::endl;
+    lineOfSight<BasicCollisionDetector<AABBTreePolicy,
+                                       Circle,
+                                       Rectangle,
+                                       Point,
+                                       Line,
+                                       RasterArea>>(scenario, 10000);
+
+    std::cout << "Pathfinding on a 500 x 500 grid, 10000 paths:" << std::endl;
+    std::cout << "  1 thread:" << std::endl;
+    pathfinding(10000, 1);
+    std::cout << "  " << threadCount << " threads:" << std::endl;
+    pathfinding(10000, threadCount);
+
+    std::cout << "Flow field on a 500 x 500 grid, 10000 followers:"
+              << std::endl;
+    std::cout << "  1 thread:" << std::endl;
+    crowdFlow(10000, frames, timeFlow, 1);
+    std::cout << "  " << threadCount << " threads:" << std::endl;
+    crowdFlow(10000, frames, timeFlow, threadCount);
+
+    std::cout << "Batch collision resolution, 8 neighbours per agent:"
+              << std::endl;
+    batchResolve(scenario, 8);
+
+    return 0;
+}
@@ -0,0 +1,777 @@
+#include <Blob/Collision/BroadPhase.hpp>
+#include <Blob/Collision/CollisionDetector.hpp>
+#include <Blob/Collision/SweepAndPrune.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace Blob;
+
+static void check(bool condition, const std::string &what) {
+    if (!condition)
+        throw Exception("Check failed: " + what);
+}
+
+// Number of a collider, the same in every scene built from a Scenario
+class Identified {
+public:
+    const int id;
+
+    explicit Identified(int id) : id(id) {}
+
+    virtual ~Identified() = default;
+
+    static int of(const PhysicalObject *object) {
+        return dynamic_cast<const Identified *>(object)->id;
+    }
+};
+
+template<class T>
+class Block : public StaticCollider<T>, public Identified {
+public:
+    Block(int id, T form, const CollisionFilter &filter = {}) :
+        StaticCollider<T>(typeid(Block), std::move(form), filter),
+        Identified(id) {}
+};
+
+template<class C>
+constexpr bool isBlock = false;
+
+template<class T>
+constexpr bool isBlock<Block<T>> = true;
+
+// Moves in a straight line and bounces on the sides of the world
+template<class T>
+class Mover : public DynamicCollider<T>, public Identified {
+public:
+    Vec2<> speed;
+
+    Mover(int id,
+          T form,
+          const Vec2<> &speed,
+          const CollisionFilter &filter = {}) :
+        DynamicCollider<T>(typeid(Mover), std::move(form), filter),
+        Identified(id),
+        speed(speed) {}
+
+    using DynamicCollider<T>::hittingObjects;
+
+    T preCollisionUpdate(T currentForm, float timeFlow) override {
+        const Vec2<> center = currentForm.bounds().center();
+        if (center.x < 0 || center.x > 100)
+            speed.x = center.x < 0 ? std::abs(speed.x) : -std::abs(speed.x);
+        if (center.y < 0 || center.y > 100)
+            speed.y = center.y < 0 ? std::abs(speed.y) : -std::abs(speed.y);
+        currentForm.position += speed * timeFlow;
+        return currentForm;
+    }
+};
+
+// Random colliders in a 100 x 100 world, with huge and degenerate ones
+struct Scenario {
+    std::vector<Rectangle> blocks;
+    std::vector<Circle> discs;
+    std::vector<Point> points;
+    std::vector<Circle> balls;
+    std::vector<Vec2<>> ballSpeeds;
+    std::vector<Rectangle> crates;
+    std::vector<Vec2<>> crateSpeeds;
+
+    explicit Scenario(unsigned seed) {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> position(-10, 110), size(0, 6),
+            speed(-3, 3);
+        for (int i = 0; i < 150; i++)
+            blocks.emplace_back(Vec2<>{position(random), position(random)},
+                                Vec2<>{size(random), size(random)});
+        // huge, flat, and empty
+        blocks.emplace_back(Vec2<>{50, 50}, Vec2<>{400, 3});
+        blocks.emplace_back(Vec2<>{30, 70}, Vec2<>{0, 20});
+        blocks.emplace_back(Vec2<>{70, 30}, Vec2<>{0, 0});
+        // far away, too spread for a row index in the baked grid
+        if (seed % 2)
+            blocks.emplace_back(Vec2<>{50, 1e5f}, Vec2<>{1, 1});
+        for (int i = 0; i < 40; i++)
+            discs.emplace_back(Point{position(random), position(random)},
+                               size(random) / 2);
+        for (int i = 0; i < 40; i++)
+            points.emplace_back(position(random), position(random));
+        for (int i = 0; i < 120; i++) {
+            // some of radius 0
+            balls.emplace_back(Point{position(random), position(random)},
+                               i % 10 ? size(random) / 2 : 0.f);
+            ballSpeeds.push_back({speed(random), speed(random)});
+        }
+        for (int i = 0; i < 20; i++) {
+            crates.emplace_back(Vec2<>{position(random), position(random)},
+                                Vec2<>{size(random), size(random)});
+            crateSpeeds.push_back({speed(random), speed(random)});
+        }
+        crates.emplace_back(Vec2<>{50, 50}, Vec2<>{150, 150});
+        crateSpeeds.push_back({0.5f, -0.5f});
+        crates.emplace_back(Vec2<>{20, 20}, Vec2<>{0, 0});
+        crateSpeeds.push_back({1, 1});
+    }
+};
+
+// The colliders of a Scenario in a detector using Policy
+template<class Policy>
+class Scene {
+public:
+    BasicCollisionDetector<Policy, Circle, Rectangle, Point> detector;
+    std::deque<Block<Rectangle>> blocks;
+    std::deque<Block<Circle>> discs;
+    std::deque<Block<Point>> points;
+    std::deque<Mover<Circle>> balls;
+    std::deque<Mover<Rectangle>> crates;
+    // the colliders in id order, to toggle them by id
+    std::vector<PhysicalObject *> colliders;
+    std::vector<bool> enabled;
+    // the static colliders go in the baked grid, see bake
+    const bool baked;
+    size_t enables = 0;
+
+    explicit Scene(const Scenario &scenario, bool baked = false) :
+        baked(baked) {
+        for (const Rectangle &form : scenario.blocks)
+            add(blocks.emplace_back((int) colliders.size(), form));
+        for (const Circle &form : scenario.discs)
+            add(discs.emplace_back((int) colliders.size(), form));
+        for (const Point &form : scenario.points)
+            add(points.emplace_back((int) colliders.size(), form));
+        if (baked)
+            bake();
+        for (size_t i = 0; i < scenario.balls.size(); i++)
+            add(balls.emplace_back((int) colliders.size(),
+                                   scenario.balls[i],
+                                   scenario.ballSpeeds[i]));
+        for (size_t i = 0; i < scenario.crates.size(); i++)
+            add(crates.emplace_back((int) colliders.size(),
+                                    scenario.crates[i],
+                                    scenario.crateSpeeds[i]));
+    }
+
+    ~Scene() {
+        for (size_t i = 0; i < colliders.size(); i++)
+            if (enabled[i])
+                toggle(i);
+    }
+
+    template<class C>
+    void add(C &collider) {
+        colliders.push_back(&collider);
+        enabled.push_back(false);
+        if (!baked || !isBlock<C>)
+            toggle(colliders.size() - 1);
+    }
+
+    // Bake the static colliders in several batches, each one rebuilding the
+    // grid with the colliders already baked
+    void bake() {
+        auto batch = [&](auto &blocks, size_t begin, size_t end) {
+            std::vector<std::remove_reference_t<decltype(blocks[0])> *> batch;
+            for (size_t i = begin; i < end; i++) {
+                batch.push_back(&blocks[i]);
+                enabled[blocks[i].id] = true;
+            }
+            detector.bakeStatic(batch);
+        };
+        batch(blocks, 0, blocks.size() / 2);
+        batch(discs, 0, discs.size());
+        batch(blocks, blocks.size() / 2, blocks.size());
+        batch(points, 0, points.size());
+    }
+
+    void toggle(size_t id) {
+        auto apply = [&](auto &collider) {
+            if (enabled[id])
+                detector.disableCollision(collider);
+            else
+                detector.enableCollision(collider);
+        };
+        // a static collider enabled again is baked every other time
+        auto applyStatic = [&](auto &collider) {
+            if (baked && !enabled[id] && enables++ % 2)
+                detector.bakeStatic(std::array{&collider});
+            else
+                apply(collider);
+        };
+        PhysicalObject *object = colliders[id];
+        if (auto *block = dynamic_cast<Block<Rectangle> *>(object))
+            applyStatic(*block);
+        else if (auto *disc = dynamic_cast<Block<Circle> *>(object))
+            applyStatic(*disc);
+        else if (auto *point = dynamic_cast<Block<Point> *>(object))
+            applyStatic(*point);
+        else if (auto *ball = dynamic_cast<Mover<Circle> *>(object))
+            apply(*ball);
+        else
+            apply(*dynamic_cast<Mover<Rectangle> *>(object));
+        enabled[id] = !enabled[id];
+    }
+
+    static std::vector<int> ids(std::span<PhysicalObject *const> objects) {
+        std::vector<int> ids;
+        for (PhysicalObject *object : objects)
+            ids.push_back(Identified::of(object));
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    // the ids hit by every dynamic collider, in id order
+    std::vector<std::vector<int>> contacts() const {
+        std::vector<std::vector<int>> contacts;
+        for (const auto &ball : balls)
+            contacts.push_back(ids(ball.hittingObjects()));
+        for (const auto &crate : crates)
+            contacts.push_back(ids(crate.hittingObjects()));
+        return contacts;
+    }
+
+    // the pairs of overlapping dynamic colliders, in id order
+    std::vector<std::vector<int>> pairs() const {
+        std::vector<std::vector<int>> pairs;
+        detector.forEachDynamicPair([&](PhysicalObject *a, PhysicalObject *b) {
+            const int first = Identified::of(a), second = Identified::of(b);
+            pairs.push_back(
+                {std::min(first, second), std::max(first, second)});
+        });
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+
+    template<class T>
+    std::vector<std::vector<int>> query(const std::vector<T> &forms) const {
+        CollisionQueryResults results;
+        detector.testCollisions(forms, results);
+        std::vector<std::vector<int>> found;
+        for (size_t i = 0; i < results.size(); i++) {
+            std::vector<PhysicalObject *> objects;
+            for (const auto &hit : results[i])
+                objects.push_back(hit.object);
+            found.push_back(ids(objects));
+        }
+        return found;
+    }
+};
+
+// What a scene reports in a frame: the ids hit by every dynamic collider, the
+// ids found by the queries of the frame and the pairs of dynamic colliders,
+// before and after the update
+using Frame = std::vector<std::vector<int>>;
+
+// Runs the scene of the seed under Policy, enabling and disabling the same
+// colliders and asking the same queries in every frame whatever the policy
+template<class Policy>
+static std::vector<Frame> record(unsigned seed) {
+    const Scenario scenario(seed);
+    Scene<Policy> scene(scenario);
+    std::vector<Frame> frames;
+
+    std::mt19937 random(seed + 1000);
+    std::uniform_real_distribution<float> position(-10, 110), size(0, 8);
+    for (int frame = 0; frame < 30; frame++) {
+        for (size_t id = 0; id < scene.colliders.size(); id++)
+            if (random() % 100 < 3)
+                scene.toggle(id);
+        const auto pairsBefore = scene.pairs();
+        std::vector<Circle> circles;
+        std::vector<Rectangle> rectangles;
+        for (int i = 0; i < 30; i++) {
+            circles.emplace_back(Point{position(random), position(random)},
+                                 i % 10 ? size(random) / 2 : 0.f);
+            rectangles.emplace_back(
+                Vec2<>{position(random), position(random)},
+                i % 10 ? Vec2<>{size(random), size(random)} : Vec2<>{0, 0});
+        }
+        rectangles.emplace_back(Vec2<>{50, 50}, Vec2<>{500, 500});
+
+        scene.detector.update(1);
+        Frame results = scene.contacts();
+        for (auto &hits : scene.query(circles))
+            results.push_back(std::move(hits));
+        for (auto &hits : scene.query(rectangles))
+            results.push_back(std::move(hits));
+        results.insert(results.end(), pairsBefore.begin(), pairsBefore.end());
+        const auto pairsAfter = scene.pairs();
+        check(!pairsAfter.empty(), "pairs found");
+        results.insert(results.end(), pairsAfter.begin(), pairsAfter.end());
+        frames.push_back(std::move(results));
+    }
+    return frames;
+}
+
+// Every broad phase gives the contacts and the query results of the grid
+template<class Policy>
+static void testPolicyAgrees(const char *name) {
+    for (unsigned seed = 0; seed < 5; seed++) {
+        const std::vector<Frame> expected = record<GridPolicy>(seed);
+        const std::vector<Frame> actual = record<Policy>(seed);
+        for (size_t frame = 0; frame < expected.size(); frame++)
+            check(actual[frame] == expected[frame],
+                  std::string(name) + " frame " + std::to_string(frame) +
+                      " seed " + std::to_string(seed));
+    }
+}
+
+// The baked grid, built in several batches, erasing and baking again, gives
+// the static hits of the grid of the static colliders enabled one by one
+static void testBakedGrid(unsigned seed) {
+    const Scenario scenario(seed);
+    Scene<GridPolicy> reference(scenario), baked(scenario, true);
+    std::mt19937 random(seed + 2000);
+    std::uniform_real_distribution<float> position(-10, 110), size(0, 8),
+        angle(0, 6.3f);
+    for (int frame = 0; frame < 30; frame++) {
+        const std::string at = "baked grid frame " + std::to_string(frame) +
+                               " seed " + std::to_string(seed);
+        for (size_t id = 0; id < reference.colliders.size(); id++)
+            if (random() % 100 < 5) {
+                reference.toggle(id);
+                baked.toggle(id);
+            }
+        reference.detector.update(1);
+        baked.detector.update(1);
+        check(baked.contacts() == reference.contacts(), at + " contacts");
+
+        std::vector<Circle> circles;
+        std::vector<Rectangle> rectangles;
+        for (int i = 0; i < 30; i++) {
+            circles.emplace_back(Point{position(random), position(random)},
+                                 size(random) / 2);
+            rectangles.emplace_back(Vec2<>{position(random), position(random)},
+                                    Vec2<>{size(random), size(random)});
+        }
+        check(baked.query(circles) == reference.query(circles),
+              at + " circle queries");
+        check(baked.query(rectangles) == reference.query(rectangles),
+              at + " rectangle queries");
+        for (const Circle &circle : circles)
+            check(baked.detector.testStaticCollision(circle) ==
+                      reference.detector.testStaticCollision(circle),
+                  at + " testStaticCollision");
+
+        std::vector<Neighbour> expected, found;
+        for (int i = 0; i < 30; i++) {
+            const Vec2<> origin{position(random), position(random)};
+            const float a = angle(random);
+            const Vec2<> direction{std::cos(a), std::sin(a)};
+            const auto hit = baked.detector.raycast(origin, direction, 50);
+            const auto expectedHit =
+                reference.detector.raycast(origin, direction, 50);
+            check(hit.has_value() == expectedHit.has_value() &&
+                      (!hit || hit->distance == expectedHit->distance),
+                  at + " raycast");
+
+            baked.detector.nearest(origin, 5, found, 20);
+            reference.detector.nearest(origin, 5, expected, 20);
+            check(found.size() == expected.size(), at + " nearest");
+            for (size_t j = 0; j < found.size(); j++)
+                check(found[j].distance == expected[j].distance,
+                      at + " nearest distances");
+        }
+    }
+}
+
+// Colliders whose filters reject each other are skipped in both directions,
+// by the contacts, the pairs and the queries
+template<class Policy>
+static void testFilters(const char *name) {
+    const std::string policy = name;
+    // layer 1 only meets layer 1, layer 2 meets every layer but layer 1
+    const CollisionFilter first{1, 1}, second{2, 0xFFFF};
+    BasicCollisionDetector<Policy, Circle, Rectangle> detector;
+
+    // two overlapping movers and two walls under both
+    Mover<Circle> a(0, Circle(Point{50, 50}, 1), {0, 0}, first);
+    Mover<Circle> b(1, Circle(Point{50.5f, 50}, 1), {0, 0}, second);
+    Block<Rectangle> firstWall(2, Rectangle({50, 50}, {4, 4}), first);
+    Block<Rectangle> secondWall(3, Rectangle({50, 50}, {4, 4}), second);
+    // a row on y = 10, the layer 2 colliders before the layer 1 one
+    Block<Rectangle> bakedWall(4, Rectangle({2, 10}, {1, 4}), second);
+    Block<Rectangle> wall(5, Rectangle({4, 10}, {1, 4}), second);
+    Mover<Circle> crossing(6, Circle(Point{6, 10}, 1), {0, 0}, second);
+    Block<Circle> target(7, Circle(Point{9, 10}, 1), first);
+
+    detector.enableCollision(a);
+    detector.enableCollision(b);
+    detector.enableCollision(firstWall);
+    detector.enableCollision(secondWall);
+    detector.bakeStatic(std::vector<Block<Rectangle> *>{&bakedWall});
+    detector.enableCollision(wall);
+    detector.enableCollision(crossing);
+    detector.enableCollision(target);
+    detector.update(1);
+
+    auto ids = [](auto &&objects) {
+        std::vector<int> ids;
+        for (PhysicalObject *object : objects)
+            ids.push_back(Identified::of(object));
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    };
+    check(ids(a.hittingObjects()) == std::vector<int>{2},
+          policy + ": contacts of the layer 1 mover");
+    check(ids(b.hittingObjects()) == std::vector<int>{3},
+          policy + ": contacts of the layer 2 mover");
+    size_t pairs = 0;
+    detector.forEachDynamicPair([&](PhysicalObject *, PhysicalObject *) {
+        pairs++;
+    });
+    check(pairs == 0, policy + ": pairs of rejected movers");
+
+    const Rectangle area({50, 30}, {100, 60});
+    check(ids(detector.testCollision(area, first)) ==
+              std::vector<int>{0, 2, 7},
+          policy + ": testCollision with layer 1");
+    check(ids(detector.testCollision(area, second)) ==
+              std::vector<int>{1, 3, 4, 5, 6},
+          policy + ": testCollision with layer 2");
+
+    const auto firstHit = detector.raycast({0, 10}, {1, 0}, 100, first);
+    check(firstHit && Identified::of(firstHit->object) == 7,
+          policy + ": raycast with layer 1");
+    const auto secondHit = detector.raycast({0, 10}, {1, 0}, 100, second);
+    check(secondHit && Identified::of(secondHit->object) == 4,
+          policy + ": raycast with layer 2");
+
+    std::vector<Neighbour> neighbours;
+    detector.nearest({0, 10}, 1, neighbours, 20, first);
+    check(neighbours.size() == 1 && Identified::of(neighbours[0].object) == 7,
+          policy + ": nearest with layer 1");
+    detector.withinRadius({0, 10}, 6, neighbours, first);
+    check(neighbours.empty(), policy + ": withinRadius with layer 1");
+
+    detector.disableCollision(a);
+    detector.disableCollision(b);
+    detector.disableCollision(crossing);
+    detector.disableCollision(firstWall);
+    detector.disableCollision(secondWall);
+    detector.disableCollision(bakedWall);
+    detector.disableCollision(wall);
+    detector.disableCollision(target);
+}
+
+// raycast gives the nearest hit of all the colliders, for rays along the cell
+// borders, axis parallel or not, at negative coordinates and of length zero
+template<class Policy>
+static void testRaycasts(const char *name) {
+    const std::string policy = name;
+    std::mt19937 random(5);
+    auto lattice = [&](int range) {
+        return (float) ((int) (random() % (4 * range + 1)) - 2 * range) / 2;
+    };
+    std::uniform_real_distribution<float> anywhere(-10, 10), angle(0, 6.3f);
+
+    BasicCollisionDetector<Policy, Circle, Rectangle> detector;
+    std::deque<Block<Rectangle>> blocks;
+    std::deque<Block<Circle>> discs;
+    std::deque<Mover<Circle>> balls;
+    for (int i = 0; i < 60; i++) {
+        detector.enableCollision(blocks.emplace_back(
+            i,
+            Rectangle({lattice(10), lattice(10)},
+                      {std::abs(lattice(2)), std::abs(lattice(2))})));
+        detector.enableCollision(discs.emplace_back(
+            100 + i,
+            Circle(Point{lattice(10), lattice(10)}, std::abs(lattice(2)))));
+        detector.enableCollision(balls.emplace_back(
+            200 + i,
+            Circle(Point{anywhere(random), anywhere(random)},
+                   std::abs(lattice(2))),
+            Vec2<>{0, 0}));
+    }
+    // a wide disc registered in the cells before the nearer blocks
+    detector.enableCollision(discs.emplace_back(300, Circle(Point{0, 30}, 9)));
+    detector.enableCollision(
+        blocks.emplace_back(301, Rectangle({-4.5f, 22}, {1, 2})));
+    detector.update(1);
+
+    auto nearestHit = [&](const Vec2<> &origin,
+                          const Vec2<> &direction,
+                          float maxDistance) {
+        std::optional<float> nearest;
+        auto test = [&](const auto &form) {
+            const auto hit = form.raycast(origin, direction, maxDistance);
+            if (hit && (!nearest || hit->distance < *nearest))
+                nearest = hit->distance;
+        };
+        for (const auto &block : blocks)
+            test(block.form);
+        for (const auto &disc : discs)
+            test(disc.form);
+        for (const auto &ball : balls)
+            test(ball.collider);
+        return nearest;
+    };
+    auto checkRay = [&](const Vec2<> &origin,
+                        const Vec2<> &direction,
+                        float maxDistance) {
+        const auto hit = detector.raycast(origin, direction, maxDistance);
+        const auto expected = nearestHit(origin, direction, maxDistance);
+        const std::string ray = policy + ": raycast from (" +
+                                std::to_string(origin.x) + ", " +
+                                std::to_string(origin.y) + ")";
+        check(hit.has_value() == expected.has_value(), ray);
+        // the detector normalizes the direction again
+        if (hit)
+            check(std::abs(hit->distance - *expected) < 1e-4f,
+                  ray + " distance");
+    };
+
+    // the disc is hit at 5.38, the block in a later cell at 4.5
+    const auto hit = detector.raycast({-9.5f, 22}, {1, 0}, 20);
+    check(hit && Identified::of(hit->object) == 301,
+          policy + ": nearest hit behind a farther collider");
+
+    const Vec2<> axes[] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    for (int i = 0; i < 2000; i++) {
+        const Vec2<> origin{lattice(12), lattice(12)};
+        const float maxDistance = i % 10 ? std::abs(lattice(12)) : 0.f;
+        if (i % 2) {
+            const float a = angle(random);
+            checkRay(origin, {std::cos(a), std::sin(a)}, maxDistance);
+        } else
+            checkRay(origin, axes[random() % 4], maxDistance);
+    }
+    check(!detector.raycast({0, 0}, {0, 0}, 10), policy + ": no direction");
+
+    for (auto &block : blocks)
+        detector.disableCollision(block);
+    for (auto &disc : discs)
+        detector.disableCollision(disc);
+    for (auto &ball : balls)
+        detector.disableCollision(ball);
+}
+
+// nearest and withinRadius give the colliders sorted by distance, like a sort
+// of all of them, for colliders in many cells, points far from the colliders
+// and filters
+template<class Policy>
+static void testNearest(const char *name) {
+    const std::string policy = name;
+    std::mt19937 random(9);
+    std::uniform_real_distribution<float> position(-10, 110), size(0, 6);
+    const CollisionFilter layers[] = {{1, 0xFFFF}, {2, 0xFFFF}, {4, 3}};
+    auto layer = [&] { return layers[random() % 3]; };
+
+    BasicCollisionDetector<Policy, Circle, Rectangle, Point> detector;
+    std::deque<Block<Rectangle>> blocks;
+    std::deque<Block<Circle>> discs;
+    std::deque<Block<Point>> points;
+    std::deque<Mover<Circle>> balls;
+    for (int i = 0; i < 100; i++) {
+        // one in ten spans many cells
+        const float scale = i % 10 ? 1 : 8;
+        blocks.emplace_back(
+            (int) blocks.size(),
+            Rectangle({position(random), position(random)},
+                      {size(random) * scale, size(random) * scale}),
+            layer());
+        discs.emplace_back(
+            1000 + (int) discs.size(),
+            Circle(Point{position(random), position(random)},
+                   size(random) * scale / 2),
+            layer());
+        points.emplace_back(2000 + (int) points.size(),
+                            Point{position(random), position(random)},
+                            layer());
+        balls.emplace_back(3000 + (int) balls.size(),
+                           Circle(Point{position(random), position(random)},
+                                  size(random) * scale / 2),
+                           Vec2<>{0, 0},
+                           layer());
+    }
+    blocks.emplace_back(
+        (int) blocks.size(), Rectangle({5000, -3000}, {2, 2}), layers[0]);
+    std::vector<Block<Rectangle> *> baked;
+    for (size_t i = 0; i < blocks.size(); i += 3)
+        baked.push_back(&blocks[i]);
+    detector.bakeStatic(baked);
+    for (size_t i = 0; i < blocks.size(); i++)
+        if (i % 3)
+            detector.enableCollision(blocks[i]);
+    for (auto &disc : discs)
+        detector.enableCollision(disc);
+    for (auto &point : points)
+        detector.enableCollision(point);
+    for (auto &ball : balls)
+        detector.enableCollision(ball);
+    detector.update(1);
+
+    // every collider accepted by filter within maxDistance of point, by
+    // distance then by id
+    auto sorted = [&](const Vec2<> &point,
+                      float maxDistance,
+                      const CollisionFilter &filter) {
+        std::vector<std::pair<float, int>> all;
+        auto add = [&](const PhysicalObject &object, const auto &form) {
+            const float distance = form.distance(point);
+            if (distance <= maxDistance &&
+                filter.accepts(object.collisionFilter))
+                all.emplace_back(distance, Identified::of(&object));
+        };
+        for (const auto &block : blocks)
+            add(block, block.form);
+        for (const auto &disc : discs)
+            add(disc, disc.form);
+        for (const auto &point : points)
+            add(point, point.form);
+        for (const auto &ball : balls)
+            add(ball, ball.collider);
+        std::sort(all.begin(), all.end());
+        return all;
+    };
+    // the first count of expected, in any order for the same distance
+    auto checkFound = [&](const std::vector<Neighbour> &found,
+                          const std::vector<std::pair<float, int>> &expected,
+                          size_t count,
+                          const std::string &what) {
+        check(found.size() == std::min(count, expected.size()),
+              what + " count");
+        std::vector<int> ids;
+        for (size_t i = 0; i < found.size(); i++) {
+            check(found[i].distance == expected[i].first, what + " distances");
+            ids.push_back(Identified::of(found[i].object));
+            const auto it = std::find_if(
+                expected.begin(), expected.end(), [&](const auto &e) {
+                    return e.second == ids.back();
+                });
+            check(it != expected.end() && it->first == found[i].distance,
+                  what + " distance of a collider");
+        }
+        std::sort(ids.begin(), ids.end());
+        check(std::adjacent_find(ids.begin(), ids.end()) == ids.end(),
+              what + " found once");
+    };
+
+    const CollisionFilter filters[] = {
+        CollisionFilter::all(), layers[0], layers[1], layers[2], {8, 8}};
+    const float infinity = std::numeric_limits<float>::infinity();
+    std::vector<Neighbour> found;
+    for (int i = 0; i < 40; i++) {
+        // inside the world, or far from every collider but the far one
+        const Vec2<> point = i % 10 == 0   ? Vec2<>{1e4f, 1e4f}
+                             : i % 10 == 1 ? Vec2<>{-3000, 50}
+                             : i % 10 == 2 ? Vec2<>{4990, -2990}
+                                           : Vec2<>{position(random),
+                                                    position(random)};
+        const std::string at = policy + ": nearest to (" +
+                               std::to_string(point.x) + ", " +
+                               std::to_string(point.y) + ")";
+        for (const CollisionFilter &filter : filters)
+            for (float maxDistance : {infinity, 12.f, 3.f, 0.f}) {
+                const auto expected = sorted(point, maxDistance, filter);
+                for (size_t k : {1, 3, 40, 1000}) {
+                    detector.nearest(point, k, found, maxDistance, filter);
+                    checkFound(
+                        found, expected, k, at + " k " + std::to_string(k));
+                }
+                if (maxDistance == infinity)
+                    continue;
+                detector.withinRadius(point, maxDistance, found, filter);
+                checkFound(found,
+                           expected,
+                           expected.size(),
+                           at + " withinRadius");
+            }
+    }
+
+    for (size_t i = 0; i < blocks.size(); i++)
+        detector.disableCollision(blocks[i]);
+    for (auto &disc : discs)
+        detector.disableCollision(disc);
+    for (auto &point : points)
+        detector.disableCollision(point);
+    for (auto &ball : balls)
+        detector.disableCollision(ball);
+}
+
+// The sweep and prune broad phase answers like a linear scan while its widest
+// boxes shrink, move and leave, which makes it measure the widths again
+static void testSweepAndPruneWidths() {
+    struct Item {
+        Rectangle form{Vec2<>{0, 0}, Vec2<>{0, 0}};
+        uint32_t proxy = 0;
+        bool inserted = false;
+    };
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> position(0, 100), size(0, 4);
+    std::vector<Item> items(300);
+    SweepAndPrune<Item, Rectangle> broadPhase;
+    auto randomForm = [&](size_t i) {
+        // a few wide boxes, shrinking from frame to frame
+        const float width = i % 50 ? size(random) : 60 * size(random);
+        return Rectangle(Vec2<>{position(random), position(random)},
+                         Vec2<>{width, size(random)});
+    };
+
+    for (int frame = 0; frame < 200; frame++) {
+        for (size_t i = 0; i < items.size(); i++) {
+            Item &item = items[i];
+            const unsigned action = random() % 10;
+            if (!item.inserted && action < 5) {
+                item.form = randomForm(i);
+                item.proxy = broadPhase.insert(&item, item.form);
+                item.inserted = true;
+            } else if (item.inserted && action == 0) {
+                broadPhase.erase(item.proxy);
+                item.inserted = false;
+            } else if (item.inserted && action < 4) {
+                item.form = randomForm(i);
+                broadPhase.move(item.proxy, item.form);
+            }
+        }
+        for (int i = 0; i < 20; i++) {
+            const Rectangle query(Vec2<>{position(random), position(random)},
+                                  Vec2<>{size(random), size(random)});
+            std::vector<const Item *> found, expected;
+            broadPhase.query(query,
+                             [&](const Item *item) { found.push_back(item); });
+            for (const Item &item : items)
+                if (item.inserted &&
+                    item.form.bounds().overlap(query.bounds()))
+                    expected.push_back(&item);
+            std::sort(found.begin(), found.end());
+            check(found == expected,
+                  "sweep and prune query frame " + std::to_string(frame));
+        }
+    }
+}
+
+int main() {
+    try {
+        testSweepAndPruneWidths();
+        for (unsigned seed = 0; seed < 4; seed++)
+            testBakedGrid(seed);
+        testFilters<GridPolicy>("grid");
+        testFilters<AABBTreePolicy>("AABB tree");
+        testFilters<HierarchicalGridPolicy>("hierarchical grid");
+        testFilters<SweepAndPrunePolicy>("sweep and prune");
+        testRaycasts<GridPolicy>("grid");
+        testRaycasts<AABBTreePolicy>("AABB tree");
+        testRaycasts<HierarchicalGridPolicy>("hierarchical grid");
+        testRaycasts<SweepAndPrunePolicy>("sweep and prune");
+        testNearest<GridPolicy>("grid");
+        testNearest<AABBTreePolicy>("AABB tree");
+        testNearest<HierarchicalGridPolicy>("hierarchical grid");
+        testNearest<SweepAndPrunePolicy>("sweep and prune");
+        testPolicyAgrees<AABBTreePolicy>("AABB tree");
+        testPolicyAgrees<HierarchicalGridPolicy>("hierarchical grid");
+        testPolicyAgrees<SweepAndPrunePolicy>("sweep and prune");
+    } catch (const Exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "All broad phase tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,1213 @@
+#include <Blob/Collision/CollisionChunk.hpp>
+#include <Blob/Collision/CollisionDetector.hpp>
+#include <Blob/Collision/PackedForms.hpp>
+#include <Blob/Collision/Pathfinder.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace Blob;
+
+static void check(bool condition, const std::string &what) {
+    if (!condition)
+        throw Exception("Check failed: " + what);
+}
+
+class Probe : public DynamicCollider<Circle> {
+public:
+    unsigned updates = 0;
+    Vec2<> speed;
+    std::function<void(PhysicalObject *)> onHitStart;
+
+    explicit Probe(const Point &position) :
+        DynamicCollider<Circle>(typeid(Probe), Circle(position, 1)) {}
+
+    Circle preCollisionUpdate(Circle currentForm, float timeFlow) override {
+        updates++;
+        currentForm.position += speed * timeFlow;
+        return currentForm;
+    }
+
+    void hitStart(PhysicalObject *object) override {
+        if (onHitStart)
+            onHitStart(object);
+    }
+};
+
+class Counter : public DynamicCollider<Circle> {
+public:
+    std::vector<PhysicalObject *> starts;
+    std::vector<PhysicalObject *> ends;
+
+    explicit Counter(const Point &position) :
+        DynamicCollider<Circle>(typeid(Counter), Circle(position, 1)) {}
+
+    void hitStart(PhysicalObject *object) override {
+        starts.push_back(object);
+    }
+
+    void hitEnd(PhysicalObject *object) override { ends.push_back(object); }
+};
+
+class Wall : public StaticCollider<Rectangle> {
+public:
+    explicit Wall(const Rectangle &form) :
+        StaticCollider<Rectangle>(typeid(Wall), Rectangle(form)) {}
+};
+
+// The hit events of a collider disable and enable other colliders in the
+// middle of an update, the colliders after it are still updated once
+static void testDisableDuringUpdate(unsigned threads, bool disableLast) {
+    CollisionDetector detector;
+    detector.setParallelUpdate(threads);
+    Wall wall(Rectangle({0, 0}, {2, 2}));
+    Probe a(Point{1, 1}), b(Point{10, 10}), c(Point{20, 20}), d(Point{30, 30});
+    detector.enableCollision(wall);
+    detector.enableCollision(a);
+    detector.enableCollision(b);
+    detector.enableCollision(c);
+
+    Probe &disabled = disableLast ? c : b;
+    Probe &kept = disableLast ? b : c;
+    a.onHitStart = [&](PhysicalObject *) {
+        detector.disableCollision(disabled);
+        detector.enableCollision(d);
+    };
+    detector.update(1);
+    // the serial update disables it before its turn, the parallel one after
+    // its preCollisionUpdate
+    const unsigned disabledUpdates = threads > 1 ? 1 : 0;
+    check(a.updates == 1 && kept.updates == 1, "updated once");
+    check(disabled.updates == disabledUpdates, "disabled not updated");
+    check(d.updates == 0, "enabled during the update waits a frame");
+
+    a.onHitStart = nullptr;
+    detector.update(1);
+    check(a.updates == 2 && kept.updates == 2 && d.updates == 1,
+          "updated after the disable");
+    check(disabled.updates == disabledUpdates, "disabled stays disabled");
+
+    // the lists are compacted, the indices of the colliders are right
+    detector.disableCollision(kept);
+    detector.disableCollision(a);
+    detector.update(1);
+    check(d.updates == 2 && a.updates == 2, "disabled after the update");
+    detector.disableCollision(d);
+    detector.disableCollision(wall);
+}
+
+// A collider disabling itself from its own hit event
+static void testDisableSelf(unsigned threads) {
+    CollisionDetector detector;
+    detector.setParallelUpdate(threads);
+    Wall wall(Rectangle({0, 0}, {2, 2}));
+    Probe a(Point{1, 1}), b(Point{10, 10});
+    detector.enableCollision(wall);
+    detector.enableCollision(a);
+    detector.enableCollision(b);
+    a.onHitStart = [&](PhysicalObject *) { detector.disableCollision(a); };
+    detector.update(1);
+    detector.update(1);
+    check(a.updates == 1 && b.updates == 2, "disabled by its own event");
+    detector.enableCollision(a);
+    a.onHitStart = nullptr;
+    detector.update(1);
+    check(a.updates == 2 && b.updates == 3, "enabled again");
+    detector.disableCollision(a);
+    detector.disableCollision(b);
+    detector.disableCollision(wall);
+}
+
+// Queries from preCollisionUpdate, serial or parallel, do not report the
+// collider being updated
+class Seeker : public DynamicCollider<Circle> {
+public:
+    const CollisionDetector &detector;
+    PhysicalObject *other = nullptr;
+    bool foundSelf = false;
+    bool foundOther = true;
+
+    Seeker(const CollisionDetector &detector, const Point &position) :
+        DynamicCollider<Circle>(typeid(Seeker), Circle(position, 1)),
+        detector(detector) {}
+
+    Circle preCollisionUpdate(Circle currentForm, float timeFlow) override {
+        auto found = detector.testCollision(currentForm);
+        CollisionQueryResults results;
+        const Circle forms[] = {currentForm, currentForm};
+        detector.testCollisions(forms, results);
+        foundSelf |= found.contains(this);
+        foundOther &= found.contains(other);
+        for (const auto &hit : results.all()) {
+            foundSelf |= hit.object == this;
+            foundOther &= results[hit.query].size() == 1 && hit.object == other;
+        }
+        return currentForm;
+    }
+};
+
+static void testQueriesIgnoreUpdating(unsigned threads) {
+    CollisionDetector detector;
+    detector.setParallelUpdate(threads);
+    std::vector<std::unique_ptr<Seeker>> seekers;
+    for (int i = 0; i < 64; i++) {
+        seekers.push_back(std::make_unique<Seeker>(
+            detector, Point{(float) (i / 2) * 10, (float) (i % 2)}));
+        detector.enableCollision(*seekers.back());
+    }
+    for (size_t i = 0; i < seekers.size(); i++)
+        seekers[i]->other = seekers[i ^ 1].get();
+    detector.update(1);
+    for (const auto &seeker : seekers) {
+        check(!seeker->foundSelf, "query reports the updating collider");
+        check(seeker->foundOther, "query misses the other collider");
+        detector.disableCollision(*seeker);
+    }
+}
+
+// Random replace, attach, detach, snapshot and restore on a ContactCache,
+// checked against a map of the contacts of every run
+static void testContactCache(unsigned seed) {
+    constexpr size_t runCount = 24;
+    constexpr size_t targetCount = 12;
+    std::mt19937 random(seed);
+    auto chance = [&](unsigned percent) { return random() % 100 < percent; };
+    // the objects are never dereferenced, only compared
+    auto object = [](size_t i) {
+        return reinterpret_cast<PhysicalObject *>((uintptr_t) (i + 1) * 16);
+    };
+
+    ContactCache cache;
+    std::vector<std::unique_ptr<ContactRun>> runs;
+    std::vector<std::vector<PhysicalObject *>> contacts(runCount);
+    std::vector<bool> attached(runCount, true);
+    for (size_t i = 0; i < runCount; i++) {
+        runs.push_back(std::make_unique<ContactRun>(object(100 + i)));
+        cache.attach(*runs[i]);
+    }
+
+    auto toggle = [&](size_t i) {
+        if (attached[i])
+            cache.detach(*runs[i]);
+        else
+            cache.attach(*runs[i]);
+        attached[i] = !attached[i];
+    };
+    auto checkRuns = [&]() {
+        for (size_t i = 0; i < runCount; i++) {
+            auto targets = runs[i]->targets();
+            check(std::equal(targets.begin(),
+                             targets.end(),
+                             contacts[i].begin(),
+                             contacts[i].end()),
+                  "contacts of a run");
+        }
+    };
+    // forEach reads the table of the last frame, between two frames
+    auto checkTable = [&]() {
+        checkRuns();
+        size_t total = 0;
+        for (size_t i = 0; i < runCount; i++)
+            if (attached[i])
+                total += contacts[i].size();
+        size_t count = 0;
+        cache.forEach([&](PhysicalObject *owner, PhysicalObject *target) {
+            const size_t i = (uintptr_t) owner / 16 - 101;
+            check(attached[i] && std::binary_search(contacts[i].begin(),
+                                                    contacts[i].end(),
+                                                    target),
+                  "contact of forEach");
+            count++;
+        });
+        check(count == total, "contact count");
+    };
+
+    // targets destroyed, see BasicCollisionDetector::detachChunk
+    auto removeTargets = [&]() {
+        std::vector<PhysicalObject *> removed;
+        for (size_t t = 0; t < targetCount; t++)
+            if (chance(20))
+                removed.push_back(object(t));
+        std::vector<ContactCache::Contact> ended, expected;
+        cache.removeTargets(removed, ended);
+        for (size_t i = 0; i < runCount; i++)
+            std::erase_if(contacts[i], [&](PhysicalObject *target) {
+                if (!std::binary_search(
+                        removed.begin(), removed.end(), target))
+                    return false;
+                expected.emplace_back(runs[i]->owner, target);
+                return true;
+            });
+        std::sort(ended.begin(), ended.end());
+        check(ended == expected, "contacts removed");
+    };
+
+    ContactCache::Snapshot snapshot;
+    std::vector<std::vector<PhysicalObject *>> savedContacts;
+    for (int frame = 0; frame < 300; frame++) {
+        for (size_t i = 0; i < runCount; i++)
+            if (chance(5))
+                toggle(i);
+
+        if (chance(10)) {
+            cache.snapshot(snapshot);
+            savedContacts = contacts;
+            for (size_t i = 0; i < runCount; i++)
+                if (!attached[i])
+                    savedContacts[i].clear();
+        } else if (!savedContacts.empty() && chance(10)) {
+            bool restorable = true;
+            for (size_t i = 0; i < runCount; i++)
+                restorable &= attached[i] || savedContacts[i].empty();
+            if (restorable) {
+                cache.restore(snapshot);
+                for (size_t i = 0; i < runCount; i++)
+                    if (attached[i])
+                        contacts[i] = savedContacts[i];
+            }
+        }
+        if (chance(10))
+            removeTargets();
+        checkTable();
+
+        cache.beginFrame();
+        std::vector<size_t> order(runCount);
+        for (size_t i = 0; i < runCount; i++)
+            order[i] = i;
+        std::shuffle(order.begin(), order.end(), random);
+        // like the colliders enabled during an update, the runs attached
+        // during a frame are not written before the next one
+        std::vector<bool> written(runCount, false);
+        for (size_t i : order) {
+            // enabled or disabled by the events of the other runs
+            if (chance(5)) {
+                const size_t toggled = random() % runCount;
+                toggle(toggled);
+                written[toggled] = true;
+            }
+            if (chance(2))
+                removeTargets();
+            if (!attached[i] || written[i] || chance(30))
+                continue;
+            written[i] = true;
+
+            std::vector<PhysicalObject *> hits;
+            for (size_t t = 0; t < targetCount; t++)
+                if (chance(25))
+                    hits.push_back(object(t));
+            std::vector<PhysicalObject *> started, ended;
+            cache.replace(
+                *runs[i],
+                hits,
+                [&](PhysicalObject *target) { started.push_back(target); },
+                [&](PhysicalObject *target) { ended.push_back(target); });
+
+            std::vector<PhysicalObject *> expectedStarts, expectedEnds;
+            std::set_difference(hits.begin(),
+                                hits.end(),
+                                contacts[i].begin(),
+                                contacts[i].end(),
+                                std::back_inserter(expectedStarts));
+            std::set_difference(contacts[i].begin(),
+                                contacts[i].end(),
+                                hits.begin(),
+                                hits.end(),
+                                std::back_inserter(expectedEnds));
+            check(started == expectedStarts && ended == expectedEnds,
+                  "hit events");
+            contacts[i] = hits;
+        }
+        checkRuns();
+        cache.endFrame();
+        checkTable();
+    }
+}
+
+// The contacts with the colliders of a detached chunk end, also the ones
+// parked by a disabled collider, and nothing refers to them once the chunk is
+// destroyed
+static void testDetachChunk() {
+    CollisionDetector detector;
+    auto chunk = std::make_unique<CollisionChunk>(Vec2<int32_t>{0, 0});
+    chunk->add(Rectangle({0, 0}, {2, 2}));
+    chunk->add(Rectangle({10, 0}, {2, 2}));
+    chunk->bake();
+    detector.attachChunk(*chunk);
+    Counter touching(Point{1, 1}), disabled(Point{11, 1}), away(Point{50, 50});
+    detector.enableCollision(touching);
+    detector.enableCollision(disabled);
+    detector.enableCollision(away);
+    detector.update(1);
+    check(touching.starts.size() == 1 && disabled.starts.size() == 1,
+          "contacts with the chunk");
+
+    detector.disableCollision(disabled);
+    detector.detachChunk(*chunk);
+    check(touching.ends == touching.starts, "hitEnd of the detached chunk");
+    check(disabled.ends == disabled.starts, "hitEnd of the parked contacts");
+    check(away.ends.empty(), "hitEnd without contact");
+    chunk.reset();
+
+    detector.enableCollision(disabled);
+    size_t contacts = 0;
+    detector.forEachContact(
+        [&](PhysicalObject *, PhysicalObject *) { contacts++; });
+    check(contacts == 0, "contacts left after detachChunk");
+    detector.update(1);
+    check(touching.ends.size() == 1 && disabled.ends.size() == 1 &&
+              touching.starts.size() == 1 && disabled.starts.size() == 1,
+          "events after detachChunk");
+    detector.disableCollision(touching);
+    detector.disableCollision(disabled);
+    detector.disableCollision(away);
+}
+
+// The cells left by a moving collider are not counted by the statistics
+static void testGridStatistics() {
+    CollisionDetector detector;
+    Probe probe(Point{0.5f, 0.5f});
+    probe.speed = {3, 1};
+    detector.enableCollision(probe);
+    for (int i = 0; i < 10; i++)
+        detector.update(1);
+    const auto statistics =
+        detector.getDynamicBroadPhase<Circle>().statistics();
+    // a single collider, one reference per non empty cell
+    check(statistics.cells == statistics.entries, "non empty cells");
+    check(statistics.occupancy() == 1, "occupancy");
+    detector.disableCollision(probe);
+    check(detector.getDynamicBroadPhase<Circle>().statistics().cells == 0,
+          "empty grid");
+}
+
+// A slot reused past its last generation does not make the old handles of
+// the slot valid again
+static void testHandleReuse() {
+    CollisionDetector detector;
+    Probe a(Point{0, 0}), b(Point{10, 0});
+    std::vector<ColliderHandle> stale;
+    for (int i = 0; i < 600; i++) {
+        Probe &probe = i % 2 ? a : b;
+        detector.enableCollision(probe);
+        const ColliderHandle handle = probe.getHandle();
+        check(detector.find(handle) == &probe, "handle of an enabled collider");
+        for (ColliderHandle old : stale)
+            check(!detector.find(old), "stale handle");
+        detector.disableCollision(probe);
+        stale.push_back(handle);
+    }
+    detector.enableCollision(a);
+    detector.enableCollision(b);
+    check(detector.find(a.getHandle()) == &a &&
+              detector.find(b.getHandle()) == &b,
+          "handles after the retired slots");
+    detector.disableCollision(a);
+    detector.disableCollision(b);
+}
+
+// Records its events in a log shared by the colliders
+class Recorder : public DynamicCollider<Circle> {
+public:
+    std::vector<std::string> &log;
+    const Vec2<> speed;
+    const std::string name;
+
+    Recorder(std::vector<std::string> &log,
+             const Point &position,
+             const Vec2<> &speed,
+             std::string name) :
+        DynamicCollider<Circle>(typeid(Recorder), Circle(position, 1)),
+        log(log), speed(speed), name(std::move(name)) {}
+
+    std::string nameOf(PhysicalObject *object) const {
+        auto *recorder = dynamic_cast<Recorder *>(object);
+        return recorder ? recorder->name : "wall";
+    }
+
+    // the state of the collider, to compare it before and after a restore
+    std::string state() const {
+        std::string state = name + " " + std::to_string(collider.position.x) +
+                             " " + std::to_string(collider.position.y) +
+                             (isSleeping() ? " sleeping" : " awake") + " " +
+                             std::to_string(getHandle().index()) + "/" +
+                             std::to_string(getHandle().generation());
+        for (PhysicalObject *object : hittingObjects())
+            state += " " + nameOf(object);
+        return state;
+    }
+
+    Circle preCollisionUpdate(Circle currentForm, float timeFlow) override {
+        currentForm.position += speed * timeFlow;
+        return currentForm;
+    }
+
+    void hitStart(PhysicalObject *object) override {
+        log.push_back(name + " start " + nameOf(object));
+    }
+
+    void hitEnd(PhysicalObject *object) override {
+        log.push_back(name + " end " + nameOf(object));
+    }
+
+    void sleepStart() override { log.push_back(name + " sleep"); }
+
+    void sleepEnd() override { log.push_back(name + " wake"); }
+};
+
+// Update, restore a snapshot and update again: the state at the snapshot
+// comes back and the same events are sent again
+static void testSnapshotRoundTrip(unsigned threads) {
+    std::vector<std::string> log;
+    CollisionDetector detector;
+    detector.setParallelUpdate(threads);
+    detector.setSleepDelay(3);
+    Wall wall(Rectangle({20, 0}, {2, 40}));
+    detector.enableCollision(wall);
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> position(0, 40), speed(-1, 1);
+    std::vector<std::unique_ptr<Recorder>> recorders;
+    for (int i = 0; i < 40; i++) {
+        // every third one rests until a moving one touches it
+        recorders.push_back(std::make_unique<Recorder>(
+            log,
+            Point{position(random), position(random)},
+            i % 3 ? Vec2<>{speed(random), speed(random)} : Vec2<>{0, 0},
+            "c" + std::to_string(i)));
+        detector.enableCollision(*recorders.back());
+    }
+    auto state = [&]() {
+        std::vector<std::string> state;
+        for (const auto &recorder : recorders)
+            state.push_back(recorder->state());
+        detector.forEachContact([&](PhysicalObject *a, PhysicalObject *b) {
+            state.push_back(recorders[0]->nameOf(a) + "-" +
+                            recorders[0]->nameOf(b));
+        });
+        std::sort(state.begin(), state.end());
+        return state;
+    };
+
+    for (int i = 0; i < 5; i++)
+        detector.update(1);
+    CollisionDetector::Snapshot snapshot;
+    detector.snapshot(snapshot);
+    const auto saved = state();
+    log.clear();
+    std::vector<std::vector<std::string>> states;
+    for (int i = 0; i < 20; i++) {
+        detector.update(1);
+        states.push_back(state());
+    }
+    const auto events = log;
+    check(!events.empty(), "events after the snapshot");
+
+    for (int round = 0; round < 2; round++) {
+        detector.restore(snapshot);
+        check(state() == saved, "state restored");
+        log.clear();
+        for (int i = 0; i < 20; i++) {
+            detector.update(1);
+            check(state() == states[i], "state after the restore");
+        }
+        check(log == events, "events after the restore");
+    }
+    for (const auto &recorder : recorders)
+        detector.disableCollision(*recorder);
+    detector.disableCollision(wall);
+}
+
+// A flow field shared by several holders stays alive and up to date until
+// the last one lets it go
+static void testSharedFlowField() {
+    CollisionDetector detector;
+    Wall wall(Rectangle({10, 10}, {2, 16}));
+    detector.enableCollision(wall);
+    Pathfinder pathfinder(detector, Box{{0, 0}, {20, 20}}, 1, 0.4f, 1);
+    const Box region{{0, 0}, {20, 20}};
+    const Point goal{15.5f, 10.5f};
+
+    auto first = pathfinder.flowField(goal, region);
+    auto second = pathfinder.flowField(goal, region);
+    check(first == second, "same field for the same goal");
+    std::weak_ptr<const FlowField> watched = first;
+    first.reset();
+    pathfinder.update();
+    check(!watched.expired(), "field dropped while still held");
+
+    // the path around the wall gets shorter once it is removed
+    const Point start{4.5f, 10.5f};
+    const float around = second->distance(start);
+    detector.disableCollision(wall);
+    pathfinder.update();
+    check(second->distance(start) < around, "held field rebuilt");
+
+    second.reset();
+    check(!watched.expired(), "field dropped before update");
+    pathfinder.update();
+    check(watched.expired(), "field kept once released by every holder");
+}
+
+// Length of the shortest paths from cell to every cell of the grid, moving
+// like the agents of NavigationGrid, infinity where there is none
+static std::vector<float> shortestPaths(const NavigationGrid &grid,
+                                        const Vec2<int32_t> &cell) {
+    const Vec2<int32_t> size = grid.size();
+    auto index = [&](const Vec2<int32_t> &c) { return c.y * size.x + c.x; };
+    std::vector<float> distances(
+        size.x * size.y, std::numeric_limits<float>::infinity());
+    if (!grid.isWalkable(cell))
+        return distances;
+    std::vector<std::pair<float, Vec2<int32_t>>> heap{{0.f, cell}};
+    auto further = [](const auto &a, const auto &b) {
+        return a.first > b.first;
+    };
+    distances[index(cell)] = 0;
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), further);
+        const auto [distance, current] = heap.back();
+        heap.pop_back();
+        if (distance > distances[index(current)])
+            continue;
+        for (int32_t dy = -1; dy <= 1; dy++) {
+            for (int32_t dx = -1; dx <= 1; dx++) {
+                const Vec2<int32_t> next{current.x + dx, current.y + dy};
+                if (!grid.isWalkable(next) ||
+                    (dx != 0 && dy != 0 &&
+                     (!grid.isWalkable({current.x + dx, current.y}) ||
+                      !grid.isWalkable({current.x, current.y + dy}))))
+                    continue;
+                const float d =
+                    distance + std::sqrt((float) (dx * dx + dy * dy));
+                if (d < distances[index(next)]) {
+                    distances[index(next)] = d;
+                    heap.push_back({d, next});
+                    std::push_heap(heap.begin(), heap.end(), further);
+                }
+            }
+        }
+    }
+    return distances;
+}
+
+// The path joins the centers of the cells of from and to through walkable
+// cells, moving like the agents. It crosses the borders of the clusters at
+// their nodes, or stays in the clusters of its ends when they touch, so it
+// may be twice as long as the shortest and detour around a cluster.
+// @return its length
+static float checkPath(const NavigationGrid &grid,
+                      const Vec2<> &from,
+                      const Vec2<> &to,
+                      const std::vector<Vec2<>> &path,
+                      float shortest,
+                      const std::string &what) {
+    const Vec2<int32_t> last = grid.cellAt(to);
+    check(!path.empty() && path.front() == grid.centerOf(grid.cellAt(from)) &&
+              path.back() == grid.centerOf(last),
+          what + " ends");
+    float length = 0;
+    for (size_t i = 0; i < path.size(); i++) {
+        const Vec2<int32_t> cell = grid.cellAt(path[i]);
+        check(grid.isWalkable(cell), what + " on walkable cells");
+        if (i == 0)
+            continue;
+        const Vec2<int32_t> previous = grid.cellAt(path[i - 1]);
+        const int32_t dx = cell.x - previous.x, dy = cell.y - previous.y;
+        check(std::abs(dx) <= 1 && std::abs(dy) <= 1 && (dx != 0 || dy != 0),
+              what + " moves to the next cells");
+        check(dx == 0 || dy == 0 ||
+                  (grid.isWalkable({cell.x, previous.y}) &&
+                   grid.isWalkable({previous.x, cell.y})),
+              what + " cuts no corner");
+        length += Vec2<>(path[i - 1], path[i]).length();
+    }
+    check(length >= shortest - 1e-3f && length <= shortest * 2 + 16,
+          what + " length " + std::to_string(length) + " for " +
+              std::to_string(shortest));
+    return length;
+}
+
+// Random walls, then two unreachable enclosures, then a wall ending on the
+// border of the first cluster, so the cells of its neighbour stay the same
+static std::vector<std::unique_ptr<Wall>> randomWalls(std::mt19937 &random,
+                                                      const Box &area) {
+    std::vector<std::unique_ptr<Wall>> walls;
+    auto coordinate = [&](float min, float max) {
+        return std::floor(std::uniform_real_distribution<float>(min, max)(
+            random));
+    };
+    for (int i = 0; i < 25; i++) {
+        const Vec2<> size{coordinate(1, 7), coordinate(1, 7)};
+        const Vec2<> position{coordinate(area.min.x, area.max.x),
+                              coordinate(area.min.y, area.max.y)};
+        walls.push_back(std::make_unique<Wall>(
+            Rectangle(position + size / 2, size)));
+    }
+    for (int i = 0; i < 2; i++) {
+        const Vec2<> center{coordinate(area.min.x + 4, area.max.x - 4),
+                            coordinate(area.min.y + 4, area.max.y - 4)};
+        walls.push_back(std::make_unique<Wall>(
+            Rectangle(center + Vec2<>{0, 3}, Vec2<>{7, 1})));
+        walls.push_back(std::make_unique<Wall>(
+            Rectangle(center - Vec2<>{0, 3}, Vec2<>{7, 1})));
+        walls.push_back(std::make_unique<Wall>(
+            Rectangle(center + Vec2<>{3, 0}, Vec2<>{1, 7})));
+        walls.push_back(std::make_unique<Wall>(
+            Rectangle(center - Vec2<>{3, 0}, Vec2<>{1, 7})));
+    }
+    walls.push_back(std::make_unique<Wall>(Rectangle(
+        Vec2<>{area.min.x + 14, coordinate(area.min.y, area.max.y)},
+        Vec2<>{3, 9})));
+    return walls;
+}
+
+// findPath finds a path exactly when the cells are joined, near the shortest
+// one, and the workers answer the requests with the same paths. Removing a
+// wall repairs the grid as if it was built without it.
+static void testPaths(unsigned seed) {
+    std::mt19937 random(seed);
+    // partial clusters on the top side
+    const Box area{{-8, -4}, {56, 36}};
+    CollisionDetector detector;
+    std::vector<std::unique_ptr<Wall>> walls = randomWalls(random, area);
+    for (const std::unique_ptr<Wall> &wall : walls)
+        detector.enableCollision(*wall);
+    Pathfinder pathfinder(detector, area, 1, 0.4f, 3);
+    std::uniform_real_distribution<float> x(area.min.x - 1, area.max.x + 1);
+    std::uniform_real_distribution<float> y(area.min.y - 1, area.max.y + 1);
+
+    // reference gives the same paths, if any
+    auto checkPaths = [&](const std::string &name,
+                          const Pathfinder *reference) {
+        const NavigationGrid &grid = pathfinder.getGrid();
+        size_t found = 0, unreachable = 0;
+        float length = 0, shortest = 0;
+        std::vector<std::pair<Vec2<>, Vec2<>>> requests;
+        std::vector<std::vector<Vec2<>>> expected;
+        for (int i = 0; i < 60; i++) {
+            const Vec2<> from{x(random), y(random)};
+            const std::vector<float> distances =
+                shortestPaths(grid, grid.cellAt(from));
+            for (int j = 0; j < 5; j++) {
+                const Vec2<> to{x(random), y(random)};
+                const Vec2<int32_t> goal = grid.cellAt(to);
+                const std::string what = name + " path " + std::to_string(i) +
+                                         ", " + std::to_string(j);
+                const bool reachable =
+                    grid.isWalkable(grid.cellAt(from)) &&
+                    grid.isWalkable(goal) &&
+                    distances[goal.y * grid.size().x + goal.x] !=
+                        std::numeric_limits<float>::infinity();
+                std::vector<Vec2<>> path{from};
+                check(pathfinder.findPath(from, to, path) == reachable,
+                      what + " found");
+                if (reachable) {
+                    const float distance =
+                        distances[goal.y * grid.size().x + goal.x];
+                    length += checkPath(grid, from, to, path, distance, what);
+                    shortest += distance;
+                } else
+                    check(path.empty(), what + " empty");
+                std::vector<Vec2<>> other;
+                check(!reference ||
+                          (reference->findPath(from, to, other) ==
+                               reachable &&
+                           other == path),
+                      what + " as the reference");
+                (reachable ? found : unreachable)++;
+                requests.push_back({from, to});
+                expected.push_back(path);
+            }
+        }
+        check(found > 100 && unreachable > 10,
+              name + " reachable and unreachable goals");
+        // a few percent longer than the shortest paths on the whole
+        check(length <= shortest * 1.1f, name + " paths near the shortest");
+
+        // requested from several threads, answered by the workers
+        std::vector<uint64_t> ids(requests.size());
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < 3; t++)
+            threads.emplace_back([&, t] {
+                for (size_t i = t; i < requests.size(); i += 3)
+                    ids[i] = pathfinder.request(requests[i].first,
+                                                requests[i].second);
+            });
+        for (std::thread &thread : threads)
+            thread.join();
+        pathfinder.waitIdle();
+        std::vector<PathResult> results;
+        check(pathfinder.takePaths(results) == requests.size(),
+              name + " every request answered");
+        check(pathfinder.takePaths(results) == 0, name + " answered once");
+        std::sort(results.begin(),
+                  results.end(),
+                  [](const PathResult &a, const PathResult &b) {
+                      return a.request < b.request;
+                  });
+        for (size_t i = 0; i < requests.size(); i++) {
+            const auto result =
+                std::lower_bound(results.begin(),
+                                 results.end(),
+                                 ids[i],
+                                 [](const PathResult &r, uint64_t id) {
+                                     return r.request < id;
+                                 });
+            check(result != results.end() && result->request == ids[i] &&
+                      result->found == !expected[i].empty() &&
+                      result->points == expected[i],
+                  name + " request " + std::to_string(i));
+        }
+    };
+    checkPaths("built", nullptr);
+
+    // the enclosures open and the border wall goes, the grid is repaired as
+    // if built without them
+    const std::vector<size_t> removed{
+        walls.size() - 9, walls.size() - 5, walls.size() - 1};
+    for (size_t i : removed)
+        detector.disableCollision(*walls[i]);
+    pathfinder.update();
+    const Pathfinder rebuilt(detector, area, 1, 0.4f, 1);
+    const NavigationGrid &grid = pathfinder.getGrid();
+    for (int32_t cy = 0; cy < grid.size().y; cy++)
+        for (int32_t cx = 0; cx < grid.size().x; cx++)
+            check(grid.isWalkable({cx, cy}) ==
+                      rebuilt.getGrid().isWalkable({cx, cy}),
+                  "repaired cells");
+    check(grid.nodeCount() == rebuilt.getGrid().nodeCount(),
+          "repaired nodes");
+    checkPaths("repaired", &rebuilt);
+
+    for (size_t i = 0; i < walls.size(); i++)
+        if (std::find(removed.begin(), removed.end(), i) == removed.end())
+            detector.disableCollision(*walls[i]);
+}
+
+// Moves at speed, counts its updates and sleeps
+class Sleeper : public DynamicCollider<Circle> {
+public:
+    Vec2<> speed;
+    unsigned updates = 0, sleeps = 0, wakes = 0;
+
+    explicit Sleeper(const Point &position, const Vec2<> &speed = {0, 0}) :
+        DynamicCollider<Circle>(typeid(Sleeper), Circle(position, 1)),
+        speed(speed) {}
+
+    using DynamicCollider<Circle>::hittingObjects;
+
+    bool touches(PhysicalObject *object) const {
+        const auto targets = hittingObjects();
+        return std::find(targets.begin(), targets.end(), object) !=
+               targets.end();
+    }
+
+    Circle preCollisionUpdate(Circle currentForm, float timeFlow) override {
+        updates++;
+        currentForm.position += speed * timeFlow;
+        return currentForm;
+    }
+
+    void sleepStart() override { sleeps++; }
+
+    void sleepEnd() override { wakes++; }
+};
+
+// A resting collider falls asleep after the delay and keeps its contacts. It
+// wakes when a moving collider touches it or leaves it, on wakeUp and when it
+// is enabled again.
+static void testSleep(unsigned threads) {
+    constexpr uint32_t delay = 3;
+    CollisionDetector detector;
+    detector.setParallelUpdate(threads);
+    detector.setSleepDelay(delay);
+    Wall wall(Rectangle({0, -1.25f}, {4, 1}));
+    Sleeper resting(Point{0, 0});
+    Sleeper moving(Point{12, 0}, {-1, 0});
+    detector.enableCollision(wall);
+    detector.enableCollision(resting);
+    detector.enableCollision(moving);
+
+    // the first update starts the contact with the wall
+    for (uint32_t i = 0; i <= delay; i++) {
+        check(!resting.isSleeping(), "awake before the delay");
+        detector.update(1);
+    }
+    check(resting.isSleeping() && resting.sleeps == 1, "asleep after delay");
+    check(!moving.isSleeping(), "the moving one stays awake");
+    const unsigned updates = resting.updates;
+    detector.update(1);
+    check(resting.updates == updates, "a sleeping collider is not updated");
+    check(resting.touches(&wall), "contacts kept while sleeping");
+    bool reported = false;
+    detector.forEachContact([&](PhysicalObject *a, PhysicalObject *b) {
+        reported = reported || (a == &resting && b == &wall);
+    });
+    check(reported, "contacts of a sleeping collider reported");
+    check(detector.testCollision(Circle(Point{0, 0}, 0.5f)).contains(&resting),
+          "a sleeping collider is found by the queries");
+
+    // the moving one reaches it and reports it in its contacts
+    while (!moving.touches(&resting)) {
+        check(resting.isSleeping(), "asleep until touched");
+        check(moving.collider.position.x > 0, "the moving one touches it");
+        detector.update(1);
+    }
+    check(!resting.isSleeping() && resting.wakes == 1, "woken by a touch");
+    detector.update(1);
+    check(resting.touches(&moving), "the woken one sees the moving one");
+
+    // both fall asleep touching each other, then the moving one leaves in a
+    // single update
+    moving.speed = {0, 0};
+    for (uint32_t i = 0; i <= delay + 1; i++)
+        detector.update(1);
+    check(resting.isSleeping() && moving.isSleeping(), "asleep together");
+    moving.speed = {-5, 0};
+    detector.wakeUp(moving);
+    detector.update(1);
+    check(!moving.touches(&resting), "left in one update");
+    check(!resting.isSleeping() && resting.wakes == 2, "woken by a leave");
+    for (uint32_t i = 0; i <= delay + 1; i++)
+        detector.update(1);
+    check(resting.isSleeping() && !resting.touches(&moving),
+          "asleep again once left");
+    const unsigned wakes = resting.wakes;
+
+    // woken by hand, for instance after changing its speed
+    resting.speed = {0, 1};
+    detector.wakeUp(resting);
+    check(!resting.isSleeping() && resting.wakes == wakes + 1,
+          "woken by wakeUp");
+    detector.update(1);
+    check(resting.collider.position.y == 1, "moves once woken");
+    resting.speed = {0, 0};
+    for (uint32_t i = 0; i <= delay + 1; i++)
+        detector.update(1);
+    check(resting.isSleeping(), "asleep again after wakeUp");
+
+    // enabled again awake
+    detector.disableCollision(resting);
+    detector.enableCollision(resting);
+    check(!resting.isSleeping(), "awake once enabled again");
+    const unsigned before = resting.updates;
+    detector.update(1);
+    check(resting.updates == before + 1, "updated once enabled again");
+
+    detector.disableCollision(resting);
+    detector.disableCollision(moving);
+    detector.disableCollision(wall);
+}
+
+// Random forms for the batch kernels: half of them on a coarse lattice, so
+// boundaries touch exactly, and some of size zero
+class Bullet : public DynamicCollider<Circle> {
+public:
+    Vec2<> speed;
+    // stop on the first collider on the way
+    bool stops = false;
+    std::vector<PhysicalObject *> starts;
+    std::optional<RaycastHit> swept;
+
+    Bullet(const Point &position,
+           const Vec2<> &speed,
+           const CollisionFilter &filter = {}) :
+        DynamicCollider<Circle>(
+            typeid(Bullet), Circle(position, 0.25f), filter),
+        speed(speed) {}
+
+    using DynamicCollider<Circle>::hittingObjects;
+
+    Circle preCollisionUpdate(Circle currentForm, float timeFlow) override {
+        currentForm.position += speed * timeFlow;
+        return currentForm;
+    }
+
+    void hitStart(PhysicalObject *object) override { starts.push_back(object); }
+
+    Circle postCollisionUpdate(const Circle &currentForm,
+                               Circle nextForm,
+                               float timeFlow) override {
+        swept = sweepHit();
+        if (stops && swept)
+            nextForm.position = swept->point;
+        return nextForm;
+    }
+};
+
+static bool approx(float a, float b) { return std::abs(a - b) < 1e-4f; }
+
+// A bullet crossing a thin wall in one update goes through it, unless it is
+// continuous: then it hits the first collider on its way, at the time of
+// impact, and can stop there
+static void testContinuous(unsigned threads) {
+    CollisionDetector detector;
+    detector.setParallelUpdate(threads);
+    Wall near(Rectangle({30, 0}, {0.05f, 40}));
+    Wall far(Rectangle({50, 0}, {0.05f, 40}));
+    Probe behind(Point{69, 4});
+    detector.enableCollision(near);
+    detector.enableCollision(far);
+    detector.enableCollision(behind);
+
+    Bullet discrete(Point{0, 0}, {100, 0});
+    Bullet continuous(Point{0, 2}, {100, 0});
+    Bullet stopped(Point{0, 4}, {100, 0});
+    Bullet inside(Point{30, 6}, {100, 0});
+    Bullet slanted(Point{60, -8}, {30, 40});
+    Bullet filtered(Point{0, 10}, {100, 0}, {2, 2});
+    stopped.stops = true;
+    for (Bullet *bullet :
+         {&discrete, &continuous, &stopped, &inside, &slanted, &filtered}) {
+        detector.enableCollision(*bullet);
+        if (bullet != &discrete)
+            detector.setContinuous(*bullet, true);
+    }
+    detector.update(1);
+
+    check(discrete.starts.empty() && !discrete.swept &&
+              discrete.collider.position.x == 100,
+          "a discrete bullet goes through");
+
+    check(continuous.starts == std::vector<PhysicalObject *>{&near},
+          "the first wall on the way is hit");
+    check(continuous.swept && continuous.swept->object == &near,
+          "the first wall on the way is swept");
+    check(approx(continuous.swept->distance, 29.725f) &&
+              approx(continuous.swept->point.x, 29.725f) &&
+              approx(continuous.swept->point.y, 2),
+          "time of impact on the wall");
+    check(continuous.swept->normal == Vec2<>{-1, 0},
+          "normal of the wall facing the bullet");
+    check(continuous.collider.position.x == 100, "the bullet goes on");
+
+    check(stopped.swept && stopped.swept->object == &near &&
+              approx(stopped.collider.position.x, 29.725f),
+          "a bullet stopped on the wall");
+
+    check(inside.swept && inside.swept->object == &near &&
+              inside.swept->distance == 0 &&
+              inside.swept->normal == Vec2<>{-1, 0},
+          "a bullet starting in a wall hits it at once");
+
+    // the slanted one moves by 50 and passes on the probe after 15
+    check(slanted.starts == std::vector<PhysicalObject *>{&behind} &&
+              slanted.swept && approx(slanted.swept->distance, 13.75f),
+          "a dynamic collider is hit on the way");
+    check(approx(slanted.swept->normal.x, -0.6f) &&
+              approx(slanted.swept->normal.y, -0.8f),
+          "normal of a dynamic collider facing the bullet");
+
+    check(filtered.starts.empty() && !filtered.swept,
+          "the filters apply to the sweeps");
+}
+
+class FormMaker {
+private:
+    std::mt19937 random;
+
+    float coordinate() {
+        if (random() % 2)
+            return (float) ((int) (random() % 17) - 8) / 2;
+        return std::uniform_real_distribution<float>(-4, 4)(random);
+    }
+
+    float extent() {
+        if (random() % 5 == 0)
+            return 0;
+        if (random() % 2)
+            return (float) (random() % 9) / 2;
+        return std::uniform_real_distribution<float>(0, 4)(random);
+    }
+
+public:
+    explicit FormMaker(unsigned seed) : random(seed) {}
+
+    Circle circle() { return {Point{coordinate(), coordinate()}, extent()}; }
+
+    Rectangle rectangle() {
+        return {Vec2<>{coordinate(), coordinate()}, Vec2<>{extent(), extent()}};
+    }
+
+    Point point() { return Vec2<>{coordinate(), coordinate()}; }
+
+    Line line() {
+        Vec2<> a = point(), b = point();
+        return {a, b};
+    }
+
+    uint32_t index(uint32_t count) { return random() % count; }
+};
+
+// overlapBatch gives the hits of the scalar overlap, in the candidate order,
+// whatever the number of candidates compared to the SIMD width
+template<class Form, class Target>
+static void testOverlapBatch(FormMaker &maker,
+                             Form (FormMaker::*makeForm)(),
+                             Target (FormMaker::*makeTarget)(),
+                             const std::string &name) {
+    constexpr uint32_t targetCount = 64;
+    PackedForms<Target> packed;
+    std::vector<Target> targets;
+    for (uint32_t i = 0; i < targetCount; i++) {
+        targets.push_back((maker.*makeTarget)());
+        packed.set(i, targets.back());
+    }
+    for (int round = 0; round < 200; round++) {
+        const Form form = (maker.*makeForm)();
+        // 0 to 19 candidates, repeated ones included
+        std::vector<uint32_t> candidates(round % 20);
+        for (uint32_t &candidate : candidates)
+            candidate = maker.index(targetCount);
+
+        std::vector<uint32_t> expected;
+        for (uint32_t candidate : candidates)
+            if (form.overlap(targets[candidate]))
+                expected.push_back(candidate);
+        std::vector<uint32_t> hits(candidates.size());
+        hits.resize(overlapBatch(form, packed, candidates, hits.data()));
+        check(hits == expected, "overlapBatch of " + name);
+    }
+}
+
+static void testOverlapBatches(unsigned seed) {
+    FormMaker maker(seed);
+    testOverlapBatch(
+        maker, &FormMaker::circle, &FormMaker::circle, "circle, circles");
+    testOverlapBatch(
+        maker, &FormMaker::circle, &FormMaker::rectangle, "circle, rectangles");
+    testOverlapBatch(
+        maker, &FormMaker::circle, &FormMaker::point, "circle, points");
+    testOverlapBatch(
+        maker, &FormMaker::rectangle, &FormMaker::circle, "rectangle, circles");
+    testOverlapBatch(maker,
+                     &FormMaker::rectangle,
+                     &FormMaker::rectangle,
+                     "rectangle, rectangles");
+    testOverlapBatch(
+        maker, &FormMaker::rectangle, &FormMaker::point, "rectangle, points");
+    testOverlapBatch(
+        maker, &FormMaker::point, &FormMaker::circle, "point, circles");
+    testOverlapBatch(
+        maker, &FormMaker::point, &FormMaker::rectangle, "point, rectangles");
+}
+
+// The fields of two resolutions differ by at most 1e-4, relative to their
+// size past 1, or are both NaN
+static bool approxResolution(const CollisionResolution &a,
+                             const CollisionResolution &b) {
+    auto same = [](float x, float y) {
+        if (std::isnan(x) || std::isnan(y))
+            return std::isnan(x) && std::isnan(y);
+        return std::abs(x - y) <=
+               1e-4f * std::max({1.f, std::abs(x), std::abs(y)});
+    };
+    auto sameVec = [&](const Vec2<> &u, const Vec2<> &v) {
+        return same(u.x, v.x) && same(u.y, v.y);
+    };
+    return a.collision == b.collision &&
+           sameVec(a.collisionPoint, b.collisionPoint) &&
+           sameVec(a.normal, b.normal) && sameVec(a.bounce, b.bounce) &&
+           sameVec(a.shift, b.shift);
+}
+
+// resolveBatch gives the resolutions of the scalar resolve, the pairs not
+// colliding included, whatever the number of pairs compared to the SIMD width
+template<class Form, class Target>
+static void testResolveBatch(FormMaker &maker,
+                             Form (FormMaker::*makeForm)(),
+                             Target (FormMaker::*makeTarget)(),
+                             const std::string &name) {
+    constexpr uint32_t count = 64;
+    PackedForms<Form> movers;
+    PackedForms<Point> destinations;
+    PackedForms<Target> targets;
+    for (uint32_t i = 0; i < count; i++) {
+        movers.set(i, (maker.*makeForm)());
+        destinations.set(i, maker.point());
+        targets.set(i, (maker.*makeTarget)());
+    }
+    size_t collisions = 0, misses = 0;
+    for (int round = 0; round < 200; round++) {
+        // 0 to 19 pairs, repeated ones included
+        std::vector<uint32_t> moverIndices(round % 20),
+            targetIndices(round % 20);
+        for (size_t i = 0; i < moverIndices.size(); i++) {
+            moverIndices[i] = maker.index(count);
+            targetIndices[i] = maker.index(count);
+        }
+
+        std::vector<CollisionResolution> results(moverIndices.size());
+        resolveBatch(movers,
+                     destinations,
+                     targets,
+                     moverIndices,
+                     targetIndices,
+                     results.data());
+        for (size_t i = 0; i < results.size(); i++) {
+            const uint32_t m = moverIndices[i];
+            const CollisionResolution expected = movers[m].resolve(
+                targets[targetIndices[i]], destinations[m]);
+            check(approxResolution(results[i], expected),
+                  "resolveBatch of " + name + ", round " +
+                      std::to_string(round) + " pair " + std::to_string(i));
+            (expected.collision ? collisions : misses)++;
+        }
+    }
+    check(collisions > 0 && misses > 0,
+          "resolveBatch of " + name + " meets collisions and misses");
+}
+
+static void testResolveBatches(unsigned seed) {
+    FormMaker maker(seed);
+    testResolveBatch(
+        maker, &FormMaker::circle, &FormMaker::circle, "circle, circles");
+    testResolveBatch(
+        maker, &FormMaker::circle, &FormMaker::line, "circle, lines");
+    testResolveBatch(maker,
+                     &FormMaker::rectangle,
+                     &FormMaker::rectangle,
+                     "rectangle, rectangles");
+}
+
+int main() {
+    try {
+        for (unsigned seed = 0; seed < 20; seed++)
+            testContactCache(seed);
+        for (unsigned seed = 0; seed < 20; seed++)
+            testOverlapBatches(seed);
+        for (unsigned seed = 0; seed < 20; seed++)
+            testResolveBatches(seed);
+        testDetachChunk();
+        testGridStatistics();
+        testHandleReuse();
+        testSharedFlowField();
+        for (unsigned seed = 0; seed < 5; seed++)
+            testPaths(seed);
+        for (unsigned threads : {1u, 4u}) {
+            testDisableDuringUpdate(threads, false);
+            testDisableDuringUpdate(threads, true);
+            testDisableSelf(threads);
+            testQueriesIgnoreUpdating(threads);
+            testSnapshotRoundTrip(threads);
+            testSleep(threads);
+            testContinuous(threads);
+        }
+    } catch (const Exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "All detector tests passed" << std::endl;
+    return 0;
+}
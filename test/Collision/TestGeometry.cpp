@@ -0,0 +1,755 @@
+#include <Blob/Collision/Forms.hpp>
+#include <Blob/Core/Exception.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <numbers>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Blob;
+
+static void check(bool condition, const std::string &what) {
+    if (!condition)
+        throw Exception("Check failed: " + what);
+}
+
+static std::string describe(const Vec2<> &a, const Vec2<> &b) {
+    return "(" + std::to_string(a.x) + ", " + std::to_string(a.y) + ") to (" +
+           std::to_string(b.x) + ", " + std::to_string(b.y) + ")";
+}
+
+static Vec2<int32_t> cellOf(const Vec2<> &point) {
+    return {(int32_t) std::floor(point.x), (int32_t) std::floor(point.y)};
+}
+
+// The cells of a traversal: from the cell of a to the cell of b, each one
+// next to the previous, entered in time order, with every cell the segment
+// goes through, and contains() giving the same cells
+static void checkTraversal(const Vec2<> &a, const Vec2<> &b) {
+    const std::string segment = describe(a, b);
+    const GridTraversal traversal{a, b};
+    std::vector<Vec2<int32_t>> cells;
+    float entry = 0;
+    for (auto it = traversal.begin(); it != traversal.end(); ++it) {
+        check(it.entryTime() >= entry && it.entryTime() <= 1,
+              "entry times of " + segment);
+        check(it.exitTime() >= it.entryTime(), "exit time of " + segment);
+        if (!cells.empty()) {
+            const Vec2<int32_t> step = *it - cells.back();
+            check(std::abs(step.x) + std::abs(step.y) == 1,
+                  "adjacent cells of " + segment);
+            check(it.crossedNormal() == -step.cast<float>(),
+                  "crossed normal of " + segment);
+        }
+        entry = it.entryTime();
+        cells.push_back(*it);
+        check(cells.size() < 1000, "end of " + segment);
+    }
+    check(cells.front() == cellOf(a), "first cell of " + segment);
+    check(cells.back() == cellOf(b), "last cell of " + segment);
+
+    auto visited = [&](const Vec2<int32_t> &cell) {
+        return std::find(cells.begin(), cells.end(), cell) != cells.end();
+    };
+    // the points of the segment, but the ones next to a corner where the
+    // rounding may pick either side
+    for (int i = 0; i <= 1000; i++) {
+        const Vec2<> point = a + (b - a) * (float) i / 1000;
+        auto nearLine = [](float x) {
+            return std::abs(x - std::round(x)) < 1e-3f;
+        };
+        if (nearLine(point.x) && nearLine(point.y))
+            continue;
+        check(visited(cellOf(point)), "cells along " + segment);
+    }
+
+    const Vec2<int32_t> low{std::min(cellOf(a).x, cellOf(b).x) - 2,
+                            std::min(cellOf(a).y, cellOf(b).y) - 2};
+    const Vec2<int32_t> high{std::max(cellOf(a).x, cellOf(b).x) + 2,
+                             std::max(cellOf(a).y, cellOf(b).y) + 2};
+    for (int32_t x = low.x; x <= high.x; x++)
+        for (int32_t y = low.y; y <= high.y; y++)
+            check(traversal.contains({x, y}) == visited({x, y}),
+                  "contains along " + segment);
+}
+
+static void testGridTraversal() {
+    // on the cell borders, axis parallel, with negative coordinates
+    checkTraversal({0.5f, 2}, {7.5f, 2});
+    checkTraversal({7.5f, 2}, {-3.5f, 2});
+    checkTraversal({2, 0.5f}, {2, -6.5f});
+    checkTraversal({-3, -3}, {4, 4});
+    checkTraversal({4, 4}, {-3, -3});
+    checkTraversal({-2.5f, 3}, {1.5f, -5});
+    checkTraversal({0, 0}, {3, 0});
+    checkTraversal({3, 0}, {0, 0});
+    checkTraversal({-1, -1}, {-1, -4});
+    // zero length, on a corner or not
+    checkTraversal({0, 0}, {0, 0});
+    checkTraversal({-1.5f, 2.25f}, {-1.5f, 2.25f});
+
+    std::mt19937 random(11);
+    auto lattice = [&] { return (float) ((int) (random() % 33) - 16) / 4; };
+    std::uniform_real_distribution<float> anywhere(-8, 8);
+    for (int i = 0; i < 2000; i++) {
+        const Vec2<> a{lattice(), lattice()};
+        const Vec2<> b = i % 3 == 0 ? Vec2<>{lattice(), a.y}
+                         : i % 3 == 1
+                             ? Vec2<>{lattice(), lattice()}
+                             : Vec2<>{anywhere(random), anywhere(random)};
+        checkTraversal(a, b);
+        checkTraversal({anywhere(random), anywhere(random)},
+                       {anywhere(random), anywhere(random)});
+    }
+}
+
+// Whether the disc meets the cell, the square [x, x + 1) x [y, y + 1) where
+// the points of floor (x, y) lie, in double precision
+static bool
+meets(const Vec2<> &center, float rayon, const Vec2<int32_t> &cell) {
+    const double nearestX =
+        std::clamp<double>(center.x, cell.x, cell.x + 1.0);
+    const double nearestY =
+        std::clamp<double>(center.y, cell.y, cell.y + 1.0);
+    const double dx = nearestX - center.x, dy = nearestY - center.y;
+    const double distance = std::sqrt(dx * dx + dy * dy);
+    // the nearest point of the square is the only one the disc can touch
+    return distance < rayon || (distance == rayon && nearestX < cell.x + 1.0 &&
+                                nearestY < cell.y + 1.0);
+}
+
+static double distanceTo(const Vec2<> &center, const Vec2<int32_t> &cell) {
+    const double dx =
+        std::clamp<double>(center.x, cell.x, cell.x + 1.0) - center.x;
+    const double dy =
+        std::clamp<double>(center.y, cell.y, cell.y + 1.0) - center.y;
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// The cells of Circle::rasterize are the ones the disc meets, each one once,
+// and contains() agrees. The conservative cells add at most the cells at a
+// rounding error, and a point overlapping the circle is in one of them.
+static void checkDiscCells(const Circle &circle, std::mt19937 &random) {
+    const std::string disc = "disc at (" + std::to_string(circle.position.x) +
+                             ", " + std::to_string(circle.position.y) +
+                             ") of rayon " + std::to_string(circle.rayon);
+    const Vec2<> center = circle.position;
+    const float tolerance =
+        (std::abs(center.x) + std::abs(center.y) + circle.rayon) * 1e-5f;
+
+    for (bool conservative : {false, true}) {
+        const DiscCells cells = circle.rasterize(conservative);
+        std::vector<Vec2<int32_t>> walked;
+        for (const Vec2<int32_t> &cell : cells)
+            walked.push_back(cell);
+        for (const Vec2<int32_t> &cell : walked) {
+            check(std::count(walked.begin(), walked.end(), cell) == 1,
+                  "cells once of " + disc);
+            check(cells.contains(cell), "contains of " + disc);
+            check(distanceTo(center, cell) <= circle.rayon + tolerance,
+                  "cells near " + disc);
+        }
+
+        const int32_t margin = (int32_t) circle.rayon + 2;
+        const Vec2<int32_t> middle{(int32_t) std::floor(center.x),
+                                   (int32_t) std::floor(center.y)};
+        for (int32_t x = middle.x - margin; x <= middle.x + margin; x++)
+            for (int32_t y = middle.y - margin; y <= middle.y + margin; y++) {
+                const Vec2<int32_t> cell{x, y};
+                const bool found =
+                    std::find(walked.begin(), walked.end(), cell) !=
+                    walked.end();
+                check(cells.contains(cell) == found, "contains of " + disc);
+                const double gap = distanceTo(center, cell) - circle.rayon;
+                // at a rounding error from the circle, either answer is fine
+                if (!conservative && std::abs(gap) < tolerance)
+                    continue;
+                if (meets(center, circle.rayon, cell))
+                    check(found, "cells met by " + disc);
+                else if (!conservative)
+                    check(!found, "cells not met by " + disc);
+            }
+
+        if (conservative && circle.rayon > 0) {
+            std::uniform_real_distribution<float> offset(-circle.rayon,
+                                                         circle.rayon);
+            for (int i = 0; i < 200; i++) {
+                const Point point{center.x + offset(random),
+                                  center.y + offset(random)};
+                if (circle.overlap(point))
+                    check(cells.contains({(int32_t) std::floor(point.x),
+                                          (int32_t) std::floor(point.y)}),
+                          "cell of a point in " + disc);
+            }
+        }
+    }
+}
+
+static void testDiscCells() {
+    std::mt19937 random(3);
+    auto lattice = [&] { return (float) ((int) (random() % 161) - 80) / 4; };
+    std::uniform_real_distribution<float> anywhere(-20, 20), size(0, 30);
+    const float rayons[] = {0, 0.25f, 0.5f, 0.999f, 1, 1.5f, 2.5f, 17.3f};
+    for (int i = 0; i < 400; i++) {
+        const Point center = i % 2 ? Point{lattice(), lattice()}
+                                   : Point{anywhere(random), anywhere(random)};
+        for (float rayon : rayons)
+            checkDiscCells(Circle(center, rayon), random);
+        checkDiscCells(Circle(center, size(random)), random);
+    }
+}
+
+// The vertices of the forms, moved to their position and angle
+static std::vector<Vec2<>> outline(const Polygon &polygon) {
+    std::vector<Vec2<>> vertices;
+    for (size_t i = 0; i < polygon.size(); i++)
+        vertices.push_back(polygon.vertex(i));
+    return vertices;
+}
+
+static std::vector<Vec2<>> outline(const Rectangle &rectangle) {
+    const auto points = rectangle.getPoints();
+    return {points.begin(), points.end()};
+}
+
+static std::vector<Vec2<>> outline(const Line &line) {
+    return {line.positionA, line.positionB};
+}
+
+static std::vector<Vec2<>> outline(const Point &point) { return {point}; }
+
+template<class Form>
+static std::string describe(const Form &form) {
+    std::stringstream text;
+    if constexpr (std::is_same_v<Form, Polygon>) {
+        text << "polygon";
+        for (const Vec2<> &vertex : outline(form))
+            text << " " << vertex;
+    } else
+        text << form;
+    return text.str();
+}
+
+// Separating axis test of two convex outlines in double precision: the
+// largest gap between their projections on the normals of their edges,
+// negative when they overlap and zero when they touch
+static double separation(const std::vector<Vec2<>> &a,
+                         const std::vector<Vec2<>> &b) {
+    auto project = [](const std::vector<Vec2<>> &vertices,
+                      double nx,
+                      double ny) {
+        double low = std::numeric_limits<double>::infinity();
+        double high = -low;
+        for (const Vec2<> &vertex : vertices) {
+            low = std::min(low, vertex.x * nx + vertex.y * ny);
+            high = std::max(high, vertex.x * nx + vertex.y * ny);
+        }
+        return std::pair{low, high};
+    };
+    double gap = -std::numeric_limits<double>::infinity();
+    for (const std::vector<Vec2<>> *edges : {&a, &b})
+        for (size_t i = 0; i < edges->size(); i++) {
+            const Vec2<> &from = (*edges)[i];
+            const Vec2<> &to = (*edges)[(i + 1) % edges->size()];
+            const double length = std::hypot(to.x - from.x, to.y - from.y);
+            if (length == 0)
+                continue;
+            const double nx = (from.y - to.y) / length;
+            const double ny = (to.x - from.x) / length;
+            const auto [lowA, highA] = project(a, nx, ny);
+            const auto [lowB, highB] = project(b, nx, ny);
+            gap = std::max({gap, lowB - highA, lowA - highB});
+        }
+    return gap;
+}
+
+// distance from point to the border of a convex outline, in double precision
+static double borderDistance(const std::vector<Vec2<>> &vertices,
+                             const Vec2<> &point) {
+    double nearest = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < vertices.size(); i++) {
+        const Vec2<> &a = vertices[i];
+        const Vec2<> &b = vertices[(i + 1) % vertices.size()];
+        const double abx = b.x - a.x, aby = b.y - a.y;
+        const double apx = point.x - a.x, apy = point.y - a.y;
+        const double t = std::clamp(
+            (abx * apx + aby * apy) / (abx * abx + aby * aby), 0., 1.);
+        nearest = std::min(nearest, std::hypot(apx - t * abx, apy - t * aby));
+    }
+    return nearest;
+}
+
+// Random forms. The exact ones have whole coordinates and no angle, so they
+// often touch and every computation on them is exact.
+class Shapes {
+private:
+    std::mt19937 random;
+
+    float coordinate(bool exact, int range) {
+        if (exact)
+            return (float) ((int) (random() % (2 * range + 1)) - range);
+        return std::uniform_real_distribution<float>(-range, range)(random);
+    }
+
+    Vec2<> vector(bool exact, int range) {
+        const float x = coordinate(exact, range);
+        return {x, coordinate(exact, range)};
+    }
+
+public:
+    explicit Shapes(unsigned seed) : random(seed) {}
+
+    Polygon polygon(bool exact) {
+        while (true) {
+            std::vector<Vec2<>> vertices(3 + random() % 6);
+            for (Vec2<> &vertex : vertices)
+                vertex = vector(exact, 3);
+            const float angle = exact ? 0 : coordinate(false, 4);
+            try {
+                return Polygon(vertices, vector(exact, 3), angle);
+            } catch (const Exception &) {
+                // the vertices are aligned, draw again
+            }
+        }
+    }
+
+    Rectangle rectangle(bool exact) {
+        return Rectangle(vector(exact, 4), vector(exact, 3).abs() * 2);
+    }
+
+    Line line(bool exact) {
+        Vec2<> a = vector(exact, 5), b = vector(exact, 5);
+        return Line(a, b);
+    }
+
+    Point point(bool exact) { return vector(exact, 5); }
+
+    Circle circle(bool exact) {
+        return Circle(vector(exact, 5), std::abs(coordinate(exact, 3)));
+    }
+};
+
+// Polygon::overlap both ways against the separating axis test, touching forms
+// overlap. The forms at a rounding error from touching may give either answer.
+template<class Form>
+static bool checkPolygonOverlap(const Polygon &polygon, const Form &form) {
+    const double gap = separation(outline(polygon), outline(form));
+    if (gap != 0 && std::abs(gap) < 1e-4)
+        return false;
+    const std::string what = describe(polygon) + " and " + describe(form);
+    check(polygon.overlap(form) == (gap <= 0), "overlap of " + what);
+    check(form.overlap(polygon) == (gap <= 0), "overlap of " + what);
+    return gap == 0;
+}
+
+static void checkPolygonOverlap(const Polygon &polygon, const Circle &circle) {
+    const std::vector<Vec2<>> vertices = outline(polygon);
+    const double distance =
+        separation(vertices, {circle.position}) <= 0
+            ? 0
+            : borderDistance(vertices, circle.position);
+    if (std::abs(distance - circle.rayon) < 1e-4)
+        return;
+    const std::string what = describe(polygon) + " and " + describe(circle);
+    check(polygon.overlap(circle) == (distance <= circle.rayon),
+          "overlap of " + what);
+    check(circle.overlap(polygon) == (distance <= circle.rayon),
+          "overlap of " + what);
+}
+
+static void testPolygonOverlaps() {
+    Shapes shapes(5);
+    size_t touching = 0;
+    for (int i = 0; i < 20000; i++) {
+        const bool exact = i % 2 == 0;
+        const Polygon polygon = shapes.polygon(exact);
+        touching += checkPolygonOverlap(polygon, shapes.polygon(exact));
+        touching += checkPolygonOverlap(polygon, shapes.rectangle(exact));
+        touching += checkPolygonOverlap(polygon, shapes.line(exact));
+        touching += checkPolygonOverlap(polygon, shapes.point(exact));
+        checkPolygonOverlap(polygon, shapes.circle(exact));
+    }
+    check(touching > 1000, "touching forms drawn");
+
+    // contacts by an edge, by a vertex on an edge and by two vertices
+    const Polygon square({{0, 0}, {2, 0}, {2, 2}, {0, 2}});
+    check(square.overlap(Polygon({{2, 0}, {4, 0}, {4, 2}, {2, 2}})),
+          "squares sharing an edge");
+    check(square.overlap(Polygon({{1, 2}, {3, 4}, {-1, 4}})),
+          "vertex on the edge of a square");
+    check(square.overlap(Polygon({{2, 2}, {4, 2}, {4, 4}, {2, 4}})),
+          "squares sharing a corner");
+    check(square.overlap(Rectangle({3, 1}, {2, 2})),
+          "square and rectangle sharing an edge");
+    Vec2<> corner{2, 2}, away{3, 3};
+    check(square.overlap(Line(corner, away)), "line from a corner");
+    check(square.overlap(Point(2, 1)), "point on an edge");
+    check(!square.overlap(Polygon({{2.01f, 0}, {4, 0}, {4, 2}, {2.01f, 2}})),
+          "squares apart");
+}
+
+// Polygon::penetration against the smallest overlap of the separating axis
+// test: moving the other form along the normal by the depth separates them
+template<class Form>
+static void checkPenetration(const Polygon &polygon, const Form &form) {
+    const std::vector<Vec2<>> vertices = outline(polygon);
+    const double gap = separation(vertices, outline(form));
+    const std::string what = describe(polygon) + " and " + describe(form);
+    const std::optional<Penetration> penetration = polygon.penetration(form);
+    if (gap > 1e-4)
+        check(!penetration, "penetration of " + what);
+    if (gap > -1e-4)
+        return;
+    check(penetration.has_value(), "penetration of " + what);
+    check(std::abs(penetration->depth + gap) < 1e-3, "depth of " + what);
+    check(std::abs(penetration->normal.length() - 1) < 1e-4,
+          "normal of " + what);
+    std::vector<Vec2<>> moved = outline(form);
+    for (Vec2<> &vertex : moved)
+        vertex += penetration->normal * penetration->depth;
+    check(std::abs(separation(vertices, moved)) < 1e-3,
+          "normal direction of " + what);
+}
+
+static void checkPenetration(const Polygon &polygon,
+                             const Penetration &expected,
+                             const std::optional<Penetration> &penetration) {
+    const std::string what = "penetration into " + describe(polygon);
+    check(penetration.has_value(), what);
+    check(std::abs(penetration->depth - expected.depth) < 1e-4,
+          "depth of " + what);
+    check(Vec2<>(penetration->normal, expected.normal).length() < 1e-4,
+          "normal of " + what);
+}
+
+static void testPolygonPenetrations() {
+    const Polygon square({{-1, -1}, {1, -1}, {1, 1}, {-1, 1}}, {1, 1});
+    checkPenetration(square,
+                     {0.5f, {1, 0}},
+                     square.penetration(Polygon(
+                         {{0, 0}, {2, 0}, {2, 2}, {0, 2}}, {1.5f, 0.2f})));
+    checkPenetration(square,
+                     {0.5f, {0, 1}},
+                     square.penetration(Rectangle({1, 2.5f}, {1, 2})));
+    checkPenetration(square,
+                     {0.25f, {-1, 0}},
+                     square.penetration(Rectangle({-0.5f, 1}, {1.5f, 3})));
+    // a diamond touching the top of a square turned by a quarter turn
+    const Polygon turned({{-1, -1}, {1, -1}, {1, 1}, {-1, 1}},
+                         {0, 0},
+                         std::numbers::pi_v<float> / 2);
+    checkPenetration(turned,
+                     {1, {0, 1}},
+                     turned.penetration(Polygon(
+                         {{0, -0.5f}, {0.5f, 0}, {0, 0.5f}, {-0.5f, 0}},
+                         {0, 0.5f})));
+    checkPenetration(square,
+                     {0.25f, {0, 1}},
+                     square.penetration(Circle(Point{1, 2.25f}, 0.5f)));
+    checkPenetration(square,
+                     {0.75f, {0, 1}},
+                     square.penetration(Circle(Point{1, 1.75f}, 0.5f)));
+
+    Shapes shapes(8);
+    for (int i = 0; i < 20000; i++) {
+        const Polygon polygon = shapes.polygon(i % 2 == 0);
+        checkPenetration(polygon, shapes.polygon(i % 2 == 0));
+        checkPenetration(polygon, shapes.rectangle(i % 2 == 0));
+    }
+}
+
+// Polygon::support from any hint against the furthest vertex found by
+// testing all of them, for the sizes around the SIMD and climbing thresholds
+static void testPolygonSupport() {
+    std::mt19937 random(13);
+    std::uniform_real_distribution<float> unit(-1, 1);
+    std::uniform_real_distribution<float> turn(0,
+                                               2 * std::numbers::pi_v<float>);
+    for (size_t count : {3, 7, 8, 31, 32, 100}) {
+        for (int shape = 0; shape < 20; shape++) {
+            // regular, or drawn on an ellipse
+            std::vector<float> angles(count);
+            for (size_t i = 0; i < count; i++)
+                angles[i] = shape % 2 ? turn(random)
+                                      : 2 * std::numbers::pi_v<float> *
+                                            (float) i / (float) count;
+            std::vector<Vec2<>> vertices;
+            for (float angle : angles)
+                vertices.push_back({5 * std::cos(angle), 2 * std::sin(angle)});
+            const Polygon polygon(
+                vertices, {unit(random) * 10, unit(random) * 10}, turn(random));
+            if (shape % 2 == 0)
+                check(polygon.size() == count, "vertices of a regular polygon");
+
+            const std::vector<Vec2<>> world = outline(polygon);
+            for (int i = 0; i < 500; i++) {
+                const Vec2<> direction = i == 0   ? Vec2<>{1, 0}
+                                         : i == 1 ? Vec2<>{0, -1}
+                                                  : Vec2<>{unit(random) * 3,
+                                                           unit(random) * 3};
+                const size_t hint = random() % (polygon.size() + 1);
+                const size_t best = polygon.support(direction, hint);
+                check(best < polygon.size(), "support in the polygon");
+                float furthest = -std::numeric_limits<float>::infinity();
+                for (const Vec2<> &vertex : world)
+                    furthest = std::max(furthest, direction.dot(vertex));
+                check(direction.dot(world[best]) >= furthest - 1e-4f * 50,
+                      "support of " + std::to_string(count) + " vertices");
+            }
+        }
+    }
+}
+
+// Polygon::raycast against the first edge crossed by the ray
+static void testPolygonRaycasts() {
+    Shapes shapes(21);
+    std::mt19937 random(21);
+    std::uniform_real_distribution<float> unit(-1, 1), length(0, 15);
+    size_t hits = 0;
+    for (int i = 0; i < 20000; i++) {
+        const Polygon polygon = shapes.polygon(false);
+        const std::vector<Vec2<>> vertices = outline(polygon);
+        const Vec2<> origin{unit(random) * 8, unit(random) * 8};
+        const Vec2<> target = i % 2 ? polygon.bounds().center()
+                                    : Vec2<>{unit(random), unit(random)};
+        if (Vec2<>(origin, target).isNull())
+            continue;
+        const Vec2<> direction = Vec2<>(origin, target).normalize();
+        const float maxDistance = length(random);
+        const std::optional<RayHit> hit =
+            polygon.raycast(origin, direction, maxDistance);
+        const std::string what = "ray from " + describe(origin) + " to " +
+                                 describe(polygon);
+
+        // the ray grazing a vertex or ending on the border may give either
+        // answer
+        const Vec2<> end = origin + direction * maxDistance;
+        Vec2<> a = origin, b = end;
+        const std::vector<Vec2<>> ray = outline(Line(a, b));
+        bool grazing = borderDistance(vertices, origin) < 1e-3 ||
+                       borderDistance(vertices, end) < 1e-3;
+        for (const Vec2<> &vertex : vertices)
+            grazing |= borderDistance(ray, vertex) < 1e-3;
+        if (grazing)
+            continue;
+
+        if (separation(vertices, {origin}) <= 0) {
+            check(hit && hit->distance == 0 && hit->normal == -direction,
+                  "ray from inside " + what);
+            continue;
+        }
+        // the entering edge nearest to origin, counterclockwise
+        std::optional<std::pair<double, Vec2<>>> entry;
+        for (size_t j = 0; j < vertices.size(); j++) {
+            const Vec2<> &from = vertices[j];
+            const Vec2<> edge{from, vertices[(j + 1) % vertices.size()]};
+            const double cross = direction.cross(edge);
+            if (edge.rotate().dot(direction) >= 0 || cross == 0)
+                continue;
+            const Vec2<> toEdge{origin, from};
+            const double t = toEdge.cross(edge) / cross;
+            const double s = toEdge.cross(direction) / cross;
+            if (t >= 0 && t <= maxDistance && s >= 0 && s <= 1 &&
+                (!entry || t < entry->first))
+                entry = {{t, edge.rotate().normalize()}};
+        }
+        check(hit.has_value() == entry.has_value(), what);
+        if (!entry)
+            continue;
+        hits++;
+        check(std::abs(hit->distance - entry->first) < 1e-3,
+              "distance of " + what);
+        check(Vec2<>(hit->normal, entry->second).length() < 1e-3,
+              "normal of " + what);
+    }
+    check(hits > 5000, "rays hitting polygons drawn");
+}
+
+static void testPolygonCopies() {
+    const Polygon polygon({{0, 0}, {3, 0}, {0, 2}}, {4, 5}, 0.5f);
+    Polygon copy = polygon;
+    copy.setPosition({-1, 2});
+    copy.setAngle(-2);
+    check(&copy.getLocalVertices() == &polygon.getLocalVertices(),
+          "vertices shared by the copies");
+    check(polygon.getPosition() == Vec2<>{4, 5} && polygon.getAngle() == 0.5f,
+          "copy moved alone");
+    const Polygon *forms[] = {&polygon, &copy};
+    for (const Polygon *form : forms) {
+        const float cos = std::cos(form->getAngle());
+        const float sin = std::sin(form->getAngle());
+        const Box &box = form->bounds();
+        Box vertices{form->vertex(0), form->vertex(0)};
+        for (size_t i = 0; i < form->size(); i++) {
+            const Vec2<> &local = form->getLocalVertices()[i];
+            const Vec2<> expected =
+                form->getPosition() + Vec2<>{local.x * cos - local.y * sin,
+                                             local.x * sin + local.y * cos};
+            check(Vec2<>(form->vertex(i), expected).length() < 1e-5f,
+                  "vertex of " + describe(*form));
+            vertices = vertices.merge({form->vertex(i), form->vertex(i)});
+        }
+        check(box.min == vertices.min && box.max == vertices.max,
+              "bounds of " + describe(*form));
+    }
+}
+
+static Circle moved(Circle circle, const Vec2<> &offset) {
+    circle.position += offset;
+    return circle;
+}
+
+static Rectangle moved(Rectangle rectangle, const Vec2<> &offset) {
+    rectangle.position += offset;
+    return rectangle;
+}
+
+// Form::sweep against the first overlap met by moving form in small steps,
+// then by bisection. The forms at a rounding error from touching at the
+// start, or touching without overlapping on the way, may give either answer.
+template<class Form, class Target>
+static bool checkSweep(const Form &form,
+                       const Vec2<> &direction,
+                       float maxDistance,
+                       const Target &target) {
+    auto overlapAt = [&](float distance) {
+        return moved(form, direction * distance).overlap(target);
+    };
+    const bool overlapping = form.overlap(target);
+    for (const Vec2<> offset : {Vec2<>{1, 1}, Vec2<>{1, -1}})
+        for (float side : {-1e-3f, 1e-3f})
+            if (moved(form, offset * side).overlap(target) != overlapping)
+                return false;
+
+    const std::string what = describe(form) + " moving along " +
+                             describe(direction) + " to " + describe(target);
+    const std::optional<RayHit> hit =
+        form.sweep(direction, maxDistance, target);
+    if (overlapping) {
+        check(hit && hit->distance == 0 && hit->normal == -direction,
+              "start of " + what);
+        return false;
+    }
+
+    constexpr int steps = 4000;
+    const float step = maxDistance / steps;
+    int first = 1;
+    while (first <= steps && !overlapAt(first * step))
+        first++;
+    if (first <= steps) {
+        float before = (first - 1) * step, after = first * step;
+        for (int i = 0; i < 30; i++) {
+            const float middle = (before + after) / 2;
+            (overlapAt(middle) ? after : before) = middle;
+        }
+        check(hit.has_value(), what);
+        check(std::abs(hit->distance - after) < 1e-3f, "distance of " + what);
+    } else if (!hit)
+        return false;
+
+    // the forms touch there: going on along the normal separates them,
+    // going back against it overlaps them
+    check(std::abs(hit->normal.length() - 1) < 1e-4f, "normal of " + what);
+    check(hit->normal.dot(direction) <= 1e-4f, "normal facing " + what);
+    const Vec2<> contact = direction * hit->distance;
+    check(moved(form, contact - hit->normal * 2e-3f).overlap(target),
+          "contact of " + what);
+    check(!moved(form, contact + hit->normal * 2e-3f).overlap(target),
+          "separation along the normal of " + what);
+    return true;
+}
+
+template<class Form, class Target>
+static void checkSweeps(Shapes &shapes,
+                        Form (Shapes::*form)(bool),
+                        Target (Shapes::*target)(bool)) {
+    std::mt19937 random(17);
+    std::uniform_real_distribution<float> unit(-1, 1), length(0, 15);
+    size_t hits = 0;
+    for (int i = 0; i < 3000; i++) {
+        const Form moving = (shapes.*form)(false);
+        const Target still = (shapes.*target)(false);
+        // going through a point or a line takes twice the nudge of the check
+        const Vec2<> extent = moving.bounds().max - moving.bounds().min;
+        if (std::min(extent.x, extent.y) < 1e-2f)
+            continue;
+        const Vec2<> aim =
+            i % 2 ? Vec2<>(moving.bounds().center(), still.bounds().center())
+                  : Vec2<>{unit(random), unit(random)};
+        if (aim.isNull())
+            continue;
+        hits += checkSweep(moving, aim.normalize(), length(random), still);
+    }
+    check(hits > 500, "sweeps of " + describe((shapes.*form)(false)) +
+                          " hitting " + describe((shapes.*target)(false)));
+}
+
+// A form much faster than its size crosses a thin wall between two of its
+// positions, the sweep still stops it on the wall
+template<class Form, class Target>
+static void checkTunnel(const Form &form, const Target &wall, float expected) {
+    const Vec2<> direction{1, 0};
+    const std::string what = describe(form) + " through " + describe(wall);
+    check(!form.overlap(wall) && !moved(form, direction * 100).overlap(wall),
+          "wall between the positions of " + what);
+    const std::optional<RayHit> hit = form.sweep(direction, 100, wall);
+    check(hit && std::abs(hit->distance - expected) < 1e-4f,
+          "distance of " + what);
+    check(Vec2<>(hit->normal, -direction).length() < 1e-4f,
+          "normal of " + what);
+}
+
+static void testSweeps() {
+    Shapes shapes(34);
+    checkSweeps(shapes, &Shapes::circle, &Shapes::circle);
+    checkSweeps(shapes, &Shapes::circle, &Shapes::rectangle);
+    checkSweeps(shapes, &Shapes::circle, &Shapes::point);
+    checkSweeps(shapes, &Shapes::circle, &Shapes::line);
+    checkSweeps(shapes, &Shapes::circle, &Shapes::polygon);
+    checkSweeps(shapes, &Shapes::rectangle, &Shapes::circle);
+    checkSweeps(shapes, &Shapes::rectangle, &Shapes::rectangle);
+    checkSweeps(shapes, &Shapes::rectangle, &Shapes::point);
+    checkSweeps(shapes, &Shapes::rectangle, &Shapes::line);
+    checkSweeps(shapes, &Shapes::rectangle, &Shapes::polygon);
+
+    const Rectangle wall({50, 0}, {0.01f, 4});
+    Vec2<> top{50, 2}, bottom{50, -2};
+    const Line line(top, bottom);
+    const Polygon slab(
+        {{-0.005f, -2}, {0.005f, -2}, {0.005f, 2}, {-0.005f, 2}}, {50, 0});
+    for (const float rayon : {0.f, 0.25f}) {
+        const Circle bullet(Point{0, 0}, rayon);
+        checkTunnel(bullet, wall, 49.995f - rayon);
+        checkTunnel(bullet, line, 50 - rayon);
+        checkTunnel(bullet, slab, 49.995f - rayon);
+    }
+    const Rectangle crate({0, 0}, {0.5f, 0.5f});
+    checkTunnel(crate, wall, 49.745f);
+    checkTunnel(crate, line, 49.75f);
+    checkTunnel(crate, slab, 49.745f);
+}
+
+int main() {
+    try {
+        testGridTraversal();
+        testDiscCells();
+        testPolygonCopies();
+        testPolygonOverlaps();
+        testPolygonPenetrations();
+        testPolygonSupport();
+        testPolygonRaycasts();
+        testSweeps();
+    } catch (const Exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "All geometry tests passed" << std::endl;
+    return 0;
+}